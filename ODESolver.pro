@@ -39,12 +39,54 @@ INCLUDEPATH += .\
 HEADERS += ./include/stdafx.h \
            ./include/odesolver_global.h \
            ./include/odesolver.h \
-           ./include/test/odesolvertest.h
+           ./include/fixedodesolver.h \
+           ./include/lockstepodesolver.h \
+           ./include/odebatchstate.h \
+           ./include/odesolvercheckpoint.h \
+           ./include/odeoutputsink.h \
+           ./include/typedodesolver.h \
+           ./include/odesparsity.h \
+           ./include/odejacobian.h \
+           ./include/odekrylov.h \
+           ./include/odekernels.h \
+           ./include/odeautotuner.h \
+           ./include/odeasync.h \
+           ./include/odeparareal.h \
+           ./include/odeensemble.h \
+           ./include/test/odesolvertest.h \
+           ./include/test/fixedodesolvertest.h \
+           ./include/test/lockstepodesolvertest.h \
+           ./include/test/odeoutputsinktest.h \
+           ./include/test/typedodesolvertest.h \
+           ./include/test/odesparsitytest.h \
+           ./include/test/odepararealtest.h \
+           ./include/test/odeensembletest.h \
+           ./include/test/odeautotunertest.h
 
 SOURCES +=./src/stdafx.cpp \
           ./src/odesolver.cpp \
+          ./src/lockstepodesolver.cpp \
+          ./src/odebatchstate.cpp \
+          ./src/odesolvercheckpoint.cpp \
+          ./src/odeoutputsink.cpp \
+          ./src/odesparsity.cpp \
+          ./src/odejacobian.cpp \
+          ./src/odekrylov.cpp \
+          ./src/odekernels.cpp \
+          ./src/odeautotuner.cpp \
+          ./src/odeasync.cpp \
+          ./src/odeparareal.cpp \
+          ./src/odeensemble.cpp \
           ./src/main.cpp \
-          ./src/test/odesolvertest.cpp 
+          ./src/test/odesolvertest.cpp \
+          ./src/test/fixedodesolvertest.cpp \
+          ./src/test/lockstepodesolvertest.cpp \
+          ./src/test/odeoutputsinktest.cpp \
+          ./src/test/typedodesolvertest.cpp \
+          ./src/test/odesparsitytest.cpp \
+          ./src/test/odepararealtest.cpp \
+          ./src/test/odeensembletest.cpp \
+          ./src/test/odeautotunertest.cpp
 
 macx{
 
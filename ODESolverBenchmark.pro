@@ -0,0 +1,152 @@
+#Author Caleb Amoa Buahin
+#Email caleb.buahin@gmail.com
+#Date 2014-2018
+#License GNU Lesser General Public License (see <http: //www.gnu.org/licenses/> for details).
+#Copyright 2014-2018, Caleb Buahin, All rights reserved.
+
+#Standalone benchmark executable for the ODESolver library.
+
+TEMPLATE = app
+TARGET = ODESolverBenchmark
+VERSION = 1.0.0
+QT += core
+QT -= gui
+
+CONFIG += c++11
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG += optimize_full
+
+DEFINES += USE_CHPC
+DEFINES += USE_OPENMP
+DEFINES += USE_CVODE
+#DEFINES += USE_CVODE_OPENMP
+
+PRECOMPILED_HEADER = ./include/stdafx.h
+
+INCLUDEPATH += .\
+               ./include
+
+HEADERS += ./include/stdafx.h \
+           ./include/odesolver_global.h \
+           ./include/odesolver.h \
+           ./include/odebatchstate.h \
+           ./include/odesparsity.h \
+           ./include/odejacobian.h \
+           ./include/odekrylov.h \
+           ./include/odekernels.h \
+           ./include/odeautotuner.h \
+           ./include/odeasync.h \
+           ./include/odeparareal.h \
+           ./include/typedodesolver.h \
+           ./include/benchmark/odebenchmarkproblems.h \
+           ./include/benchmark/odebenchmark.h \
+           ./include/benchmark/odebenchmarkregression.h
+
+SOURCES +=./src/stdafx.cpp \
+          ./src/odesolver.cpp \
+          ./src/odebatchstate.cpp \
+          ./src/odesparsity.cpp \
+          ./src/odejacobian.cpp \
+          ./src/odekrylov.cpp \
+          ./src/odekernels.cpp \
+          ./src/odeautotuner.cpp \
+          ./src/odeasync.cpp \
+          ./src/odeparareal.cpp \
+          ./src/benchmark/odebenchmarkproblems.cpp \
+          ./src/benchmark/odebenchmark.cpp \
+          ./src/benchmark/odebenchmarkregression.cpp \
+          ./src/benchmark/main.cpp
+
+macx{
+
+    INCLUDEPATH += /usr/local \
+                   /usr/local/include
+
+    contains(DEFINES, USE_CVODE){
+        message("CVODE enabled")
+        LIBS += -L/usr/local/lib -lsundials_cvode
+    }
+
+    contains(DEFINES,USE_OPENMP){
+
+        QMAKE_CC = /usr/local/opt/llvm/bin/clang
+        QMAKE_CXX = /usr/local/opt/llvm/bin/clang++
+        QMAKE_LINK = /usr/local/opt/llvm/bin/clang++
+
+        QMAKE_CFLAGS+= -fopenmp
+        QMAKE_LFLAGS+= -fopenmp
+        QMAKE_CXXFLAGS+= -fopenmp
+
+        INCLUDEPATH += /usr/local/opt/llvm/lib/clang/5.0.0/include
+        LIBS += -L /usr/local/opt/llvm/lib -lomp
+
+        message("OpenMP enabled")
+    }
+
+    QMAKE_CXXFLAGS += -O3
+}
+
+linux{
+
+    INCLUDEPATH += /usr/include
+
+    contains(DEFINES,USE_CHPC){
+
+        contains(DEFINES,USE_CVODE){
+
+            message("CVODE enabled")
+
+            INCLUDEPATH += ../sundials-3.1.1/instdir/include
+            LIBS += -L../sundials-3.1.1/instdir/lib -lsundials_cvode
+        }
+        message("Compiling on CHPC")
+    }
+
+    contains(DEFINES,USE_OPENMP){
+
+      QMAKE_CFLAGS += -fopenmp
+      QMAKE_LFLAGS += -fopenmp
+      QMAKE_CXXFLAGS += -fopenmp
+
+      message("OpenMP enabled")
+    }
+
+    QMAKE_CXXFLAGS += -O3
+}
+
+win32{
+
+    #Windows vspkg package manager installation path if environment variable is not set
+    VCPKGDIR = C:/vcpkg/installed/x64-windows
+
+    INCLUDEPATH += $${VCPKGDIR}/include
+
+    contains(DEFINES, USE_CVODE){
+       message("CVODE enabled")
+       LIBS += -L$${VCPKGDIR}/lib -lsundials_cvode
+    }
+
+    contains(DEFINES,USE_OPENMP){
+        QMAKE_CFLAGS += /openmp
+        QMAKE_CXXFLAGS += /openmp
+        message("OpenMP enabled")
+    }
+
+    QMAKE_CXXFLAGS += /MP /MD
+}
+
+OBJECTS_DIR = ./build/benchmark/.obj
+MOC_DIR = ./build/benchmark/.moc
+
+macx{
+    DESTDIR = bin/macx
+}
+
+linux{
+    DESTDIR = bin/linux
+}
+
+win32{
+    DESTDIR = bin/win32
+}
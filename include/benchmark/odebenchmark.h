@@ -0,0 +1,286 @@
+/*!
+*  \file    odebenchmark.h
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  Runs the benchmark problems with every ODESolver::SolverType and thread count and reports
+*  time per step, derivative evaluations and memory in a machine readable form.
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#ifndef ODEBENCHMARK_H
+#define ODEBENCHMARK_H
+
+#include "odesolver.h"
+
+#include <QString>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <vector>
+
+class ODEBenchmarkProblem;
+
+/*!
+ * \brief The ODEBenchmarkResult struct holds the measurements of one problem, size, solver and thread count.
+ */
+struct ODEBenchmarkResult
+{
+    ODEBenchmarkResult();
+
+    /*!
+     * \brief key Identifies the case across runs.
+     * \return problem/parameter/solver/threads
+     */
+    QString key() const;
+
+    /*!
+     * \brief medianTime
+     * \return Median of times.
+     */
+    double medianTime() const;
+
+    /*!
+     * \brief timePerStep
+     * \return Median time divided by the number of accepted steps.
+     */
+    double timePerStep() const;
+
+    QJsonObject toJson() const;
+
+    static ODEBenchmarkResult fromJson(const QJsonObject &object);
+
+    QString problem,
+    solver;
+
+    double parameter,
+    simulatedTime,
+    error,
+    speedup;
+
+    int size,
+    threads,
+    status;
+
+    long long solveCalls,
+    acceptedSteps,
+    rejectedSteps,
+    derivativeEvaluations,
+    peakMemory;
+
+    std::vector<double> times;
+};
+
+class ODEBenchmark
+{
+  public:
+
+    ODEBenchmark();
+
+    /*!
+     * \brief setProblems
+     * \param problems Names accepted by ODEBenchmarkProblem::create.
+     */
+    void setProblems(const std::vector<QString> &problems);
+
+    /*!
+     * \brief setSolverTypes
+     * \param solverTypes
+     */
+    void setSolverTypes(const std::vector<ODESolver::SolverType> &solverTypes);
+
+    /*!
+     * \brief setPrecisions Precisions to run RK4 and RKQS in: double, float or mixed (float storage with
+     * double accumulation). Reduced precision cases are reported as RK4_FLOAT, RKQS_MIXED, etc. with
+     * the error of the final state relative to a double precision run.
+     * \param precisions
+     */
+    void setPrecisions(const std::vector<QString> &precisions);
+
+    /*!
+     * \brief setPararealSlices Adds a Parareal case for each solver with that solver as the fine propagator over
+     * slices time slices, reported as RKQS_PARAREAL8, etc. with the speedup over the serial fine integration and
+     * the error relative to it. Zero disables the Parareal cases.
+     * \param slices
+     */
+    void setPararealSlices(int slices);
+
+    /*!
+     * \brief setThreads Thread counts to run each case with.
+     * \param threads
+     */
+    void setThreads(const std::vector<int> &threads);
+
+    /*!
+     * \brief setMaxSize Largest number of equations for the scalable problems.
+     * \param maxSize
+     */
+    void setMaxSize(double maxSize);
+
+    /*!
+     * \brief setRepeats Number of timed repetitions of each case.
+     * \param repeats
+     */
+    void setRepeats(int repeats);
+
+    /*!
+     * \brief setMaxSolveCalls Caps the number of solve calls per case so explicit solvers on stiff problems finish.
+     * \param maxSolveCalls
+     */
+    void setMaxSolveCalls(int maxSolveCalls);
+
+    /*!
+     * \brief setMaxIterations Passed to ODESolver::setMaxIterations.
+     * \param maxIterations
+     */
+    void setMaxIterations(int maxIterations);
+
+    /*!
+     * \brief setVerbose Prints a table row for each case as it completes.
+     * \param verbose
+     */
+    void setVerbose(bool verbose);
+
+    /*!
+     * \brief run Runs every problem, size, solver type and thread count.
+     */
+    void run();
+
+    /*!
+     * \brief runCase
+     * \param problem
+     * \param solverType
+     * \param threads
+     * \return
+     */
+    ODEBenchmarkResult runCase(ODEBenchmarkProblem *problem, ODESolver::SolverType solverType, int threads) const;
+
+    /*!
+     * \brief runPrecisionCase Runs RK4 or RKQS with TypedODESolver in the given precision.
+     * \param problem
+     * \param solverType RK4 or RKQS.
+     * \param precision double, float or mixed.
+     * \param threads
+     * \return
+     */
+    ODEBenchmarkResult runPrecisionCase(ODEBenchmarkProblem *problem, ODESolver::SolverType solverType, const QString &precision, int threads) const;
+
+    /*!
+     * \brief runPararealCase Integrates the whole case interval once with ODEParareal and once serially with the fine solver.
+     * The coarse propagator is the same solver with a tenth of the steps, or with a thousand times looser tolerances
+     * for the adaptive solvers.
+     * \param problem
+     * \param solverType Fine solver.
+     * \param threads
+     * \return
+     */
+    ODEBenchmarkResult runPararealCase(ODEBenchmarkProblem *problem, ODESolver::SolverType solverType, int threads) const;
+
+    /*!
+     * \brief results
+     * \return
+     */
+    const std::vector<ODEBenchmarkResult> &results() const;
+
+    /*!
+     * \brief toJson
+     * \return Document with the machine description and one entry per result.
+     */
+    QJsonDocument toJson() const;
+
+    /*!
+     * \brief writeJson
+     * \param filePath
+     * \return
+     */
+    bool writeJson(const QString &filePath) const;
+
+    /*!
+     * \brief readJson Reads results written by writeJson.
+     * \param filePath
+     * \param results
+     * \return
+     */
+    static bool readJson(const QString &filePath, std::vector<ODEBenchmarkResult> &results);
+
+    /*!
+     * \brief solverName
+     * \param solverType
+     * \return
+     */
+    static QString solverName(ODESolver::SolverType solverType);
+
+    /*!
+     * \brief solverTypeFromName
+     * \param name
+     * \param solverType
+     * \return false if name is not a solver available in this build.
+     */
+    static bool solverTypeFromName(const QString &name, ODESolver::SolverType &solverType);
+
+    /*!
+     * \brief availableSolverTypes
+     * \return
+     */
+    static std::vector<ODESolver::SolverType> availableSolverTypes();
+
+    /*!
+     * \brief maxThreads
+     * \return
+     */
+    static int maxThreads();
+
+    /*!
+     * \brief startMemoryMeasurement Resets the peak resident memory of the process so that it can be measured per case.
+     * \return Resident memory of the process in kilobytes, or -1 where the peak cannot be reset.
+     */
+    static long long startMemoryMeasurement();
+
+    /*!
+     * \brief peakMemory
+     * \param start Resident memory returned by startMemoryMeasurement at the start of the case.
+     * \return Growth of the peak resident memory over start in kilobytes, or 0 where unavailable.
+     */
+    static long long peakMemory(long long start);
+
+  private:
+
+    /*!
+     * \brief memoryStatus Reads a field such as VmRSS or VmHWM of /proc/self/status.
+     * \return Value of the field in kilobytes, or -1 where unavailable.
+     */
+    static long long memoryStatus(const char *field);
+
+    void printResult(const ODEBenchmarkResult &result) const;
+
+    /*!
+     * \brief configureSolver Settings shared by all cases of a solver type.
+     */
+    void configureSolver(ODESolver &solver, ODESolver::SolverType solverType) const;
+
+  private:
+
+    std::vector<QString> m_problems;
+    std::vector<ODESolver::SolverType> m_solverTypes;
+    std::vector<QString> m_precisions;
+    std::vector<int> m_threads;
+    double m_maxSize;
+    int m_repeats,
+    m_maxSolveCalls,
+    m_maxIterations,
+    m_pararealSlices;
+    bool m_verbose;
+    std::vector<ODEBenchmarkResult> m_results;
+};
+
+#endif // ODEBENCHMARK_H
@@ -0,0 +1,279 @@
+/*!
+*  \file    odebenchmarkproblems.h
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  Scalable standard test problems used by the ODESolver benchmarks.
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#ifndef ODEBENCHMARKPROBLEMS_H
+#define ODEBENCHMARKPROBLEMS_H
+
+#include "odesolver.h"
+#include "typedodesolver.h"
+
+#include <QString>
+#include <vector>
+
+/*!
+ * \brief The ODEBenchmarkProblem class describes a benchmark problem of a given size. The
+ * integration runs from startTime() to endTime() in solve calls of outputStep(), or of
+ * fixedStep() for the solvers without step size control.
+ */
+class ODEBenchmarkProblem
+{
+  public:
+
+    virtual ~ODEBenchmarkProblem() {}
+
+    /*!
+     * \brief name
+     * \return
+     */
+    virtual QString name() const = 0;
+
+    /*!
+     * \brief size Number of equations.
+     * \return
+     */
+    int size() const { return m_size; }
+
+    /*!
+     * \brief parameter Scaling parameter of the problem, for example the grid size or the stiffness.
+     * \return
+     */
+    double parameter() const { return m_parameter; }
+
+    /*!
+     * \brief stiff
+     * \return
+     */
+    virtual bool stiff() const = 0;
+
+    /*!
+     * \brief initialConditions
+     * \param y Array of size()
+     */
+    virtual void initialConditions(double y[]) const = 0;
+
+    /*!
+     * \brief derivatives
+     * \return Callback to pass to ODESolver::solve with this problem as userData.
+     */
+    virtual ComputeDerivatives derivatives() const = 0;
+
+    /*!
+     * \brief derivativesFloat
+     * \return Single precision callback for MixedODESolver and FloatODESolver with this problem as userData.
+     */
+    virtual TypedODESolver<float>::Derivatives derivativesFloat() const = 0;
+
+    double startTime() const { return m_startTime; }
+
+    double endTime() const { return m_endTime; }
+
+    double outputStep() const { return m_outputStep; }
+
+    double fixedStep() const { return m_fixedStep; }
+
+    /*!
+     * \brief create Creates a problem by name. Returns nullptr for unknown names.
+     * \param name robertson, brusselator1d, brusselator2d, lorenz96, vanderpol or batchedcells
+     * \param scale Approximate number of equations, or the stiffness parameter for vanderpol.
+     * \return
+     */
+    static ODEBenchmarkProblem *create(const QString &name, double scale);
+
+    /*!
+     * \brief problemNames
+     * \return
+     */
+    static std::vector<QString> problemNames();
+
+    /*!
+     * \brief scales Scales to run for a problem, by decades from 10^2 up to maxSize.
+     * \param name
+     * \param maxSize
+     * \return
+     */
+    static std::vector<double> scales(const QString &name, double maxSize);
+
+  protected:
+
+    int m_size;
+    double m_parameter,
+    m_startTime,
+    m_endTime,
+    m_outputStep,
+    m_fixedStep;
+};
+
+/*!
+ * \brief The RobertsonProblem class is the stiff chemical kinetics problem of Robertson (n = 3).
+ */
+class RobertsonProblem : public ODEBenchmarkProblem
+{
+  public:
+
+    RobertsonProblem();
+
+    QString name() const override { return "robertson"; }
+
+    bool stiff() const override { return true; }
+
+    void initialConditions(double y[]) const override;
+
+    ComputeDerivatives derivatives() const override { return &RobertsonProblem::computeDerivatives<double>; }
+
+    TypedODESolver<float>::Derivatives derivativesFloat() const override { return &RobertsonProblem::computeDerivatives<float>; }
+
+    template<typename Real>
+    static void computeDerivatives(double t, Real y[], Real dydt[], void* userData);
+};
+
+/*!
+ * \brief The Brusselator1DProblem class is the Brusselator reaction on a 1-D grid of N interior
+ * points with diffusion and Dirichlet boundaries (n = 2N).
+ */
+class Brusselator1DProblem : public ODEBenchmarkProblem
+{
+  public:
+
+    Brusselator1DProblem(int gridSize);
+
+    QString name() const override { return "brusselator1d"; }
+
+    bool stiff() const override { return true; }
+
+    void initialConditions(double y[]) const override;
+
+    ComputeDerivatives derivatives() const override { return &Brusselator1DProblem::computeDerivatives<double>; }
+
+    TypedODESolver<float>::Derivatives derivativesFloat() const override { return &Brusselator1DProblem::computeDerivatives<float>; }
+
+    template<typename Real>
+    static void computeDerivatives(double t, Real y[], Real dydt[], void* userData);
+
+  private:
+
+    int m_gridSize;
+    double m_alpha;
+};
+
+/*!
+ * \brief The Brusselator2DProblem class is the Brusselator reaction on a periodic N x N grid (n = 2N^2).
+ */
+class Brusselator2DProblem : public ODEBenchmarkProblem
+{
+  public:
+
+    Brusselator2DProblem(int gridSize);
+
+    QString name() const override { return "brusselator2d"; }
+
+    bool stiff() const override { return true; }
+
+    void initialConditions(double y[]) const override;
+
+    ComputeDerivatives derivatives() const override { return &Brusselator2DProblem::computeDerivatives<double>; }
+
+    TypedODESolver<float>::Derivatives derivativesFloat() const override { return &Brusselator2DProblem::computeDerivatives<float>; }
+
+    template<typename Real>
+    static void computeDerivatives(double t, Real y[], Real dydt[], void* userData);
+
+  private:
+
+    int m_gridSize;
+    double m_alpha;
+};
+
+/*!
+ * \brief The Lorenz96Problem class is the chaotic Lorenz-96 model with forcing F = 8.
+ */
+class Lorenz96Problem : public ODEBenchmarkProblem
+{
+  public:
+
+    Lorenz96Problem(int size);
+
+    QString name() const override { return "lorenz96"; }
+
+    bool stiff() const override { return false; }
+
+    void initialConditions(double y[]) const override;
+
+    ComputeDerivatives derivatives() const override { return &Lorenz96Problem::computeDerivatives<double>; }
+
+    TypedODESolver<float>::Derivatives derivativesFloat() const override { return &Lorenz96Problem::computeDerivatives<float>; }
+
+    template<typename Real>
+    static void computeDerivatives(double t, Real y[], Real dydt[], void* userData);
+};
+
+/*!
+ * \brief The VanDerPolProblem class is the Van der Pol oscillator with stiffness parameter mu (n = 2).
+ */
+class VanDerPolProblem : public ODEBenchmarkProblem
+{
+  public:
+
+    VanDerPolProblem(double mu);
+
+    QString name() const override { return "vanderpol"; }
+
+    bool stiff() const override { return m_parameter > 10.0; }
+
+    void initialConditions(double y[]) const override;
+
+    ComputeDerivatives derivatives() const override { return &VanDerPolProblem::computeDerivatives<double>; }
+
+    TypedODESolver<float>::Derivatives derivativesFloat() const override { return &VanDerPolProblem::computeDerivatives<float>; }
+
+    template<typename Real>
+    static void computeDerivatives(double t, Real y[], Real dydt[], void* userData);
+};
+
+/*!
+ * \brief The BatchedCellsProblem class holds M independent cells of the kinetics A -> B, 2B -> C
+ * with per cell rates, solved as one system (n = 3M).
+ */
+class BatchedCellsProblem : public ODEBenchmarkProblem
+{
+  public:
+
+    BatchedCellsProblem(int numCells);
+
+    QString name() const override { return "batchedcells"; }
+
+    bool stiff() const override { return false; }
+
+    void initialConditions(double y[]) const override;
+
+    ComputeDerivatives derivatives() const override { return &BatchedCellsProblem::computeDerivatives<double>; }
+
+    TypedODESolver<float>::Derivatives derivativesFloat() const override { return &BatchedCellsProblem::computeDerivatives<float>; }
+
+    template<typename Real>
+    static void computeDerivatives(double t, Real y[], Real dydt[], void* userData);
+
+  private:
+
+    int m_numCells;
+    std::vector<double> m_k1,
+    m_k2;
+};
+
+#endif // ODEBENCHMARKPROBLEMS_H
@@ -0,0 +1,129 @@
+/*!
+*  \file    odebenchmarkregression.h
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  Compares benchmark results against a stored baseline and flags performance regressions.
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#ifndef ODEBENCHMARKREGRESSION_H
+#define ODEBENCHMARKREGRESSION_H
+
+#include "benchmark/odebenchmark.h"
+
+#include <stdio.h>
+#include <vector>
+
+/*!
+ * \brief The ODEBenchmarkComparison struct is the comparison of one benchmark case with its baseline.
+ * Time ratios are current over baseline time per step, so values above one are slowdowns.
+ */
+struct ODEBenchmarkComparison
+{
+    ODEBenchmarkComparison();
+
+    QString key;
+
+    double baselineTimePerStep,
+    currentTimePerStep,
+    timeRatio,
+    timeRatioLower,
+    timeRatioUpper;
+
+    long long baselineEvaluations,
+    currentEvaluations;
+
+    bool missingBaseline,
+    statusRegression,
+    timeRegression,
+    evaluationRegression;
+
+    /*!
+     * \brief regression
+     * \return True if any of the checks failed.
+     */
+    bool regression() const;
+};
+
+class ODEBenchmarkRegression
+{
+  public:
+
+    ODEBenchmarkRegression();
+
+    /*!
+     * \brief setTimeThreshold Relative slowdown in time per step tolerated before failing, e.g. 0.1 for 10%.
+     * \param threshold
+     */
+    void setTimeThreshold(double threshold);
+
+    /*!
+     * \brief setEvaluationThreshold Relative increase in derivative evaluations tolerated before failing.
+     * \param threshold
+     */
+    void setEvaluationThreshold(double threshold);
+
+    /*!
+     * \brief setConfidenceLevel Confidence level of the bootstrap interval on the time ratio, e.g. 0.95.
+     * \param level
+     */
+    void setConfidenceLevel(double level);
+
+    /*!
+     * \brief setBootstrapSamples
+     * \param samples
+     */
+    void setBootstrapSamples(int samples);
+
+    /*!
+     * \brief compare Matches current results to the baseline by ODEBenchmarkResult::key. A time regression
+     * is reported only when the whole confidence interval of the ratio of medians lies above 1 + threshold,
+     * so timing noise within the repeats does not fail the gate. Derivative evaluation counts are
+     * deterministic and are compared directly.
+     * \param baseline
+     * \param current
+     * \return
+     */
+    std::vector<ODEBenchmarkComparison> compare(const std::vector<ODEBenchmarkResult> &baseline,
+                                                const std::vector<ODEBenchmarkResult> &current) const;
+
+    /*!
+     * \brief printReport
+     * \param comparisons
+     * \param stream
+     * \return Number of regressions.
+     */
+    int printReport(const std::vector<ODEBenchmarkComparison> &comparisons, FILE *stream) const;
+
+  private:
+
+    /*!
+     * \brief bootstrapRatio Percentile bootstrap interval of median(current) / median(baseline).
+     */
+    void bootstrapRatio(const std::vector<double> &baseline, const std::vector<double> &current,
+                        double &lower, double &upper) const;
+
+    static double median(std::vector<double> values);
+
+  private:
+
+    double m_timeThreshold,
+    m_evaluationThreshold,
+    m_confidenceLevel;
+
+    int m_bootstrapSamples;
+};
+
+#endif // ODEBENCHMARKREGRESSION_H
@@ -0,0 +1,432 @@
+/*!
+ *  \file    fixedodesolver.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  Compile-time sized Runge Kutta solvers for small systems of equations.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef FIXEDODESOLVER_H
+#define FIXEDODESOLVER_H
+
+#include "odesolver.h"
+
+#include <algorithm>
+#include <array>
+#include <math.h>
+
+/*!
+ * \brief The FixedODEUnroll struct expands a loop over [I, N) at compile time.
+ */
+template<int I, int N>
+struct FixedODEUnroll
+{
+    template<typename Function>
+    static inline void apply(Function &function)
+    {
+      function(I);
+      FixedODEUnroll<I + 1, N>::apply(function);
+    }
+};
+
+template<int N>
+struct FixedODEUnroll<N, N>
+{
+    template<typename Function>
+    static inline void apply(Function &)
+    {
+    }
+};
+
+/*!
+ * \brief fixedUnroll Calls function(i) for i = 0..N-1 without a runtime loop.
+ * \param function
+ */
+template<int N, typename Function>
+inline void fixedUnroll(Function &&function)
+{
+  FixedODEUnroll<0, N>::apply(function);
+}
+
+/*!
+ * \brief The FixedODESolver class is a specialisation of the RK4 and RKQS solvers of ODESolver
+ * for systems whose size N is known at compile time. All the state is kept in std::array on
+ * the stack, loops are fully unrolled and the heap is never touched, which removes the
+ * allocation and OpenMP overhead that dominates for systems of 1 - 16 equations.
+ * The derivative functor passed to solve has the signature
+ * void(double t, const std::array<double, N> &y, std::array<double, N> &dydt).
+ */
+template<int N>
+class FixedODESolver
+{
+  public:
+
+    typedef std::array<double, N> State;
+
+    /*!
+     * \brief The SolverType enum
+     */
+    enum SolverType
+    {
+      RK4,
+      RKQS
+    };
+
+    /*!
+     * \brief FixedODESolver
+     * \param solverType
+     */
+    FixedODESolver(SolverType solverType = RKQS)
+      : m_maxSteps(50000),
+        m_currentIterations(0),
+        m_safety(0.9),
+        m_pgrow(-0.2),
+        m_pshrnk(-0.25),
+        m_errcon(1.89e-4),
+        m_relTol(1e-6),
+        m_solverType(solverType)
+    {
+    }
+
+    /*!
+     * \brief size
+     * \return
+     */
+    int size() const
+    {
+      return N;
+    }
+
+    /*!
+     * \brief solverType
+     * \return
+     */
+    SolverType solverType() const
+    {
+      return m_solverType;
+    }
+
+    /*!
+     * \brief setSolverType
+     * \param solverType
+     */
+    void setSolverType(SolverType solverType)
+    {
+      m_solverType = solverType;
+    }
+
+    /*!
+     * \brief maxIterations
+     * \return
+     */
+    int maxIterations() const
+    {
+      return m_maxSteps;
+    }
+
+    /*!
+     * \brief setMaxIterations
+     * \param iterations
+     */
+    void setMaxIterations(int iterations)
+    {
+      if(iterations > 0)
+        m_maxSteps = iterations;
+    }
+
+    /*!
+     * \brief getIterations
+     * \return
+     */
+    int getIterations() const
+    {
+      return m_currentIterations;
+    }
+
+    /*!
+     * \brief relativeTolerance
+     * \return
+     */
+    double relativeTolerance() const
+    {
+      return m_relTol;
+    }
+
+    /*!
+     * \brief setRelativeTolerance
+     * \param tolerance
+     */
+    void setRelativeTolerance(double tolerance)
+    {
+      m_relTol = tolerance;
+    }
+
+    /*!
+     * \brief solve Advances y from t to t + dt. yout may be the same object as y.
+     * \param y
+     * \param t
+     * \param dt
+     * \param yout
+     * \param derivs Functor with signature void(double t, const State &y, State &dydt).
+     * \return 0 on success, 2 if the step size underflowed and 3 if maxIterations was exceeded.
+     */
+    template<typename Derivatives>
+    int solve(const State &y, double t, double dt, State &yout, Derivatives derivs)
+    {
+      switch (m_solverType)
+      {
+        case RKQS:
+          return rkqsDriver(y, t, dt, yout, derivs);
+        default:
+          return rk4(y, t, dt, yout, derivs);
+      }
+    }
+
+    /*!
+     * \brief solve Overload taking the same raw arrays and callback as ODESolver::solve.
+     * \param y
+     * \param t
+     * \param dt
+     * \param yout
+     * \param derivs
+     * \param userData
+     * \return
+     */
+    int solve(double y[], double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
+    {
+      State ys, youts;
+      fixedUnroll<N>([&](int i){ ys[i] = y[i]; });
+
+      RedirectDerivatives redirect = {derivs, userData};
+      int result = solve(ys, t, dt, youts, redirect);
+
+      fixedUnroll<N>([&](int i){ yout[i] = youts[i]; });
+
+      return result;
+    }
+
+  private:
+
+    struct RedirectDerivatives
+    {
+        ComputeDerivatives derivs;
+        void *userData;
+
+        void operator()(double t, const State &y, State &dydt) const
+        {
+          derivs(t, const_cast<double*>(y.data()), dydt.data(), userData);
+        }
+    };
+
+    /*!
+     * \brief rk4 Fourth-order Runge-Kutta step. See ODESolver::rk4.
+     */
+    template<typename Derivatives>
+    int rk4(const State &y, double t, double dt, State &yout, Derivatives &derivs)
+    {
+      State dym, dyt, yt, dydt;
+
+      double dtt = dt * 0.5;
+      double dt6 = dt / 6.0;
+      double tdt = t + dtt;
+
+      derivs(t, y, dydt);
+
+      fixedUnroll<N>([&](int i){ yt[i] = y[i] + dtt * dydt[i]; }); //First step.
+
+      derivs(tdt, yt, dyt); //Second step.
+
+      fixedUnroll<N>([&](int i){ yt[i] = y[i] + dtt * dyt[i]; });
+
+      derivs(tdt, yt, dym); //Third step.
+
+      fixedUnroll<N>([&](int i)
+      {
+        yt[i] = y[i] + dt * dym[i];
+        dym[i] += dyt[i];
+      });
+
+      derivs(t + dt, yt, dyt); //Fourth step.
+
+      fixedUnroll<N>([&](int i){ yout[i] = y[i] + dt6 * (dydt[i] + dyt[i] + 2.0 * dym[i]); });
+
+      m_currentIterations = 1;
+
+      return 0;
+    }
+
+    /*!
+     * \brief rkqsDriver Adaptive Cash-Karp driver. See ODESolver::rkqsDriver.
+     */
+    template<typename Derivatives>
+    int rkqsDriver(const State &y, double t, double dt, State &yout, Derivatives &derivs)
+    {
+      const double tiny = 1.0e-30;
+      double tDid, tNext;
+      double t_est = t;
+      double dt_est = dt;
+      double t_end = t + dt;
+
+      State yscal, dydt;
+      yout = y;
+
+      for (int nstp = 1; nstp <= m_maxSteps; nstp++)
+      {
+        m_currentIterations = nstp;
+
+        derivs(t_est, yout, dydt);
+
+        fixedUnroll<N>([&](int i){ yscal[i] = fabs(yout[i]) + fabs(dydt[i] * dt_est) + tiny; });
+
+        if (((t_est + dt_est) - t_end) * (t_est + dt_est - t) > 0.0)
+        {
+          dt_est = t + dt - t_est;
+        }
+
+        if(rkqs(&t_est, dydt, yscal, yout, dt_est, &tDid, &tNext, derivs))
+        {
+          return 2;
+        }
+
+        if((t_est - t_end) * (t_end - t) >= 0.0)
+        {
+          return 0;
+        }
+
+        if (fabs(tNext) <= 0.0)
+        {
+          return 2;
+        }
+
+        dt_est = tNext;
+      }
+
+      return 3;
+    }
+
+    /*!
+     * \brief rkqs Fifth-order step with local truncation error monitoring. See ODESolver::rkqs.
+     */
+    template<typename Derivatives>
+    int rkqs(double *t, const State &dydt, const State &yscal, State &yout, double dtTry,
+             double *dtDid, double *dtNext, Derivatives &derivs)
+    {
+      double errmax, dtTemp, tnew, told = *t;
+      double dt = dtTry;
+      State ytemp, yerr;
+
+      for (;;)
+      {
+        rkck(told, dydt, yout, dt, ytemp, yerr, derivs);
+
+        errmax = 0.0;
+        fixedUnroll<N>([&](int i){ errmax = std::max(errmax, fabs(yerr[i] / yscal[i])); });
+        errmax /= m_relTol;
+
+        if (errmax > 1.0)
+        {
+          dtTemp = m_safety * dt * pow(errmax, m_pshrnk);
+
+          if (dt >= 0)
+            dt = dtTemp > 0.1 * dt ? dtTemp : 0.1 * dt;
+          else
+            dt = dtTemp < 0.1 * dt ? dtTemp : 0.1 * dt;
+
+          tnew = told + dt;
+
+          if (tnew == told)
+            return 2;
+
+          continue;
+        }
+        else
+        {
+          if (errmax > m_errcon)
+            *dtNext = m_safety * dt * pow(errmax, m_pgrow);
+          else
+            *dtNext = 5.0 * dt;
+
+          *t += (*dtDid = dt);
+          yout = ytemp;
+
+          return 0;
+        }
+      }
+    }
+
+    /*!
+     * \brief rkck Cash-Karp step of size dt from yout. See ODESolver::rkck.
+     */
+    template<typename Derivatives>
+    void rkck(double t, const State &dydt, const State &yout, double dt, State &ytemp, State &yerr, Derivatives &derivs)
+    {
+      const double a2=0.2, a3=0.3, a4=0.6, a5=1.0, a6=0.875,
+          b21=0.2, b31=3.0/40.0, b32=9.0/40.0, b41=0.3, b42= -0.9, b43=1.2,
+          b51= -11.0/54.0, b52=2.5, b53= -70.0/27.0, b54=35.0/27.0,
+          b61=1631.0/55296.0, b62=175.0/512.0, b63=575.0/13824.0,
+          b64=44275.0/110592.0, b65=253.0/4096.0, c1=37.0/378.0,
+          c3=250.0/621.0, c4=125.0/594.0, c6=512.0/1771.0,
+          dc5= -277.0/14336.0;
+      const double dc1=c1-2825.0/27648.0, dc3=c3-18575.0/48384.0,
+          dc4=c4-13525.0/55296.0, dc6=c6-0.25;
+
+      State ak2, ak3, ak4, ak5, ak6;
+
+      fixedUnroll<N>([&](int i){ ytemp[i] = yout[i] + b21 * dt * dydt[i]; });
+
+      derivs(t + a2 * dt, ytemp, ak2);
+
+      fixedUnroll<N>([&](int i){ ytemp[i] = yout[i] + dt * (b31*dydt[i]+b32*ak2[i]); });
+
+      derivs(t + a3 * dt, ytemp, ak3);
+
+      fixedUnroll<N>([&](int i){ ytemp[i] = yout[i] + dt *(b41*dydt[i]+b42*ak2[i] + b43*ak3[i]); });
+
+      derivs(t + a4 * dt, ytemp, ak4);
+
+      fixedUnroll<N>([&](int i){ ytemp[i] = yout[i] + dt *(b51*dydt[i]+b52*ak2[i] + b53*ak3[i] + b54*ak4[i]); });
+
+      derivs(t + a5 * dt, ytemp, ak5);
+
+      fixedUnroll<N>([&](int i)
+      {
+        ytemp[i] = yout[i] + dt * (b61 * dydt[i] + b62 * ak2[i] + b63 * ak3[i] + b64 * ak4[i]
+                                   + b65 * ak5[i]);
+      });
+
+      derivs(t + a6 * dt, ytemp, ak6);
+
+      fixedUnroll<N>([&](int i)
+      {
+        ytemp[i] = yout[i] + dt *(c1 * dydt[i] + c3 * ak3[i] + c4 * ak4[i] + c6 * ak6[i]);
+        yerr[i] = dt *(dc1 * dydt[i] + dc3 * ak3[i] + dc4 * ak4[i] + dc5 * ak5[i] + dc6 * ak6[i]);
+      });
+    }
+
+  private:
+
+    int m_maxSteps,
+    m_currentIterations;
+
+    double m_safety,
+    m_pgrow,
+    m_pshrnk,
+    m_errcon,
+    m_relTol;
+
+    SolverType m_solverType;
+};
+
+#endif // FIXEDODESOLVER_H
@@ -0,0 +1,216 @@
+/*!
+ *  \file    lockstepodesolver.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  Lockstep integration of many independent systems of the same size, one system per SIMD lane.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef LOCKSTEPODESOLVER_H
+#define LOCKSTEPODESOLVER_H
+
+#include "odesolver_global.h"
+
+class ODEBatchState;
+
+/*!
+ * Vector form of ComputeDerivatives. Evaluates the derivatives of lanes independent systems at once.
+ * Component i of lane l is stored at y[i * lanes + l] and each lane has its own time t[l].
+ * firstSystem is the index of the system held in lane 0. Lanes past the last system are padding
+ * and hold a copy of the last system.
+ */
+typedef void (*ComputeLockstepDerivatives)(const double t[], double y[], double dydt[], int n, int firstSystem, int lanes, void* userData);
+
+class ODESOLVER_EXPORT LockstepODESolver
+{
+
+  public:
+
+    /*!
+     * \brief The SolverType enum
+     */
+    enum SolverType
+    {
+      RK4,
+      RKQS
+    };
+
+    /*!
+     * \brief LockstepODESolver
+     * \param size Number of equations in each system.
+     * \param lanes Number of systems advanced together. 8 or 4.
+     * \param solverType
+     */
+    LockstepODESolver(int size, int lanes, SolverType solverType);
+
+    ~LockstepODESolver();
+
+    /*!
+     * \brief initialize Allocates the per thread workspaces.
+     */
+    void initialize();
+
+    /*!
+     * \brief size
+     * \return
+     */
+    int size() const;
+
+    /*!
+     * \brief setSize
+     * \param size
+     */
+    void setSize(int size);
+
+    /*!
+     * \brief lanes
+     * \return
+     */
+    int lanes() const;
+
+    /*!
+     * \brief setLanes Any value of 8 or more selects 8 lanes, anything less selects 4.
+     * \param lanes
+     */
+    void setLanes(int lanes);
+
+    /*!
+     * \brief solverType
+     * \return
+     */
+    SolverType solverType() const;
+
+    /*!
+     * \brief setSolverType
+     * \param solverType
+     */
+    void setSolverType(SolverType solverType);
+
+    /*!
+     * \brief maxIterations
+     * \return
+     */
+    int maxIterations() const;
+
+    /*!
+     * \brief setMaxIterations
+     * \param iterations
+     */
+    void setMaxIterations(int iterations);
+
+    /*!
+     * \brief getIterations
+     * \return Largest number of steps taken by any system during the last solve.
+     */
+    int getIterations() const;
+
+    /*!
+     * \brief relativeTolerance
+     * \return
+     */
+    double relativeTolerance() const;
+
+    /*!
+     * \brief setRelativeTolerance
+     * \param tolerance
+     */
+    void setRelativeTolerance(double tolerance);
+
+    /*!
+     * \brief solve Advances numSystems independent systems from t to t + dt. System s is stored
+     * contiguously at y[s * size()]. Blocks of lanes() systems are packed into lanes, integrated
+     * in lockstep and unpacked into yout, which need not be distinct from y. For RKQS each lane
+     * has its own step size and steps are accepted or rejected per lane. Blocks are distributed
+     * over OpenMP threads so derivs must be thread safe.
+     * \param y
+     * \param numSystems
+     * \param t
+     * \param dt
+     * \param yout
+     * \param derivs
+     * \param userData
+     * \return 0 on success or the first non zero status returned for a system.
+     */
+    int solve(double y[], int numSystems, double t, double dt, double yout[], ComputeLockstepDerivatives derivs, void* userData);
+
+    /*!
+     * \brief solve Advances the systems of an ODEBatchState from t to t + dt. The blocks are integrated in
+     * place in yout without packing, on the threads that first touched them. yout may be y.
+     * \param y
+     * \param t
+     * \param dt
+     * \param yout Same size, number of systems and lanes as y.
+     * \param derivs
+     * \param userData
+     * \return 1 if the layout of y or yout does not match size() and lanes(), otherwise as for the array form.
+     */
+    int solve(const ODEBatchState &y, double t, double dt, ODEBatchState &yout, ComputeLockstepDerivatives derivs, void* userData);
+
+  private:
+
+    template<int W>
+    int solveBatch(const ODEBatchState &y, double t, double dt, ODEBatchState &yout, ComputeLockstepDerivatives derivs, void* userData);
+
+    template<int W>
+    int solveBlocks(double y[], int numSystems, double t, double dt, double yout[], ComputeLockstepDerivatives derivs, void* userData);
+
+    /*!
+     * \brief rk4 Fourth-order Runge-Kutta step applied to the W packed systems in y.
+     */
+    template<int W>
+    int rk4(double *workspace, double y[], int firstSystem, double t, double dt, int *steps, ComputeLockstepDerivatives derivs, void* userData);
+
+    /*!
+     * \brief rkqs Adaptive Cash-Karp integration of the W packed systems in y with a step size per lane.
+     */
+    template<int W>
+    int rkqs(double *workspace, double y[], int firstSystem, double t, double dt, int *steps, ComputeLockstepDerivatives derivs, void* userData);
+
+    /*!
+     * \brief rkck Cash-Karp step of lane sizes dt[] from lane times t[].
+     */
+    template<int W>
+    void rkck(double *workspace, const double t[], const double dt[], double dydt[], double y[], int firstSystem, ComputeLockstepDerivatives derivs, void* userData);
+
+    /*!
+     * \brief workspaceSize Number of doubles needed per thread.
+     * \return
+     */
+    int workspaceSize() const;
+
+    /*!
+     * \brief clearMemory
+     */
+    void clearMemory();
+
+  private:
+
+    int m_size,
+    m_lanes,
+    m_maxSteps,
+    m_currentIterations,
+    m_numThreads;
+
+    double m_safety,
+    m_pgrow,
+    m_pshrnk,
+    m_errcon,
+    m_relTol,
+    *m_workspace;
+
+    SolverType m_solverType;
+};
+
+#endif // LOCKSTEPODESOLVER_H
@@ -0,0 +1,186 @@
+/*!
+ *  \file    odeasync.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  Completion handles and the thread pool of ODESolver::solveAsync.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef ODEASYNC_H
+#define ODEASYNC_H
+
+#include "odesolver_global.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * \brief The ODESolveHandle class tracks a solve running on the ODEThreadPool. Progress is the time of the last
+ * accepted step, or for CVODE of the last derivative evaluation, and is updated from the solving thread.
+ * Cancellation is cooperative: the solve stops after its next accepted step and returns 4, leaving yout at the state
+ * of currentTime(), from which a later solve may continue. A cancelled CVODE solve stops in a derivative evaluation
+ * and moves currentTime() back to its last accepted step. EULER, RK4 and LSRK4 take a single step and can only be
+ * cancelled before they start.
+ */
+class ODESOLVER_EXPORT ODESolveHandle
+{
+    friend class ODESolver;
+
+  public:
+
+    /*!
+     * \brief ODESolveHandle
+     * \param t Start of the solve interval.
+     * \param dt Length of the solve interval.
+     */
+    ODESolveHandle(double t, double dt);
+
+    /*!
+     * \brief isFinished
+     * \return true once the solve has returned and yout may be read.
+     */
+    bool isFinished() const;
+
+    /*!
+     * \brief wait Blocks until the solve has returned.
+     * \return Status of ODESolver::solve, or 4 if cancelled.
+     */
+    int wait() const;
+
+    /*!
+     * \brief waitFor Blocks until the solve has returned or seconds have passed.
+     * \param seconds
+     * \return isFinished().
+     */
+    bool waitFor(double seconds) const;
+
+    /*!
+     * \brief status
+     * \return Status of the finished solve, or -1 while it runs.
+     */
+    int status() const;
+
+    /*!
+     * \brief cancel Requests the solve to stop at its next accepted step.
+     */
+    void cancel();
+
+    bool cancelRequested() const;
+
+    /*!
+     * \brief currentTime
+     * \return Time the solve has reached.
+     */
+    double currentTime() const;
+
+    /*!
+     * \brief progress
+     * \return Fraction of the solve interval done, from 0 to 1.
+     */
+    double progress() const;
+
+  private:
+
+    void setCurrentTime(double t);
+
+    /*!
+     * \brief setContinuation Submits task to the ODEThreadPool when this solve finishes, so a solve queued behind it
+     * does not hold a worker while it waits.
+     * \param task
+     * \return false if the solve has already finished, in which case task is not kept.
+     */
+    bool setContinuation(const std::function<void()> &task);
+
+    /*!
+     * \brief finish Records status, wakes the waiting threads and submits the continuation.
+     * \param status
+     */
+    void finish(int status);
+
+  private:
+
+    double m_t,
+    m_dt;
+    std::atomic<double> m_currentTime;
+    std::atomic<bool> m_cancel;
+    int m_status;
+    bool m_finished;
+    std::function<void()> m_continuation;
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_finishedCondition;
+};
+
+/*!
+ * \brief The ODEThreadPool class runs tasks on a fixed set of worker threads in the order they were submitted.
+ * Workers are started as tasks arrive, up to threads(). A solve on a worker still parallelizes over its own OpenMP
+ * team, so solves running together on many workers may oversubscribe the cores.
+ */
+class ODESOLVER_EXPORT ODEThreadPool
+{
+  public:
+
+    /*!
+     * \brief instance
+     * \return Pool shared by all solvers of the process.
+     */
+    static ODEThreadPool &instance();
+
+    ~ODEThreadPool();
+
+    /*!
+     * \brief threads Largest number of workers. Defaults to the hardware concurrency.
+     * \return
+     */
+    int threads() const;
+
+    /*!
+     * \brief setThreads Workers already started are kept.
+     * \param threads
+     */
+    void setThreads(int threads);
+
+    /*!
+     * \brief submit Queues task to run on a worker.
+     * \param task
+     */
+    void submit(const std::function<void()> &task);
+
+  private:
+
+    ODEThreadPool();
+
+    ODEThreadPool(const ODEThreadPool &) = delete;
+
+    ODEThreadPool &operator=(const ODEThreadPool &) = delete;
+
+    void work();
+
+  private:
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    int m_threads,
+    m_idle;
+    bool m_stop;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_taskCondition;
+};
+
+#endif // ODEASYNC_H
@@ -0,0 +1,233 @@
+/*!
+ *  \file    odeautotuner.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  Selection of the fastest solver configuration that meets an accuracy target on a representative window of a problem.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef ODEAUTOTUNER_H
+#define ODEAUTOTUNER_H
+
+#include "odesolver.h"
+
+#include <QString>
+#include <vector>
+
+/*!
+ * \brief The ODEAutotunerResult struct holds a candidate configuration and how it did on the tuning window.
+ */
+struct ODESOLVER_EXPORT ODEAutotunerResult
+{
+    ODEAutotunerResult();
+
+    /*!
+     * \brief meetsTolerance
+     * \return true if every solve call succeeded, the candidate ran to the end of the window and its error is at most one.
+     */
+    bool meetsTolerance() const;
+
+    ODESolver::SolverType solverType;
+    ODESolver::IterationMethod iterationMethod;
+    ODESolver::LinearSolverType linearSolverType;
+
+    //First non zero status of a solve call, or 0
+    int status;
+
+    //Stopped once it had taken longer than the fastest candidate so far that met the tolerance
+    bool abandoned;
+
+    //max |y - y_ref| / (absoluteTolerance + relativeTolerance |y_ref|) at the end of the window
+    double error;
+
+    //Shortest wall time of the repeats in seconds, and the derivative evaluations of one repeat
+    double time;
+    long long derivativeEvaluations;
+};
+
+/*!
+ * \brief The ODEAutotuner class integrates a short window of a problem with each candidate configuration, compares
+ * the end state with a reference solution computed at a tighter tolerance and picks the fastest candidate whose error
+ * meets the target tolerance. Candidates are clones of the given configuration, so tolerances, limits, the Jacobian
+ * pattern and the other settings carry over, with the solver type, iteration method and linear solver replaced.
+ * A candidate is stopped as soon as it is slower than the best one found so far.
+ *
+ * With a cache file and a problem name, the choice is stored as JSON under a signature made of the name, size,
+ * tolerances and OpenMP threads, and later tune calls with the same signature read it back instead of running.
+ */
+class ODESOLVER_EXPORT ODEAutotuner
+{
+  public:
+
+    /*!
+     * \brief ODEAutotuner
+     * \param configuration Solver whose settings the candidates and the reference are cloned from.
+     */
+    ODEAutotuner(const ODESolver &configuration);
+
+    ~ODEAutotuner();
+
+    /*!
+     * \brief addCandidate
+     * \param solverType
+     * \param iterationMethod Used by CVODE_ADAMS and CVODE_BDF only.
+     * \param linearSolverType Used with NEWTON only.
+     */
+    void addCandidate(ODESolver::SolverType solverType, ODESolver::IterationMethod iterationMethod = ODESolver::NEWTON,
+                      ODESolver::LinearSolverType linearSolverType = ODESolver::GMRES);
+
+    /*!
+     * \brief addDefaultCandidates Adds the built-in solvers, EXPRK2 if the configuration has a linear operator and,
+     * with USE_CVODE, CVODE_ADAMS and CVODE_BDF with functional iteration and with Newton iteration on each linear solver.
+     */
+    void addDefaultCandidates();
+
+    void clearCandidates();
+
+    int candidateCount() const;
+
+    /*!
+     * \brief solveCalls Number of equal solve calls the window is split into. Fixed step solvers take one step per call,
+     * so this sets their step size. Defaults to 100.
+     * \return
+     */
+    int solveCalls() const;
+
+    void setSolveCalls(int calls);
+
+    /*!
+     * \brief repeats Timed runs of each candidate. The shortest is kept. Defaults to 3.
+     * \return
+     */
+    int repeats() const;
+
+    void setRepeats(int repeats);
+
+    /*!
+     * \brief relativeTolerance Accuracy target of the end state. Defaults to the tolerances of the configuration.
+     * \return
+     */
+    double relativeTolerance() const;
+
+    double absoluteTolerance() const;
+
+    void setTolerance(double relativeTolerance, double absoluteTolerance);
+
+    /*!
+     * \brief referenceSolverType Solver of the reference solution. Defaults to RKQS; use CVODE_BDF for stiff problems.
+     * \return
+     */
+    ODESolver::SolverType referenceSolverType() const;
+
+    void setReferenceSolverType(ODESolver::SolverType solverType);
+
+    /*!
+     * \brief referenceFactor The reference runs at the tolerances of the configuration times this factor. Defaults to 1e-3.
+     * \return
+     */
+    double referenceFactor() const;
+
+    void setReferenceFactor(double factor);
+
+    /*!
+     * \brief cacheFile JSON file of tuned configurations. Empty, the default, disables caching.
+     * \return
+     */
+    QString cacheFile() const;
+
+    void setCacheFile(const QString &filePath);
+
+    /*!
+     * \brief tune Runs the candidates from y at t over dt.
+     * \param y
+     * \param n Size of the configuration.
+     * \param t
+     * \param dt Length of the window.
+     * \param derivs
+     * \param userData
+     * \param problem Name of the problem in the cache signature. Empty names are not cached.
+     * \return 0 if a candidate met the tolerance, the status of the reference solve if it failed, otherwise 1, as for
+     * a size other than that of the configuration.
+     */
+    int tune(const double y[], int n, double t, double dt, ComputeDerivatives derivs, void* userData,
+             const QString &problem = QString());
+
+    /*!
+     * \brief results
+     * \return The candidates of the last tune call in the order they were added, or only the cached choice.
+     */
+    const std::vector<ODEAutotunerResult> &results() const;
+
+    /*!
+     * \brief best
+     * \return The fastest candidate that met the tolerance in the last successful tune call.
+     */
+    const ODEAutotunerResult &best() const;
+
+    /*!
+     * \brief fromCache
+     * \return true if the last tune call read its choice from the cache file.
+     */
+    bool fromCache() const;
+
+    /*!
+     * \brief createSolver
+     * \return New initialized solver with the configuration and the settings of best(), owned by the caller.
+     */
+    ODESolver *createSolver() const;
+
+    /*!
+     * \brief signature
+     * \param problem
+     * \param n
+     * \return Cache key of problem at size n with the current tolerances and OpenMP threads.
+     */
+    QString signature(const QString &problem, int n) const;
+
+  private:
+
+    /*!
+     * \brief createCandidate Clone of the configuration with the settings of result.
+     */
+    ODESolver *createCandidate(const ODEAutotunerResult &result) const;
+
+    /*!
+     * \brief run Integrates the window with solver into yout and returns the first failed status, or -1 once timeLimit
+     * seconds have passed at the end of a call.
+     */
+    int run(ODESolver *solver, const double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs,
+            void* userData, double timeLimit, double *time) const;
+
+    bool readCache(const QString &key);
+
+    bool writeCache(const QString &key) const;
+
+  private:
+
+    ODESolver *m_configuration;
+    std::vector<ODEAutotunerResult> m_candidates,
+    m_results;
+    int m_best,
+    m_solveCalls,
+    m_repeats;
+    double m_relTol,
+    m_absTol,
+    m_referenceFactor;
+    ODESolver::SolverType m_referenceSolverType;
+    QString m_cacheFile;
+    bool m_fromCache;
+};
+
+#endif // ODEAUTOTUNER_H
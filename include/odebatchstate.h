@@ -0,0 +1,169 @@
+/*!
+ *  \file    odebatchstate.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  Aligned, blocked structure-of-arrays storage for the states of many independent systems.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef ODEBATCHSTATE_H
+#define ODEBATCHSTATE_H
+
+#include "odesolver_global.h"
+
+#include <stddef.h>
+
+/*!
+ * \brief ODE_BATCH_ALIGNMENT Alignment in bytes of the batch state blocks, one cache line.
+ */
+#define ODE_BATCH_ALIGNMENT 64
+
+/*!
+ * \brief The ODEBatchState class stores numSystems() systems of size() components in blocks of lanes()
+ * systems. Within a block, component i of lane l is at block(b)[i * lanes() + l], the layout expected by
+ * ComputeLockstepDerivatives, so LockstepODESolver integrates the blocks in place. Blocks start on
+ * ODE_BATCH_ALIGNMENT byte boundaries and the lanes past the last system are padding that holds a copy
+ * of the last system. The memory is first touched by blocks in an OpenMP parallel loop with static
+ * schedule, the schedule LockstepODESolver uses, so each block is placed on the NUMA node of the thread
+ * that integrates it.
+ */
+class ODESOLVER_EXPORT ODEBatchState
+{
+  public:
+
+    /*!
+     * \brief ODEBatchState
+     * \param size Number of components of each system.
+     * \param numSystems
+     * \param lanes Systems per block. 8 or 4, matching LockstepODESolver::lanes.
+     */
+    ODEBatchState(int size, int numSystems, int lanes);
+
+    ODEBatchState(const ODEBatchState &other);
+
+    ~ODEBatchState();
+
+    ODEBatchState &operator=(const ODEBatchState &other);
+
+    /*!
+     * \brief size
+     * \return
+     */
+    int size() const;
+
+    /*!
+     * \brief numSystems
+     * \return
+     */
+    int numSystems() const;
+
+    /*!
+     * \brief lanes
+     * \return
+     */
+    int lanes() const;
+
+    /*!
+     * \brief numBlocks
+     * \return
+     */
+    int numBlocks() const;
+
+    /*!
+     * \brief blockStride
+     * \return Number of doubles between the starts of consecutive blocks.
+     */
+    size_t blockStride() const;
+
+    /*!
+     * \brief block
+     * \param b
+     * \return size() * lanes() values of block b.
+     */
+    double *block(int b);
+
+    const double *block(int b) const;
+
+    /*!
+     * \brief value
+     * \param system
+     * \param component
+     * \return
+     */
+    double &value(int system, int component);
+
+    double value(int system, int component) const;
+
+    /*!
+     * \brief setSystem Copies the contiguous state of one system in.
+     * \param system
+     * \param y size() values.
+     */
+    void setSystem(int system, const double y[]);
+
+    /*!
+     * \brief system Copies the state of one system out.
+     * \param system
+     * \param y size() values.
+     */
+    void system(int system, double y[]) const;
+
+    /*!
+     * \brief setSystems Copies in systems stored contiguously at y[s * size()] and fills the padding lanes.
+     * \param y
+     */
+    void setSystems(const double y[]);
+
+    /*!
+     * \brief systems Copies all systems out to y[s * size()].
+     * \param y
+     */
+    void systems(double y[]) const;
+
+    /*!
+     * \brief pad Copies the last system into the padding lanes of the last block.
+     */
+    void pad();
+
+    /*!
+     * \brief allocate Allocates count doubles aligned to ODE_BATCH_ALIGNMENT bytes without touching them.
+     * \param count
+     * \return
+     */
+    static double *allocate(size_t count);
+
+    /*!
+     * \brief deallocate Frees memory returned by allocate.
+     * \param data
+     */
+    static void deallocate(double *data);
+
+  private:
+
+    void allocateBlocks();
+
+  private:
+
+    int m_size,
+    m_numSystems,
+    m_lanes,
+    m_numBlocks;
+
+    size_t m_blockStride;
+
+    double *m_data;
+};
+
+#endif // ODEBATCHSTATE_H
@@ -0,0 +1,155 @@
+/*!
+ *  \file    odeensemble.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  Integration of an ensemble of members of the same system that differ in their parameters
+ *  and initial conditions, for parameter sweeps and uncertainty analysis.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef ODEENSEMBLE_H
+#define ODEENSEMBLE_H
+
+#include "odesolver.h"
+
+#include <vector>
+
+class LockstepODESolver;
+
+/*!
+ * ComputeDerivatives of one ensemble member. parameters holds the numParameters() values of the member.
+ * userData is shared by all members and must only be read.
+ */
+typedef void (*ComputeEnsembleDerivatives)(double t, double y[], double dydt[], const double parameters[], void* userData);
+
+/*!
+ * Vector form of ComputeEnsembleDerivatives over the lanes of a LockstepODESolver block. Component i of
+ * lane l is at y[i * lanes + l] and parameter j of lane l at parameters[j * lanes + l].
+ */
+typedef void (*ComputeEnsembleLockstepDerivatives)(const double t[], double y[], double dydt[], int n, const double parameters[], int lanes, void* userData);
+
+/*!
+ * \brief The ODEEnsemble class integrates members that share a solver configuration and right-hand side
+ * but have their own parameters and initial conditions. Members are handed to OpenMP threads one at a
+ * time so threads that finish cheap members take over the remaining ones, each thread reusing one
+ * clone of the configuration. Right-hand sides written for lanes are integrated in SIMD blocks by a
+ * LockstepODESolver when the configuration is RK4 or RKQS.
+ * Outputs are written to a preallocated tensor of numOutputs x members x size() values, where
+ * output[(k * members + m) * size() + i] is component i of member m at t + (k + 1) * dt.
+ */
+class ODESOLVER_EXPORT ODEEnsemble
+{
+  public:
+
+    /*!
+     * \brief ODEEnsemble
+     * \param configuration Solver configuration of every member, cloned.
+     * \param numParameters Number of parameters of each member.
+     */
+    ODEEnsemble(const ODESolver &configuration, int numParameters);
+
+    ~ODEEnsemble();
+
+    /*!
+     * \brief initialize Creates the per thread solvers.
+     */
+    void initialize();
+
+    int size() const;
+
+    int numParameters() const;
+
+    /*!
+     * \brief lanes Lanes of the lockstep blocks.
+     * \return
+     */
+    int lanes() const;
+
+    /*!
+     * \brief setLanes 8 or 4, as for LockstepODESolver. Takes effect at the next initialize.
+     * \param lanes
+     */
+    void setLanes(int lanes);
+
+    /*!
+     * \brief solve Integrates every member from t over numOutputs intervals of dt.
+     * \param members
+     * \param y0 Initial conditions, members x size().
+     * \param parameters Parameters, members x numParameters().
+     * \param t
+     * \param dt
+     * \param numOutputs
+     * \param output numOutputs x members x size() values.
+     * \param derivs
+     * \param userData
+     * \return 0 on success or the status of the first member that failed. Failed members stop at the failed interval.
+     */
+    int solve(int members, const double y0[], const double parameters[], double t, double dt, int numOutputs, double output[],
+              ComputeEnsembleDerivatives derivs, void* userData);
+
+    /*!
+     * \brief solve Integrates every member in lockstep blocks.
+     * \param members
+     * \param y0
+     * \param parameters
+     * \param t
+     * \param dt
+     * \param numOutputs
+     * \param output
+     * \param derivs
+     * \param userData
+     * \return 1 if the configuration is not RK4 or RKQS, otherwise the first non zero status of a block.
+     */
+    int solve(int members, const double y0[], const double parameters[], double t, double dt, int numOutputs, double output[],
+              ComputeEnsembleLockstepDerivatives derivs, void* userData);
+
+    /*!
+     * \brief memberStatus
+     * \return Status of each member in the last scalar solve.
+     */
+    const std::vector<int> &memberStatus() const;
+
+    /*!
+     * \brief statistics
+     * \return Statistics of the per thread solvers, when collected by the configuration.
+     */
+    ODESolverStatistics statistics() const;
+
+  private:
+
+    static void computeDerivatives(double t, double y[], double dydt[], void* userData);
+
+    static void computeLockstepDerivatives(const double t[], double y[], double dydt[], int n, int firstSystem, int lanes, void* userData);
+
+    void clearMemory();
+
+  private:
+
+    ODESolver *m_configuration;
+    std::vector<ODESolver*> m_solvers;
+    LockstepODESolver *m_lockstepSolver;
+
+    int m_size,
+    m_numParameters,
+    m_lanes;
+
+    std::vector<int> m_memberStatus;
+
+    //Per thread copies of the initial conditions and the lane interleaved parameters
+    std::vector<double> m_initial,
+    m_lockstepParameters;
+};
+
+#endif // ODEENSEMBLE_H
@@ -0,0 +1,246 @@
+/*!
+ *  \file    odejacobian.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  Sparse finite difference Jacobian evaluated with column colouring and the incomplete LU
+ *  factorization of I - gamma J used to precondition the Newton iterations of the implicit solvers.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef ODEJACOBIAN_H
+#define ODEJACOBIAN_H
+
+#include "odesparsity.h"
+
+#include <vector>
+
+/*!
+ * \brief The ODEJacobian class holds J = d(dydt)/dy on a sparsity pattern. Columns that share no row get
+ * the same colour, so all columns of a colour are perturbed together and the Jacobian costs one derivative
+ * evaluation per colour instead of one per column.
+ */
+class ODESOLVER_EXPORT ODEJacobian
+{
+  public:
+
+    /*!
+     * \brief ODEJacobian Colours the columns of pattern. The diagonal is added to the pattern where missing
+     * and the columns of each row are sorted.
+     * \param pattern
+     */
+    ODEJacobian(const ODESparsityPattern &pattern);
+
+    const ODESparsityPattern &pattern() const;
+
+    int size() const;
+
+    /*!
+     * \brief numColours Number of derivative evaluations per Jacobian evaluation.
+     * \return
+     */
+    int numColours() const;
+
+    /*!
+     * \brief colours Colour of each column.
+     * \return
+     */
+    const std::vector<int> &colours() const;
+
+    /*!
+     * \brief perturbationFloor Each column is perturbed by sqrt(machine epsilon) * max(|y_j|, perturbationFloor).
+     * \return
+     */
+    double perturbationFloor() const;
+
+    void setPerturbationFloor(double floor);
+
+    /*!
+     * \brief setSparseDerivatives Evaluates only the rows touched by each colour through sparse instead of calling
+     * derivs for all rows. sparse must be built on the same pattern. Not owned; nullptr disables it.
+     * \param sparse
+     */
+    void setSparseDerivatives(ODESparseDerivatives *sparse);
+
+    /*!
+     * \brief evaluate Computes the Jacobian by forward differences.
+     * \param t
+     * \param y
+     * \param dydt Derivatives at (t, y), or nullptr to compute them with an additional evaluation.
+     * \param derivs
+     * \param userData
+     */
+    void evaluate(double t, const double y[], const double dydt[], ComputeDerivatives derivs, void* userData);
+
+    /*!
+     * \brief values Entries of J in the order of pattern().columns().
+     * \return
+     */
+    const std::vector<double> &values() const;
+
+    /*!
+     * \brief multiply result = J x
+     * \param x
+     * \param result
+     */
+    void multiply(const double x[], double result[]) const;
+
+    /*!
+     * \brief factor Incomplete LU factorization without fill, ILU(0), of I - gamma J.
+     * \param gamma
+     * \return 0 on success or 1 on a zero pivot.
+     */
+    int factor(double gamma);
+
+    /*!
+     * \brief solve z = (LU)^-1 r with the last factorization. r and z may be the same array.
+     * \param r
+     * \param z
+     */
+    void solve(const double r[], double z[]) const;
+
+    /*!
+     * \brief maxAge Steps after which the Jacobian is re-evaluated even though the Newton iterations converge.
+     * \return
+     */
+    int maxAge() const;
+
+    void setMaxAge(int steps);
+
+    /*!
+     * \brief maxGammaChange Relative change of gamma since the last factorization above which I - gamma J is
+     * refactored. Below it the stale factors are still a good preconditioner.
+     * \return
+     */
+    double maxGammaChange() const;
+
+    void setMaxGammaChange(double change);
+
+    /*!
+     * \brief maxLinearIterationRate Mean Krylov iterations per Newton iteration since the last evaluation above
+     * which the Jacobian is considered stale. Zero disables the test.
+     * \return
+     */
+    double maxLinearIterationRate() const;
+
+    void setMaxLinearIterationRate(double rate);
+
+    /*!
+     * \brief invalidate Forces an evaluation at the next setup, for example after the parameters of the model changed.
+     */
+    void invalidate();
+
+    /*!
+     * \brief setup Prepares the factors of I - gamma J for a Newton iteration. The Jacobian is re-evaluated when none
+     * exists, it is older than maxAge, Newton failed to converge with it or the Krylov iterations per Newton iteration
+     * exceed maxLinearIterationRate; otherwise it is reused. The factors are reused unless the Jacobian changed or gamma
+     * moved by more than maxGammaChange. Counts are cumulative over the lifetime of the integration, across solve calls.
+     * \param t
+     * \param y
+     * \param dydt Derivatives at (t, y) or nullptr.
+     * \param gamma
+     * \param steps Steps taken.
+     * \param newtonIterations Newton iterations performed.
+     * \param linearIterations Krylov iterations performed.
+     * \param convergenceFailed Whether a Newton iteration failed to converge since the last setup.
+     * \param derivs
+     * \param userData
+     * \param evaluated Set to whether the Jacobian was re-evaluated.
+     * \return Result of factor, or 0 when the factors were reused.
+     */
+    int setup(double t, const double y[], const double dydt[], double gamma, long long steps, long long newtonIterations,
+              long long linearIterations, bool convergenceFailed, ComputeDerivatives derivs, void* userData, bool &evaluated);
+
+    /*!
+     * \brief jacobianReuses
+     * \return Number of setups that kept the previous Jacobian.
+     */
+    long long jacobianReuses() const;
+
+    /*!
+     * \brief factorizationReuses
+     * \return Number of setups that kept the previous factors.
+     */
+    long long factorizationReuses() const;
+
+    /*!
+     * \brief evaluations
+     * \return Number of Jacobian evaluations.
+     */
+    long long evaluations() const;
+
+    /*!
+     * \brief derivativeEvaluations
+     * \return Number of derivative evaluations, full or partial, spent on Jacobians.
+     */
+    long long derivativeEvaluations() const;
+
+    /*!
+     * \brief factorizations
+     * \return
+     */
+    long long factorizations() const;
+
+  private:
+
+    void colourColumns();
+
+  private:
+
+    ODESparsityPattern m_pattern;
+
+    //Rows of each column and the index of each of those entries in m_pattern.columns()
+    std::vector<int> m_columnOffsets,
+    m_columnRows,
+    m_columnEntries;
+
+    std::vector<int> m_colours,
+    m_colourOffsets,
+    m_colourColumns,
+    m_diagonal,
+    m_positions,
+    m_affected;
+
+    int m_numColours;
+    double m_perturbationFloor;
+
+    int m_maxAge;
+    double m_maxGammaChange,
+    m_maxLinearIterationRate;
+
+    //State of the last evaluation and factorization for the reuse policy
+    bool m_evaluated,
+    m_factored;
+    double m_factorGamma;
+    long long m_evaluationSteps,
+    m_evaluationNewtonIterations,
+    m_evaluationLinearIterations;
+
+    std::vector<double> m_values,
+    m_factor,
+    m_yPerturbed,
+    m_dydt,
+    m_dydtPerturbed,
+    m_increments;
+
+    ODESparseDerivatives *m_sparse;
+
+    long long m_evaluations,
+    m_derivativeEvaluations,
+    m_factorizations,
+    m_jacobianReuses,
+    m_factorizationReuses;
+};
+
+#endif // ODEJACOBIAN_H
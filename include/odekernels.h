@@ -0,0 +1,115 @@
+/*!
+ *  \file    odekernels.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  Stage combination and error norm kernels built for several instruction set levels and chosen at run time.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef ODEKERNELS_H
+#define ODEKERNELS_H
+
+#include "odesolver_global.h"
+
+/*!
+ * \brief ODE_KERNELS_MAX_LANES Most interleaved systems ODEKernels::maxScaledError takes, the widest ODEBatchState block.
+ */
+#define ODE_KERNELS_MAX_LANES 8
+
+/*!
+ * \brief The ODEKernels class holds the vector loops shared by the Runge-Kutta stages of ODESolver and LockstepODESolver.
+ * Each kernel is compiled for every instruction set level in Isa, and the highest level the processor supports is chosen
+ * the first time a kernel runs. The environment variable ODESOLVER_ISA (generic, avx2 or avx512) selects a lower level,
+ * e.g. to compare results across the levels; a level the processor does not support is ignored. Builds other than GCC
+ * or Clang on x86 have the generic kernels only.
+ *
+ * Arrays hold n components of lanes interleaved systems, component i of lane l at i * lanes + l, with one step per lane.
+ */
+class ODESOLVER_EXPORT ODEKernels
+{
+  public:
+
+    enum Isa
+    {
+      //Compiler default for the target, SSE2 on x86-64
+      GENERIC,
+      //AVX2 with fused multiply-add
+      AVX2,
+      //AVX-512 foundation
+      AVX512
+    };
+
+    /*!
+     * \brief isa
+     * \return Level of the kernels in use.
+     */
+    static Isa isa();
+
+    /*!
+     * \brief supportedIsa
+     * \return Highest level built and supported by the processor.
+     */
+    static Isa supportedIsa();
+
+    /*!
+     * \brief setIsa Switches the kernels of all solvers in the process. Not safe while a solve is running.
+     * \param isa
+     * \return false, leaving the level unchanged, if isa is above supportedIsa.
+     */
+    static bool setIsa(Isa isa);
+
+    /*!
+     * \brief isaName
+     * \param isa
+     * \return "generic", "avx2" or "avx512".
+     */
+    static const char *isaName(Isa isa);
+
+    /*!
+     * \brief isaFromName
+     * \param name Case insensitive.
+     * \param isa
+     * \return
+     */
+    static bool isaFromName(const char *name, Isa &isa);
+
+    /*!
+     * \brief combine out = y + h (c[0] k[0] + ... + c[count - 1] k[count - 1]) with h per lane.
+     * \param n
+     * \param lanes
+     * \param y nullptr for zero.
+     * \param h lanes steps.
+     * \param count 1 to 6.
+     * \param c
+     * \param k
+     * \param out May be y or one of k.
+     * \param parallel Splits the components over the OpenMP threads.
+     */
+    static void combine(int n, int lanes, const double y[], const double h[], int count, const double c[], const double *const k[],
+                        double out[], bool parallel);
+
+    /*!
+     * \brief maxScaledError errmax[l] = max(errmax[l], |err / scale|) over the components of lane l, where NaN counts as HUGE_VAL.
+     * \param n
+     * \param lanes At most ODE_KERNELS_MAX_LANES.
+     * \param err
+     * \param scale
+     * \param errmax
+     * \param parallel
+     */
+    static void maxScaledError(int n, int lanes, const double err[], const double scale[], double errmax[], bool parallel);
+};
+
+#endif // ODEKERNELS_H
@@ -0,0 +1,103 @@
+/*!
+ *  \file    odekrylov.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  Krylov subspace evaluation of the phi-functions of a matrix available only through its products with vectors,
+ *  for the exponential integrators.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef ODEKRYLOV_H
+#define ODEKRYLOV_H
+
+#include "odesolver_global.h"
+
+#include <vector>
+
+/*!
+ * \brief The ODEKrylov class approximates phi_p(h M) v, where phi_0(z) = e^z and phi_{p+1}(z) = (phi_p(z) - phi_p(0)) / z,
+ * by beta V_m phi_p(h H_m) e_1 from m Arnoldi steps on M and v. The phi-function of the small Hessenberg matrix is
+ * read off the exponential of an augmented matrix (Saad 1992, Sidje 1998), computed by scaling and squaring of a
+ * diagonal Pade approximant. The dimension grows until the a posteriori error estimate
+ * beta h h_{m+1,m} |e_m^T phi_{p+1}(h H_m) e_1| is below the tolerance.
+ */
+class ODESOLVER_EXPORT ODEKrylov
+{
+  public:
+
+    /*!
+     * Product Mv of the matrix with v. context is the pointer passed to phi.
+     */
+    typedef void (*MatrixVectorProduct)(const double v[], double Mv[], void* context);
+
+    /*!
+     * \brief ODEKrylov
+     * \param size
+     * \param maxDimension Largest Krylov subspace dimension.
+     */
+    ODEKrylov(int size, int maxDimension);
+
+    ~ODEKrylov();
+
+    int size() const;
+
+    int maxDimension() const;
+
+    /*!
+     * \brief phi Computes w = phi_p(h M) v.
+     * \param p Order of the phi-function, 0 to 3.
+     * \param h
+     * \param v
+     * \param w May not alias v.
+     * \param tolerance Bound on the 2-norm of the estimated error of w.
+     * \param product
+     * \param context
+     * \return 0 on success, 1 if the estimate was still above tolerance at maxDimension, in which case w holds
+     * the approximation of largest dimension.
+     */
+    int phi(int p, double h, const double v[], double w[], double tolerance, MatrixVectorProduct product, void* context);
+
+    /*!
+     * \brief lastDimension
+     * \return Krylov dimension of the last call to phi, which is also the number of matrix-vector products it took.
+     */
+    int lastDimension() const;
+
+  private:
+
+    /*!
+     * \brief exponential Computes e^A of the dense row major size x size matrix A into E.
+     */
+    static void exponential(std::vector<double> &A, int size, std::vector<double> &E);
+
+    /*!
+     * \brief phiHessenberg phi_p(h H_m) e_1 and phi_{p+1}(h H_m) e_1 from the leading m x m block of the Hessenberg matrix.
+     */
+    void phiHessenberg(int p, double h, int m, double phiP[], double phiP1[]);
+
+  private:
+
+    int m_size,
+    m_maxDimension,
+    m_lastDimension;
+
+    //Orthonormal basis, (maxDimension + 1) x size, and the Hessenberg matrix, (maxDimension + 1) x maxDimension row major
+    double *m_basis;
+    std::vector<double> m_hessenberg,
+    m_augmented,
+    m_exponential;
+};
+
+#endif // ODEKRYLOV_H
@@ -0,0 +1,213 @@
+/*!
+ *  \file    odeoutputsink.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  Output sinks that receive solver states at requested output times and a chunked binary
+ *  trajectory file written on a background thread.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef ODEOUTPUTSINK_H
+#define ODEOUTPUTSINK_H
+
+#include "odesolver_global.h"
+
+#include <QFile>
+#include <QString>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/*!
+ * \brief The ODEOutputSink class receives the state of an ODESolver at its output times.
+ * See ODESolver::setOutputSink.
+ */
+class ODESOLVER_EXPORT ODEOutputSink
+{
+  public:
+
+    virtual ~ODEOutputSink() {}
+
+    /*!
+     * \brief write Called once per output time, in increasing time order.
+     * \param t Output time.
+     * \param y State at t. Only valid for the duration of the call.
+     * \param n Number of components of y.
+     */
+    virtual void write(double t, const double y[], int n) = 0;
+};
+
+/*!
+ * \brief The ODETrajectoryWriter class streams output states to a binary file. Each record holds the time
+ * followed by the selected components as doubles. Records are collected in a chunk that is handed to a
+ * writer thread when full, while the solver keeps filling a second chunk, so integration only waits on the
+ * disk when the writer falls a whole chunk behind.
+ */
+class ODESOLVER_EXPORT ODETrajectoryWriter : public ODEOutputSink
+{
+  public:
+
+    ODETrajectoryWriter(const QString &filePath);
+
+    ~ODETrajectoryWriter();
+
+    /*!
+     * \brief setComponents Components to write. All components are written when empty.
+     * Must be called before open.
+     * \param components
+     */
+    void setComponents(const std::vector<int> &components);
+
+    /*!
+     * \brief setDownsample Writes every downsample-th output state only.
+     * \param downsample
+     */
+    void setDownsample(int downsample);
+
+    /*!
+     * \brief setChunkSize Number of records per chunk handed to the writer thread.
+     * \param records
+     */
+    void setChunkSize(int records);
+
+    /*!
+     * \brief open Creates the file, writes the header and starts the writer thread.
+     * \param size Number of components of the states that will be written.
+     * \return
+     */
+    bool open(int size);
+
+    /*!
+     * \brief write
+     * \param t
+     * \param y
+     * \param n
+     */
+    void write(double t, const double y[], int n) override;
+
+    /*!
+     * \brief close Writes the remaining records and waits for the writer thread.
+     * \return false if any write failed.
+     */
+    bool close();
+
+    /*!
+     * \brief records
+     * \return Number of records written so far, including those still buffered.
+     */
+    long long records() const;
+
+  private:
+
+    void flushFront();
+
+    void writerLoop();
+
+  private:
+
+    QString m_filePath;
+    QFile m_file;
+    std::vector<int> m_components;
+    int m_size,
+    m_downsample,
+    m_chunkSize;
+
+    long long m_received,
+    m_records;
+
+    std::vector<double> m_front,
+    m_back;
+
+    size_t m_frontCount,
+    m_backCount;
+
+    bool m_open,
+    m_backFull,
+    m_stop,
+    m_failed;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+};
+
+/*!
+ * \brief The ODETrajectoryReader class maps a file written by ODETrajectoryWriter. The number of records is
+ * taken from the file size so files of interrupted runs can be read up to the last complete record.
+ */
+class ODESOLVER_EXPORT ODETrajectoryReader
+{
+  public:
+
+    ODETrajectoryReader();
+
+    ~ODETrajectoryReader();
+
+    /*!
+     * \brief open
+     * \param filePath
+     * \return
+     */
+    bool open(const QString &filePath);
+
+    /*!
+     * \brief close
+     */
+    void close();
+
+    /*!
+     * \brief size Number of components of the solver states.
+     * \return
+     */
+    int size() const;
+
+    /*!
+     * \brief components Components stored in each record.
+     * \return
+     */
+    const std::vector<int> &components() const;
+
+    /*!
+     * \brief records
+     * \return
+     */
+    long long records() const;
+
+    /*!
+     * \brief time
+     * \param record
+     * \return
+     */
+    double time(long long record) const;
+
+    /*!
+     * \brief values
+     * \param record
+     * \return Pointer to components().size() values in the mapped file.
+     */
+    const double *values(long long record) const;
+
+  private:
+
+    QFile m_file;
+    const unsigned char *m_data;
+    long long m_headerSize,
+    m_records;
+    int m_size;
+    std::vector<int> m_components;
+};
+
+#endif // ODEOUTPUTSINK_H
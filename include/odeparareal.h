@@ -0,0 +1,177 @@
+/*!
+ *  \file    odeparareal.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  Parallel-in-time integration with the Parareal algorithm, using one ODESolver configuration
+ *  as the coarse propagator and another as the fine propagator.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef ODEPARAREAL_H
+#define ODEPARAREAL_H
+
+#include "odesolver.h"
+
+#include <vector>
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+/*!
+ * \brief The ODEParareal class splits each solve interval into time slices. A sequential sweep of the coarse
+ * propagator provides the starting values of every slice, the fine propagator is run on all slices in parallel,
+ * and the coarse sweep is repeated with the fine corrections, U[s+1] = G(U[s]) + F(U_old[s]) - G(U_old[s]),
+ * until the slice starting values stop changing. Iteration k makes the first k slices exact, so at most
+ * slices() iterations reproduce the serial fine solution.
+ * Fine propagations run on OpenMP threads and, with USE_MPI, slices are distributed over the ranks of the
+ * communicator. derivs must be thread safe, and every rank must call solve with the same arguments.
+ */
+class ODESOLVER_EXPORT ODEParareal
+{
+  public:
+
+    /*!
+     * \brief ODEParareal
+     * \param coarse Configuration of the coarse propagator, cloned.
+     * \param fine Configuration of the fine propagator, cloned once per slice.
+     * \param slices Number of time slices.
+     */
+    ODEParareal(const ODESolver &coarse, const ODESolver &fine, int slices);
+
+    ~ODEParareal();
+
+    /*!
+     * \brief initialize Creates and initializes the propagators of the slices owned by this process.
+     */
+    void initialize();
+
+    int size() const;
+
+    int slices() const;
+
+    void setSlices(int slices);
+
+    /*!
+     * \brief coarseSteps Calls to the coarse solver per slice, each over an equal part of the slice.
+     * \return
+     */
+    int coarseSteps() const;
+
+    void setCoarseSteps(int steps);
+
+    /*!
+     * \brief fineSteps Calls to the fine solver per slice, each over an equal part of the slice. Fixed step
+     * solvers take one step per call so this sets their step size.
+     * \return
+     */
+    int fineSteps() const;
+
+    void setFineSteps(int steps);
+
+    /*!
+     * \brief maxIterations Parareal iterations. Defaults to and is capped at slices().
+     * \return
+     */
+    int maxIterations() const;
+
+    void setMaxIterations(int iterations);
+
+    /*!
+     * \brief tolerance Iterations stop when every slice starting value changes by less than
+     * tolerance * (absoluteTolerance + relativeTolerance * |y|) of the fine solver.
+     * \return
+     */
+    double tolerance() const;
+
+    void setTolerance(double tolerance);
+
+#ifdef USE_MPI
+    /*!
+     * \brief setCommunicator Ranks to distribute the slices over. Defaults to MPI_COMM_WORLD. Takes effect at the next initialize.
+     * \param communicator
+     */
+    void setCommunicator(MPI_Comm communicator);
+#endif
+
+    /*!
+     * \brief solve Advances y from t to t + dt.
+     * \param y
+     * \param n
+     * \param t
+     * \param dt
+     * \param yout
+     * \param derivs
+     * \param userData
+     * \return 0 on success or the first non zero status of a propagator.
+     */
+    int solve(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData);
+
+    /*!
+     * \brief getIterations
+     * \return Parareal iterations of the last solve.
+     */
+    int getIterations() const;
+
+    /*!
+     * \brief statistics
+     * \return Statistics of the coarse and fine propagators of this process, when collected by the configurations.
+     */
+    ODESolverStatistics statistics() const;
+
+  private:
+
+    /*!
+     * \brief propagate Advances y over one slice in steps calls of solver.
+     */
+    static int propagate(ODESolver *solver, int steps, const double y[], int n, double t, double dt, double yout[], double work[],
+                         ComputeDerivatives derivs, void* userData);
+
+    void clearMemory();
+
+  private:
+
+    ODESolver *m_coarseConfiguration,
+    *m_fineConfiguration,
+    *m_coarse;
+
+    //Fine propagators of the slices [m_firstSlice, m_lastSlice) owned by this process
+    std::vector<ODESolver*> m_fine;
+
+    int m_size,
+    m_slices,
+    m_coarseSteps,
+    m_fineSteps,
+    m_maxIterations,
+    m_iterations,
+    m_firstSlice,
+    m_lastSlice;
+
+    double m_tolerance;
+
+    //Slice starting values, coarse and fine results, slices x size
+    std::vector<double> m_u,
+    m_coarseValues,
+    m_fineValues,
+    m_work;
+
+#ifdef USE_MPI
+    MPI_Comm m_communicator;
+    std::vector<int> m_counts,
+    m_displacements;
+#endif
+};
+
+#endif // ODEPARAREAL_H
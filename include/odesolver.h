@@ -29,27 +29,125 @@
 #include <sundials/sundials_linearsolver.h>
 #endif
 
+#include <stddef.h>
+#include <memory>
 #include <vector>
 
+/*!
+ * \brief ODESOLVER_STATE_VERSION Version of the binary blob written by ODESolver::saveState.
+ */
+#define ODESOLVER_STATE_VERSION 5
+
 class ODESolver;
+class ODEOutputSink;
+class ODESparsityPattern;
+class ODEJacobian;
+class ODEKrylov;
+class ODESolveHandle;
+
+/*!
+ * \brief The ODESolverStatistics struct holds the work done by an ODESolver. Counters that do not
+ * apply to a solver type stay at zero. Times are wall clock seconds. Derivative evaluations made inside a phase,
+ * e.g. for a Jacobian, count in derivativeTime and in that phase. Evaluations made on several threads, by the parallel
+ * GBS mode and the tiled stages, add the time of every thread. What solveTime has beyond the phases is spent in the
+ * stage combinations and in the error norms fused into them.
+ */
+struct ODESOLVER_EXPORT ODESolverStatistics
+{
+    ODESolverStatistics();
+
+    /*!
+     * \brief reset Zeros all counters and times and records the kernels in use.
+     */
+    void reset();
+
+    /*!
+     * \brief accumulate Adds the counters and times of other and widens the step size range.
+     * \param other
+     */
+    void accumulate(const ODESolverStatistics &other);
+
+    long long solveCalls,
+    derivativeEvaluations,
+    acceptedSteps,
+    rejectedSteps,
+    jacobianEvaluations,
+    linearSolverSetups,
+    linearIterations,
+    linearFailures,
+    jacobianVectorProducts,
+    nonLinearIterations,
+    nonLinearFailures;
+
+    double minStep,
+    maxStep,
+    derivativeTime,
+    solveTime;
+
+    /*!
+     * \brief linearSolveTime Jacobian evaluation, factorization and preconditioner solves of CVODE_ADAMS and CVODE_BDF
+     * with setJacobianPattern, their analytic Jacobian-vector products, and the phi-function evaluations of EXPRK2 and
+     * EXPRB32. The Krylov iterations and band preconditioner inside SUNDIALS are not included.
+     */
+    double linearSolveTime;
+
+    /*!
+     * \brief stepControlTime Error scaling and norm of RKQS, the step size controller of the adaptive solvers and
+     * the spectral radius estimates of RKC.
+     */
+    double stepControlTime;
+
+    /*!
+     * \brief kernels ODEKernels::isaName of the stage kernels in use when the counters were last reset or accumulated.
+     * Not part of the saved state.
+     */
+    const char *kernels;
+};
 
 /*!
  *
  */
 typedef void (*ComputeDerivatives)(double t, double y[], double dydt[], void* userData);
 
+/*!
+ * Product Av of the linear part A of a semilinear system dy/dt = A y + N(t, y) with v, for EXPRK2. userData is the
+ * pointer passed to solve.
+ */
+typedef void (*ComputeLinearOperator)(double t, double v[], double Av[], void* userData);
+
+/*!
+ * Product Jv of the Jacobian of the right-hand side at (t, y) with v. dydt holds the derivatives at y. userData is the
+ * pointer passed to solve.
+ */
+typedef void (*ComputeJacobianVectorProduct)(double t, double y[], double dydt[], double v[], double Jv[], void* userData);
+
+/*!
+ * Derivatives of components begin <= i < end of a right-hand side whose component i depends only on components i - halo
+ * to i + halo, for the tiled RK4 and RKQS stages. y and dydt hold the components from offset on, so component i is
+ * y[i - offset], and y is valid from max(begin - halo, 0) to min(end + halo, n). userData is the pointer passed to solve.
+ */
+typedef void (*ComputeTileDerivatives)(double t, double y[], double dydt[], int offset, int begin, int end, void* userData);
+
 /*!
  *
  */
 typedef int (ODESolver::*Solve)(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData);
 
 
+struct ODESOLVER_EXPORT StatisticsRedirectionData
+{
+    ComputeDerivatives deriv;
+    void *userData;
+    ODESolverStatistics *statistics;
+};
+
 #ifdef USE_CVODE
 
 struct ODESOLVER_EXPORT RedirectionData
 {
     ComputeDerivatives deriv;
     void *userData;
+    ODESolver *solver;
 };
 
 #endif
@@ -69,8 +167,49 @@ class ODESOLVER_EXPORT ODESolver
       RKQS,
 #ifdef USE_CVODE
       CVODE_ADAMS,
-      CVODE_BDF
+      CVODE_BDF,
 #endif
+      //Carpenter-Kennedy five stage fourth order 2N-storage scheme with a fixed step. Keeps two scratch arrays.
+      LSRK4 = 5,
+      //LSRK4 with an embedded third order error estimate and step size control on absoluteTolerance +
+      //relativeTolerance * |y|. Keeps four scratch arrays against nine for RKQS.
+      LSRK45 = 6,
+      //Variable step, variable order Adams-Bashforth-Moulton PECE of order up to min(order(), 12), with error and order
+      //estimates from differences of the corrector over orders. Two derivative evaluations per step. The history is
+      //kept across solve calls that continue from where the last one ended.
+      ADAMS = 7,
+      //Gragg-Bulirsch-Stoer extrapolation of the modified midpoint rule over the sequence 2, 4, 6, ... with
+      //min(max(order(), 4), 12) rows, i.e. up to order 2 * rows, and adaptive order and step. For smooth problems
+      //at tight tolerances.
+      GBS = 8,
+      //Second order Runge-Kutta-Chebyshev with damping 2/13 (Sommeijer, Shampine and Verwer 1997). The number of stages
+      //grows with the square root of the step times the spectral radius, which is estimated by power iteration on the
+      //right-hand side. For mildly stiff diffusion dominated systems, with no Jacobian or linear solve.
+      RKC = 9,
+      //Second order exponential time differencing Runge-Kutta ETD2RK (Cox and Matthews 2002) for semilinear systems
+      //dy/dt = A y + N(t, y) with A given by setLinearOperator. The stiff linear part is integrated exactly through
+      //Krylov approximations of phi_1(hA) and phi_2(hA), so the step follows the accuracy of the nonlinear part only.
+      EXPRK2 = 10,
+      //Third order exponential Rosenbrock exprb32 (Hochbruck, Ostermann and Schweitzer 2009) with its embedded second
+      //order method. Linearizes about the Jacobian of the whole right-hand side at each step, applied by differences
+      //of the right-hand side, so it needs no splitting.
+      EXPRB32 = 11
+    };
+
+    /*!
+     * \brief The StepController enum selects how RKQS, LSRK45 and ADAMS choose the next step size from the error of
+     * the last accepted steps. The filters are from Soderlind, Digital filters in adaptive time-stepping (2003).
+     */
+    enum StepController
+    {
+      //safety * (1 / err)^(1/k), the classic controller
+      ELEMENTARY,
+      //Gustafsson PI controller, PI.4.2
+      PI42,
+      //Second order digital filter with a proportional and integral part
+      H211PI,
+      //Third order low pass filter with proportional, integral and derivative parts; the smoothest step sequences
+      H312PID
     };
 
     enum IterationMethod
@@ -98,11 +237,21 @@ class ODESOLVER_EXPORT ODESolver
 
     ~ODESolver();
 
+    /*!
+     * \brief clone Creates a solver with the same size, type, tolerances, limits, iteration and linear solver
+     * settings, Jacobian pattern, linear operator, Jacobian-vector product and tile derivatives, initialized if this solver is. Output sinks, statistics, the ADAMS history and
+     * the sparse derivative evaluator of the Jacobian are not carried over so clones can run on separate threads.
+     * \return New solver owned by the caller.
+     */
+    ODESolver *clone() const;
+
     /*!
      * \brief initialize
      */
     void initialize();
 
+#ifdef USE_CVODE
+
     /*!
      * \brief initializeLinearSolver
      */
@@ -113,6 +262,8 @@ class ODESOLVER_EXPORT ODESolver
      */
     void initializeNonLinearSolver();
 
+#endif
+
     /*!
      * \brief size
      * \return
@@ -125,6 +276,38 @@ class ODESOLVER_EXPORT ODESolver
      */
     void setSize(int size);
 
+    /*!
+     * \brief stepController
+     * \return
+     */
+    StepController stepController() const;
+
+    /*!
+     * \brief setStepController Defaults to ELEMENTARY.
+     * \param controller
+     */
+    void setStepController(StepController controller);
+
+    /*!
+     * \brief minStepRatio Smallest ratio of a new step to the last step, after a rejection or an acceptance.
+     * \return
+     */
+    double minStepRatio() const;
+
+    /*!
+     * \brief maxStepRatio Largest ratio of a new step to the last accepted step.
+     * \return
+     */
+    double maxStepRatio() const;
+
+    /*!
+     * \brief setStepRatioLimits Bounds on the step size ratio. The filtered controllers also pass the ratio through
+     * the smooth limiter 1 + atan(ratio - 1) before the bounds. Default 0.1 and 5.
+     * \param minRatio
+     * \param maxRatio
+     */
+    void setStepRatioLimits(double minRatio, double maxRatio);
+
     /*!
      * \brief solverType
      * \return
@@ -186,7 +369,8 @@ class ODESOLVER_EXPORT ODESolver
     int order() const;
 
     /*!
-     * \brief setOrder
+     * \brief setOrder Highest order of CVODE_ADAMS, CVODE_BDF and ADAMS, and the extrapolation rows of GBS.
+     * Takes effect at the next initialize.
      * \param order
      */
     void setOrder(int order);
@@ -224,10 +408,231 @@ class ODESOLVER_EXPORT ODESolver
      * \param yout
      * \param derivs
      * \param userData
-     * \return
+     * \return 0 on success, 1 for an invalid configuration, 2 if the step size underflowed, 3 after maxIterations
+     * steps, 4 if cancelled through the handle of solveAsync, or a negative CVODE flag.
      */
     int solve(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData);
 
+    /*!
+     * \brief solveAsync Runs solve on the ODEThreadPool and returns at once, so the caller can exchange data or write
+     * output while the solver integrates. y and yout must stay valid, and yout unread, until the handle is finished, and
+     * the solver must not be used meanwhile other than through more solveAsync calls, which run in the order they were
+     * made. derivs is called on a pool thread. The destructor waits for the last call.
+     * \param y
+     * \param n
+     * \param t
+     * \param dt
+     * \param yout
+     * \param derivs
+     * \param userData
+     * \return Handle to wait for, cancel or follow the solve.
+     */
+    std::shared_ptr<ODESolveHandle> solveAsync(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs,
+                                               void* userData);
+
+    /*!
+     * \brief parallelExtrapolation
+     * \return
+     */
+    bool parallelExtrapolation() const;
+
+    /*!
+     * \brief setParallelExtrapolation Runs the modified midpoint sequences of a GBS step concurrently on OpenMP threads,
+     * longest first, instead of one after another with the state loops spread over the threads. This gives parallelism
+     * across the method when n is too small to split. Every row up to the highest one the step may need is computed, but
+     * the accepted column, and so the solution, is the same as in the sequential mode. derivs must be thread safe.
+     * Takes effect at the next initialize.
+     * \param parallel
+     */
+    void setParallelExtrapolation(bool parallel);
+
+    /*!
+     * \brief linearOperator
+     * \return
+     */
+    ComputeLinearOperator linearOperator() const;
+
+    /*!
+     * \brief setLinearOperator Linear part of the right-hand side for EXPRK2, which returns 1 from solve without it.
+     * The remainder N = f - A y must be nonstiff for the step to be limited by accuracy alone.
+     * \param linearOperator
+     */
+    void setLinearOperator(ComputeLinearOperator linearOperator);
+
+    /*!
+     * \brief jacobianVectorProduct
+     * \return
+     */
+    ComputeJacobianVectorProduct jacobianVectorProduct() const;
+
+    /*!
+     * \brief setJacobianVectorProduct Analytic Jacobian-vector products for the Krylov iterations of the Newton solves of
+     * CVODE_ADAMS and CVODE_BDF and of EXPRB32, in place of difference quotients that cost one derivative evaluation
+     * each. nullptr restores the difference quotients. Takes effect at the next initialize.
+     * \param product
+     */
+    void setJacobianVectorProduct(ComputeJacobianVectorProduct product);
+
+    /*!
+     * \brief tileDerivatives
+     * \return
+     */
+    ComputeTileDerivatives tileDerivatives() const;
+
+    /*!
+     * \brief tileHalo
+     * \return
+     */
+    int tileHalo() const;
+
+    /*!
+     * \brief setTileDerivatives Runs the stages of RK4 and of each RKQS step tile by tile instead of one sweep over the
+     * whole state per stage. Each tile computes its stages over a window widened by one halo per remaining stage, so
+     * the stage arrays of a tile stay in cache and the state is streamed from memory once per step; the halo overlap
+     * is computed redundantly. Tiles are spread over the OpenMP threads, so derivs must be thread safe. The derivatives
+     * passed to solve are still used where the whole state is needed: the start of each RKQS step and output.
+     * nullptr restores whole-array stages.
+     * \param derivs
+     * \param halo Stencil half width.
+     */
+    void setTileDerivatives(ComputeTileDerivatives derivs, int halo);
+
+    /*!
+     * \brief tileSize
+     * \return
+     */
+    int tileSize() const;
+
+    /*!
+     * \brief setTileSize Components per tile. 0, the default, sizes the stage arrays of a tile to about 256 KiB, the
+     * size of a typical L2 cache.
+     * \param size
+     */
+    void setTileSize(int size);
+
+    /*!
+     * \brief maxKrylovDimension
+     * \return
+     */
+    int maxKrylovDimension() const;
+
+    /*!
+     * \brief setMaxKrylovDimension Largest Krylov subspace used by EXPRK2 and EXPRB32 to apply a phi-function, each
+     * dimension keeping one vector of size(). A step whose phi-functions do not converge within it is halved. Default 30.
+     * Takes effect at the next initialize.
+     * \param dimension
+     */
+    void setMaxKrylovDimension(int dimension);
+
+    /*!
+     * \brief resetHistory Discards the ADAMS history so the next solve starts again at order one. The history is
+     * discarded automatically when solve is called with a t or y other than where the last call ended, but not when
+     * the right-hand side itself changes, e.g. at a discontinuity in a forcing.
+     */
+    void resetHistory();
+
+    /*!
+     * \brief collectStatistics
+     * \return
+     */
+    bool collectStatistics() const;
+
+    /*!
+     * \brief setCollectStatistics Enables collection of ODESolverStatistics. Collection is off by default
+     * and costs a single branch per solve and per step when disabled.
+     * \param collect
+     */
+    void setCollectStatistics(bool collect);
+
+    /*!
+     * \brief statistics
+     * \return Statistics accumulated over all solve calls since the last resetStatistics.
+     */
+    const ODESolverStatistics &statistics() const;
+
+    /*!
+     * \brief lastStatistics
+     * \return Statistics of the last solve call.
+     */
+    const ODESolverStatistics &lastStatistics() const;
+
+    /*!
+     * \brief resetStatistics
+     */
+    void resetStatistics();
+
+    /*!
+     * \brief stateSize
+     * \return Number of bytes written by saveState.
+     */
+    size_t stateSize() const;
+
+    /*!
+     * \brief saveState Writes the configuration, counters, statistics, ADAMS history and RKC power iteration vector to a
+     * versioned binary blob in native byte order. CVODE is re-initialized at the start of every solve call,
+     * so no CVODE history carries over between calls and the configuration alone continues it exactly.
+     * The integration state (y, t) belongs to the caller.
+     * \param buffer At least stateSize() bytes.
+     * \return Number of bytes written.
+     */
+    size_t saveState(char *buffer) const;
+
+    /*!
+     * \brief saveState
+     * \return Blob of stateSize() bytes.
+     */
+    std::vector<char> saveState() const;
+
+    /*!
+     * \brief restoreState Restores a blob written by saveState. The solver is initialized again
+     * when it has not been initialized or its size, type or CVODE solver options differ from the blob.
+     * \param buffer
+     * \param size Number of bytes available in buffer.
+     * \return 0 on success, 1 if the blob is truncated, 2 if it is not an ODESolver state of a supported
+     * version or byte order, 3 if the solver type is not available in this build.
+     */
+    int restoreState(const char *buffer, size_t size);
+
+    /*!
+     * \brief setOutputSink Streams the state at each output time reached by solve to sink. States inside
+     * a solve call are interpolated: CVODE uses its own interpolating polynomial, RK4 and RKQS a cubic
+     * Hermite interpolant between the ends of each step, which costs one extra derivative evaluation per step
+     * containing an output time, ADAMS the same interpolant from the derivatives it keeps, and Euler, LSRK4 and
+     * LSRK45 a linear one.
+     * \param sink Not owned. nullptr disables output.
+     * \param outputTimes Increasing output times.
+     */
+    void setOutputSink(ODEOutputSink *sink, const std::vector<double> &outputTimes);
+
+    /*!
+     * \brief setOutputSink Streams the state at start + k * interval, k = 0, 1, ...
+     * \param sink
+     * \param start
+     * \param interval
+     */
+    void setOutputSink(ODEOutputSink *sink, double start, double interval);
+
+    /*!
+     * \brief outputSink
+     * \return
+     */
+    ODEOutputSink *outputSink() const;
+
+    /*!
+     * \brief setJacobianPattern Sparsity pattern of the right-hand side. When set, the Newton iterations of
+     * CVODE_ADAMS and CVODE_BDF are preconditioned with ILU(0) of I - gamma J, where J is evaluated by
+     * coloured finite differences in one derivative evaluation per colour, instead of a band preconditioner
+     * of half bandwidth 2. Takes effect at the next initialize.
+     * \param pattern
+     */
+    void setJacobianPattern(const ODESparsityPattern &pattern);
+
+    /*!
+     * \brief jacobian Holds the reuse policy and its statistics.
+     * \return nullptr unless a pattern was set.
+     */
+    ODEJacobian *jacobian() const;
+
   private:
 
     /*!
@@ -259,6 +664,20 @@ class ODESOLVER_EXPORT ODESolver
      */
     int rk4(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData);
 
+    /*!
+     * \brief rk4Tiled RK4 with the stages of each tile computed together through the tile derivatives. Gives the same
+     * result as rk4.
+     * \param y
+     * \param n
+     * \param t
+     * \param dt
+     * \param yout
+     * \param derivs
+     * \param userData
+     * \return
+     */
+    int rk4Tiled(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData);
+
     /*!
      * \brief rkqsDriver Driver function for Runge-Kutta integration with adaptive
       stepsize control. Integrates starting n values in y[]
@@ -309,6 +728,142 @@ class ODESOLVER_EXPORT ODESolver
      */
     void rkck(double t, double dydt[],  double yout[], int n, double dt, ComputeDerivatives deriv, void* userData);
 
+    /*!
+     * \brief rkckTiled rkck with stages two to six of each tile computed together through the tile derivatives.
+     * \param t
+     * \param dydt
+     * \param yout
+     * \param n
+     * \param dt
+     * \param userData Caller's data.
+     */
+    void rkckTiled(double t, double dydt[], double yout[], int n, double dt, void* userData);
+
+    /*!
+     * \brief tileComponents
+     * \param arrays Arrays of the tile window kept per thread.
+     * \return Components per tile.
+     */
+    int tileComponents(int arrays) const;
+
+    /*!
+     * \brief lsrk4 Advances y over dt with the Carpenter-Kennedy (5,4) 2N-storage scheme. Each stage updates
+     * the increment register and yout in place in one pass, so yout need not be distinct from y.
+     * \param y
+     * \param n
+     * \param t
+     * \param dt
+     * \param yout
+     * \param derivs
+     * \param userData
+     * \return
+     */
+    int lsrk4(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData);
+
+    /*!
+     * \brief lsrk45 Adaptive driver for the Carpenter-Kennedy (5,4) scheme. The third order estimate shares
+     * the five stages and is accumulated into one extra register alongside the increment.
+     * \param y
+     * \param n
+     * \param t
+     * \param dt
+     * \param yout
+     * \param derivs
+     * \param userData
+     * \return 0 on success, 2 if the step size underflowed and 3 if maxIterations was exceeded.
+     */
+    int lsrk45(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData);
+
+    /*!
+     * \brief adams Adams-Bashforth-Moulton PECE driver. Predicts with the order k Adams-Bashforth formula, corrects with
+     * the order k + 1 Adams-Moulton formula, and estimates the errors of orders k - 1, k and k + 1 from the differences
+     * of the correctors of consecutive orders. Coefficients are integrals of the Lagrange basis over the actual step history.
+     * \param y
+     * \param n
+     * \param t
+     * \param dt
+     * \param yout
+     * \param derivs
+     * \param userData
+     * \return 0 on success, 2 if the step size underflowed and 3 if maxIterations was exceeded.
+     */
+    int adams(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData);
+
+    /*!
+     * \brief gbs Gragg-Bulirsch-Stoer driver. Each step extrapolates the modified midpoint rule in h^2 row by row
+     * with the Aitken-Neville scheme, accepting the first column from k - 1 to k + 1 within tolerance and choosing the
+     * next k and step from the work per unit step of the columns, as in Hairer and Wanner's ODEX.
+     * \param y
+     * \param n
+     * \param t
+     * \param dt
+     * \param yout
+     * \param derivs
+     * \param userData
+     * \return 0 on success, 2 if the step size underflowed and 3 if maxIterations was exceeded.
+     */
+    int gbs(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData);
+
+    /*!
+     * \brief gbsMidpoint Modified midpoint rule with Gragg's smoothing over H in steps substeps.
+     * \param t
+     * \param y
+     * \param dydt Derivatives at t.
+     * \param n
+     * \param H
+     * \param steps
+     * \param result
+     * \param work Three arrays of n.
+     * \param parallel Whether the state loops are spread over the OpenMP threads.
+     * \param derivs
+     * \param userData
+     */
+    static void gbsMidpoint(double t, const double y[], const double dydt[], int n, double H, int steps, double result[], double work[],
+                            bool parallel, ComputeDerivatives derivs, void* userData);
+
+    /*!
+     * \brief rkc Runge-Kutta-Chebyshev driver. Estimates the spectral radius at the start of each call, every 25 accepted
+     * steps and after each rejection, and keeps the dominant direction found as the start of the next estimate.
+     * \param y
+     * \param n
+     * \param t
+     * \param dt
+     * \param yout
+     * \param derivs
+     * \param userData
+     * \return 0 on success, 2 if the step size underflowed and 3 if maxIterations was exceeded.
+     */
+    int rkc(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData);
+
+    /*!
+     * \brief spectralRadius Nonlinear power iteration on differences of the right-hand side about y.
+     * \param t
+     * \param y
+     * \param dydt Derivatives at y.
+     * \param n
+     * \param derivs
+     * \param userData
+     * \return Estimate of the spectral radius of the Jacobian with a safety factor of 1.2.
+     */
+    double spectralRadius(double t, const double y[], const double dydt[], int n, ComputeDerivatives derivs, void* userData);
+
+    /*!
+     * \brief exponentialIntegrator EXPRK2 and EXPRB32 driver. Both take the first order exponential Euler step
+     * U = y + h phi_1(hA) f(y) and correct it with the defect D = f(U) - f(y) - A (U - y) of the linearization,
+     * y1 = U + h phi_2(hA) D for EXPRK2 and y1 = U + 2 h phi_3(hA) D for EXPRB32, where A is the linear operator or
+     * the Jacobian at y. The correction is the error estimate.
+     * \param y
+     * \param n
+     * \param t
+     * \param dt
+     * \param yout
+     * \param derivs
+     * \param userData
+     * \return 0 on success, 1 if EXPRK2 has no linear operator, 2 if the step size underflowed and 3 if maxIterations
+     * was exceeded.
+     */
+    int exponentialIntegrator(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData);
+
 #ifdef USE_CVODE
 
     /*!
@@ -333,8 +888,121 @@ class ODESOLVER_EXPORT ODESolver
      */
     static int ComputeDerivatives_CVODE(realtype t, N_Vector y, N_Vector dydt, void *user_data);
 
+    /*!
+     * \brief JacobianTimesVector_CVODE Forwards CVODE's Jacobian-vector products to the user product.
+     * \param v
+     * \param Jv
+     * \param t
+     * \param y
+     * \param fy
+     * \param user_data
+     * \param tmp
+     * \return
+     */
+    static int JacobianTimesVector_CVODE(N_Vector v, N_Vector Jv, realtype t, N_Vector y, N_Vector fy, void *user_data, N_Vector tmp);
+
+    /*!
+     * \brief PreconditionerSetup_CVODE Prepares the factors of I - gamma J, deciding on Jacobian and factorization reuse
+     * through the policy of ODEJacobian::setup rather than CVODE's jok, which is false after every CVodeReInit.
+     * \param t
+     * \param y
+     * \param fy
+     * \param jok
+     * \param jcurPtr
+     * \param gamma
+     * \param user_data
+     * \return
+     */
+    static int PreconditionerSetup_CVODE(realtype t, N_Vector y, N_Vector fy, booleantype jok, booleantype *jcurPtr, realtype gamma, void *user_data);
+
+    /*!
+     * \brief PreconditionerSolve_CVODE Solves (I - gamma J) z = r with the incomplete factors.
+     * \param t
+     * \param y
+     * \param fy
+     * \param r
+     * \param z
+     * \param gamma
+     * \param delta
+     * \param lr
+     * \param user_data
+     * \return
+     */
+    static int PreconditionerSolve_CVODE(realtype t, N_Vector y, N_Vector fy, N_Vector r, N_Vector z, realtype gamma, realtype delta, int lr, void *user_data);
+
 #endif
 
+    /*!
+     * \brief ComputeDerivatives_Statistics Counts and times calls to the user derivatives.
+     * \param t
+     * \param y
+     * \param dydt
+     * \param userData
+     */
+    static void ComputeDerivatives_Statistics(double t, double y[], double dydt[], void* userData);
+
+    /*!
+     * \brief callerData
+     * \param derivs Derivatives passed to a solver.
+     * \param userData Data passed with derivs.
+     * \return The data the caller passed to solve, looking through the wrapper that counts derivative evaluations.
+     */
+    static void *callerData(ComputeDerivatives derivs, void *userData);
+
+    /*!
+     * \brief recordStep
+     * \param dt
+     * \param accepted
+     */
+    void recordStep(double dt, bool accepted);
+
+    /*!
+     * \brief interrupted Reports the time reached to the handle of an asynchronous solve.
+     * \param t
+     * \return true if the solve was cancelled.
+     */
+    bool interrupted(double t);
+
+    /*!
+     * \brief nextOutputTime
+     * \return Next output time not yet written, or HUGE_VAL if there is none.
+     */
+    double nextOutputTime() const;
+
+    /*!
+     * \brief writeOutput Writes the output times in (t0, t1] interpolated over a step. The interpolant is
+     * linear when the derivatives are not given.
+     * \param t0
+     * \param y0
+     * \param dydt0 Derivatives at t0 or nullptr.
+     * \param t1
+     * \param y1
+     * \param dydt1 Derivatives at t1 or nullptr.
+     * \param n
+     */
+    void writeOutput(double t0, const double y0[], const double dydt0[], double t1, const double y1[], const double dydt1[], int n);
+
+    /*!
+     * \brief resetStepController Clears the error history of the step size filters at the start of a solve call.
+     */
+    void resetStepController();
+
+    /*!
+     * \brief stepRatio Ratio of the next step to the accepted step dt.
+     * \param errmax Error of the accepted step per unit tolerance.
+     * \param pgrow -1/k, where the error goes as dt^k.
+     * \param rejected Whether an attempt of this step was rejected, in which case the filtered controllers do not grow the step.
+     * \return
+     */
+    double stepRatio(double errmax, double pgrow, bool rejected);
+
+    /*!
+     * \brief scratchSize
+     * \return Number of doubles of solver scratch written by saveState: the ADAMS history or the RKC power iteration
+     * vector, which later solves read. Other scratch is rewritten before it is read and is not saved.
+     */
+    unsigned int scratchSize() const;
+
     /*!
      * \brief clearMemory
      */
@@ -348,6 +1016,15 @@ class ODESOLVER_EXPORT ODESolver
     m_order,
     m_currentIterations;
 
+    StepController m_stepController;
+    double m_minStepRatio,
+    m_maxStepRatio;
+
+    //Errors per unit tolerance and step ratios of the last accepted steps, most recent first
+    double m_controllerErrors[2],
+    m_controllerRatios[2];
+    int m_controllerHistory;
+
     //RK4 Parameters
     double m_safety,
     m_pgrow,
@@ -360,16 +1037,70 @@ class ODESOLVER_EXPORT ODESolver
     *m_ytemp,
     *m_ak;
 
+    //ADAMS derivatives at the last accepted times, newest first, plus one spare slot, and the state at the newest time
+    std::vector<double*> m_adamsDerivatives;
+    std::vector<double> m_adamsTimes;
+    double *m_adamsState,
+    m_adamsStep;
+    int m_adamsOrder,
+    m_adamsCount,
+    m_adamsStepsAtOrder;
+
+    bool m_parallelExtrapolation;
+
+    //GBS rows and midpoint mode the buffers were allocated for at the last initialize
+    int m_gbsRows;
+    bool m_gbsParallel;
+
+    //Linear part for EXPRK2, the optional analytic Jacobian-vector product and the Krylov evaluator of the
+    //phi-functions of the exponential integrators
+    ComputeLinearOperator m_linearOperator;
+    ComputeJacobianVectorProduct m_jacobianVectorProduct;
+    int m_maxKrylovDimension;
+    ODEKrylov *m_krylov;
+
+    //Per tile derivatives of stencil right-hand sides for the tiled RK4 and RKQS stages
+    ComputeTileDerivatives m_tileDerivatives;
+    int m_tileHalo,
+    m_tileSize;
+
     SolverType m_solverType;
     Solve m_solver;
+    bool m_initialized;
+
+    bool m_collectStatistics;
+    ODESolverStatistics m_statistics,
+    m_lastStatistics;
+
+    //Last solveAsync call, which later calls wait for, and the handle of the asynchronous solve running now
+    std::shared_ptr<ODESolveHandle> m_lastAsyncSolve;
+    ODESolveHandle *m_asyncSolve;
+
+    ODEJacobian *m_jacobian;
+    ODEOutputSink *m_outputSink;
+    std::vector<double> m_outputTimes,
+    m_outputState,
+    m_outputPrevious,
+    m_outputPreviousDerivatives;
+    double m_outputStart,
+    m_outputInterval;
+    long long m_outputIndex;
+
+    //Settings of the CVODE solvers, kept in every build so configurations carry over between builds
+    IterationMethod m_solverIterationMethod;
+    LinearSolverType m_linearSolverType;
 
 #ifdef USE_CVODE
     void* m_cvodeSolver;
-    IterationMethod m_solverIterationMethod;
-    LinearSolverType m_linearSolverType;
     SUNLinearSolver m_linearSolver;
     SUNNonlinearSolver m_nonLinearSolver;
     N_Vector m_cvy;
+
+    //CVODE counters reset on CVodeReInit; the Jacobian reuse policy ages over the whole integration
+    long long m_cvodeSteps,
+    m_cvodeNewtonIterations,
+    m_cvodeLinearIterations;
+    long m_cvodeConvergenceFailures;
 #endif
 
 };
@@ -0,0 +1,95 @@
+/*!
+ *  \file    odesolvercheckpoint.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  Memory-mapped batch checkpoints of many ODESolver states.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef ODESOLVERCHECKPOINT_H
+#define ODESOLVERCHECKPOINT_H
+
+#include "odesolver_global.h"
+
+#include <QFile>
+#include <QString>
+#include <vector>
+
+class ODESolver;
+
+/*!
+ * \brief The ODESolverCheckpoint class reads and writes the states of many solvers, for example one per cell,
+ * to a single file. The file holds a header, a table of offsets and the ODESolver::saveState blobs aligned to
+ * eight bytes. Writing and restoring map the file and copy the blobs in parallel.
+ */
+class ODESOLVER_EXPORT ODESolverCheckpoint
+{
+  public:
+
+    ODESolverCheckpoint();
+
+    ~ODESolverCheckpoint();
+
+    /*!
+     * \brief write Writes the states of solvers to a temporary file next to filePath, flushes it to disk and renames
+     * it over filePath in one step, so a preempted write leaves the previous checkpoint intact.
+     * \param filePath
+     * \param solvers
+     * \return
+     */
+    static bool write(const QString &filePath, const std::vector<ODESolver*> &solvers);
+
+    /*!
+     * \brief open Maps a checkpoint file for reading.
+     * \param filePath
+     * \return false if the file cannot be mapped or is not a checkpoint of a supported version.
+     */
+    bool open(const QString &filePath);
+
+    /*!
+     * \brief close
+     */
+    void close();
+
+    /*!
+     * \brief count
+     * \return Number of solver states in the open checkpoint.
+     */
+    int count() const;
+
+    /*!
+     * \brief restore Restores the state at index into solver.
+     * \param index
+     * \param solver
+     * \return Status of ODESolver::restoreState, or 1 if index is out of range.
+     */
+    int restore(int index, ODESolver *solver) const;
+
+    /*!
+     * \brief restore Restores solvers[i] from state i.
+     * \param solvers Must not have more entries than count().
+     * \return 0 on success, otherwise the status of the first state that failed.
+     */
+    int restore(const std::vector<ODESolver*> &solvers) const;
+
+  private:
+
+    QFile m_file;
+    const unsigned char *m_data;
+    long long m_size;
+    int m_count;
+};
+
+#endif // ODESOLVERCHECKPOINT_H
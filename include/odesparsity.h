@@ -0,0 +1,211 @@
+/*!
+ *  \file    odesparsity.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  Sparsity pattern of a right-hand side and a derivative evaluator that recomputes only the
+ *  components whose inputs changed since they were last evaluated.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef ODESPARSITY_H
+#define ODESPARSITY_H
+
+#include "odesolver.h"
+
+#include <vector>
+
+/*!
+ * \brief ComputePartialDerivatives Computes dydt[components[k]], k = 0..count-1, from y and leaves the
+ * other entries of dydt untouched.
+ */
+typedef void (*ComputePartialDerivatives)(double t, double y[], double dydt[], const int components[], int count, void* userData);
+
+/*!
+ * \brief The ODESparsityPattern class declares which components of y each component of dydt depends on,
+ * in compressed sparse row form: row i lists the columns j with d(dydt_i)/d(y_j) possibly nonzero.
+ */
+class ODESOLVER_EXPORT ODESparsityPattern
+{
+  public:
+
+    ODESparsityPattern();
+
+    /*!
+     * \brief ODESparsityPattern
+     * \param size Number of equations.
+     * \param rowOffsets size + 1 offsets into columns.
+     * \param columns Column indices of each row.
+     */
+    ODESparsityPattern(int size, const std::vector<int> &rowOffsets, const std::vector<int> &columns);
+
+    /*!
+     * \brief banded Pattern of a band matrix.
+     * \param size
+     * \param lower Number of sub-diagonals.
+     * \param upper Number of super-diagonals.
+     * \return
+     */
+    static ODESparsityPattern banded(int size, int lower, int upper);
+
+    int size() const;
+
+    /*!
+     * \brief nonZeros
+     * \return Number of entries.
+     */
+    int nonZeros() const;
+
+    const std::vector<int> &rowOffsets() const;
+
+    const std::vector<int> &columns() const;
+
+    /*!
+     * \brief transpose
+     * \return Pattern whose row j lists the components of dydt that depend on y_j.
+     */
+    ODESparsityPattern transpose() const;
+
+  private:
+
+    int m_size;
+    std::vector<int> m_rowOffsets,
+    m_columns;
+};
+
+/*!
+ * \brief The ODESparseDerivatives class evaluates the right-hand side through a partial derivative callback.
+ * It keeps the last derivatives and the inputs they were computed from, and on each evaluation recomputes
+ * only the components that depend on an input which moved by more than absoluteThreshold +
+ * relativeThreshold * |y| since it last took part in an evaluation. With the default zero thresholds only
+ * bitwise unchanged inputs are skipped, which is exact for autonomous right-hand sides.
+ * Pass ODESparseDerivatives::computeDerivatives to any solver with this object as userData.
+ */
+class ODESOLVER_EXPORT ODESparseDerivatives
+{
+  public:
+
+    /*!
+     * \brief ODESparseDerivatives
+     * \param pattern Sparsity pattern of the right-hand side.
+     * \param derivs Full evaluation, used for the first call and when most components are affected.
+     * \param partialDerivs Evaluation of selected components.
+     * \param userData Passed to derivs and partialDerivs.
+     */
+    ODESparseDerivatives(const ODESparsityPattern &pattern, ComputeDerivatives derivs, ComputePartialDerivatives partialDerivs, void* userData);
+
+    const ODESparsityPattern &pattern() const;
+
+    double relativeThreshold() const;
+
+    void setRelativeThreshold(double threshold);
+
+    double absoluteThreshold() const;
+
+    void setAbsoluteThreshold(double threshold);
+
+    /*!
+     * \brief maxFraction Fraction of affected components above which a full evaluation is used instead.
+     * \return
+     */
+    double maxFraction() const;
+
+    void setMaxFraction(double fraction);
+
+    /*!
+     * \brief reset Discards the cached derivatives, for example after the parameters of the model changed.
+     */
+    void reset();
+
+    /*!
+     * \brief evaluate Computes dydt at (t, y), recomputing only the affected components.
+     * \param t
+     * \param y
+     * \param dydt
+     */
+    void evaluate(double t, double y[], double dydt[]);
+
+    /*!
+     * \brief affectedComponents Components of dydt that depend on any of the changed components of y.
+     * \param changed
+     * \param count
+     * \param affected Replaced with the affected components in increasing order of first discovery.
+     */
+    void affectedComponents(const int changed[], int count, std::vector<int> &affected);
+
+    /*!
+     * \brief evaluateComponents Calls the partial derivative callback directly without touching the cache.
+     * \param t
+     * \param y
+     * \param dydt
+     * \param components
+     * \param count
+     */
+    void evaluateComponents(double t, double y[], double dydt[], const int components[], int count);
+
+    long long fullEvaluations() const;
+
+    long long partialEvaluations() const;
+
+    /*!
+     * \brief evaluatedComponents
+     * \return Number of components computed over all evaluations, full and partial.
+     */
+    long long evaluatedComponents() const;
+
+    void resetCounters();
+
+    /*!
+     * \brief computeDerivatives ComputeDerivatives trampoline. userData is the ODESparseDerivatives.
+     * \param t
+     * \param y
+     * \param dydt
+     * \param userData
+     */
+    static void computeDerivatives(double t, double y[], double dydt[], void* userData);
+
+  private:
+
+    void evaluateFull(double t, double y[], double dydt[]);
+
+  private:
+
+    ODESparsityPattern m_pattern,
+    m_transpose;
+
+    ComputeDerivatives m_derivs;
+    ComputePartialDerivatives m_partialDerivs;
+    void *m_userData;
+
+    double m_relativeThreshold,
+    m_absoluteThreshold,
+    m_maxFraction;
+
+    bool m_cached;
+
+    std::vector<double> m_yReference,
+    m_dydtCache;
+
+    std::vector<int> m_changed,
+    m_affected,
+    m_marks;
+
+    int m_mark;
+
+    long long m_fullEvaluations,
+    m_partialEvaluations,
+    m_evaluatedComponents;
+};
+
+#endif // ODESPARSITY_H
@@ -0,0 +1,76 @@
+/*!
+*  \file    fixedodesolvertest.h
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+
+#ifndef FIXEDODESOLVERTEST_H
+#define FIXEDODESOLVERTEST_H
+
+#include <QtTest/QtTest>
+
+class FixedODESolverTest : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+
+    /*!
+     * \brief solveFixedRK4_Prob1 Solve ODE problem 1 using the fixed size RK4
+     */
+    void solveFixedRK4_Prob1();
+
+    /*!
+     * \brief solveFixedRKQS_Prob1 Solve ODE problem 1 using the fixed size RK45
+     */
+    void solveFixedRKQS_Prob1();
+
+    /*!
+     * \brief solveFixedRKQS_Prob2 Solve ODE problem 2 using the fixed size RK45 and the raw array overload
+     */
+    void solveFixedRKQS_Prob2();
+
+    /*!
+     * \brief compareFixedDynamic Fixed size and dynamic solvers must agree on a system of 8 equations
+     */
+    void compareFixedDynamic();
+
+    /*!
+     * \brief benchmarkFixedDynamic_data Sizes 1, 4, 8 and 16 for the fixed size and dynamic RK4 and RKQS
+     */
+    void benchmarkFixedDynamic_data();
+
+    /*!
+     * \brief benchmarkFixedDynamic Integrates problem 1 replicated size times
+     */
+    void benchmarkFixedDynamic();
+
+  public:
+
+    /*!
+     * \brief derivativeProb1 Problem 1 of ODESolverTest applied to each of the *(int*)userData components.
+     * \param t
+     * \param y
+     * \param dydt
+     * \param userData
+     */
+    static void derivativeProb1(double t, double y[], double dydt[], void* userData);
+
+};
+
+
+#endif // FIXEDODESOLVERTEST_H
@@ -0,0 +1,88 @@
+/*!
+*  \file    lockstepodesolvertest.h
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+
+#ifndef LOCKSTEPODESOLVERTEST_H
+#define LOCKSTEPODESOLVERTEST_H
+
+#include <QtTest/QtTest>
+
+class LockstepODESolverTest : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+
+    /*!
+     * \brief solveLockstepRK4 RK4 over 4 lanes must match ODESolver on 13 systems with different decay rates
+     */
+    void solveLockstepRK4();
+
+    /*!
+     * \brief solveLockstepRKQS RKQS over 8 lanes must match ODESolver on 13 systems with different decay rates
+     */
+    void solveLockstepRKQS();
+
+    /*!
+     * \brief solveLockstepBatchState RKQS on an ODEBatchState must match the array form exactly
+     */
+    void solveLockstepBatchState();
+
+    /*!
+     * \brief benchmarkLockstepRKQS Lockstep RKQS over 8 lanes on 4096 systems
+     */
+    void benchmarkLockstepRKQS();
+
+    /*!
+     * \brief benchmarkLockstepBatchStateRKQS Lockstep RKQS over 8 lanes on 4096 systems held in an ODEBatchState
+     */
+    void benchmarkLockstepBatchStateRKQS();
+
+    /*!
+     * \brief benchmarkScalarRKQS ODESolver RKQS on the same 4096 systems
+     */
+    void benchmarkScalarRKQS();
+
+  public:
+
+    /*!
+     * \brief derivativeDecay dy/dt = -k (y - cos(t)) with k = *(double*)userData
+     * \param t
+     * \param y
+     * \param dydt
+     * \param userData
+     */
+    static void derivativeDecay(double t, double y[], double dydt[], void* userData);
+
+    /*!
+     * \brief derivativeDecayLockstep Lockstep form of derivativeDecay. userData is a std::vector<double> of the rates.
+     * \param t
+     * \param y
+     * \param dydt
+     * \param n
+     * \param firstSystem
+     * \param lanes
+     * \param userData
+     */
+    static void derivativeDecayLockstep(const double t[], double y[], double dydt[], int n, int firstSystem, int lanes, void* userData);
+
+};
+
+
+#endif // LOCKSTEPODESOLVERTEST_H
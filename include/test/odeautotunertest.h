@@ -0,0 +1,56 @@
+/*!
+*  \file    odeautotunertest.h
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#ifndef ODEAUTOTUNERTEST_H
+#define ODEAUTOTUNERTEST_H
+
+#include <QtTest/QtTest>
+
+class ODEAutotunerTest : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+
+    /*!
+     * \brief tuneExplicit The fastest candidate meeting the tolerance is chosen and explicit Euler, which cannot meet it
+     * in the window, is not
+     */
+    void tuneExplicit();
+
+    /*!
+     * \brief tuneCache A second tuner with the same problem signature reads the choice back from the cache file
+     */
+    void tuneCache();
+
+  public:
+
+    /*!
+     * \brief derivativeForcedOscillators Weakly coupled forced oscillators, n even. userData points to n.
+     * \param t
+     * \param y
+     * \param dydt
+     * \param userData
+     */
+    static void derivativeForcedOscillators(double t, double y[], double dydt[], void* userData);
+
+};
+
+
+#endif // ODEAUTOTUNERTEST_H
@@ -0,0 +1,68 @@
+/*!
+*  \file    odeensembletest.h
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#ifndef ODEENSEMBLETEST_H
+#define ODEENSEMBLETEST_H
+
+#include <QtTest/QtTest>
+
+class ODEEnsembleTest : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+
+    /*!
+     * \brief ensembleRKQS Every member must match the same member integrated alone
+     */
+    void ensembleRKQS();
+
+    /*!
+     * \brief ensembleLockstepRK4 Lockstep blocks with a partial last block must match the scalar ensemble
+     */
+    void ensembleLockstepRK4();
+
+  public:
+
+    /*!
+     * \brief derivativeOscillator Damped oscillator y0' = y1, y1' = -k y0 - c y1 with parameters (k, c). userData is unused.
+     * \param t
+     * \param y
+     * \param dydt
+     * \param parameters
+     * \param userData
+     */
+    static void derivativeOscillator(double t, double y[], double dydt[], const double parameters[], void* userData);
+
+    /*!
+     * \brief derivativeOscillatorLockstep Lane form of derivativeOscillator
+     * \param t
+     * \param y
+     * \param dydt
+     * \param n
+     * \param parameters
+     * \param lanes
+     * \param userData
+     */
+    static void derivativeOscillatorLockstep(const double t[], double y[], double dydt[], int n, const double parameters[], int lanes, void* userData);
+
+};
+
+
+#endif // ODEENSEMBLETEST_H
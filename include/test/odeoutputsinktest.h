@@ -0,0 +1,61 @@
+/*!
+*  \file    odeoutputsinktest.h
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+
+#ifndef ODEOUTPUTSINKTEST_H
+#define ODEOUTPUTSINKTEST_H
+
+#include <QtTest/QtTest>
+
+class ODEOutputSinkTest : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+
+    /*!
+     * \brief trajectoryRKQS RKQS dense output at a fixed interval streamed to a trajectory file
+     */
+    void trajectoryRKQS();
+
+    /*!
+     * \brief trajectoryComponentsRK4 RK4 output with component selection and downsampling
+     */
+    void trajectoryComponentsRK4();
+
+    /*!
+     * \brief outputTimesEuler Explicit output times, including times before the start and at step ends
+     */
+    void outputTimesEuler();
+
+  public:
+
+    /*!
+     * \brief derivativeDecay dy_i/dt = -(i + 1) y_i, y_i(0) = 1. userData points to the number of equations.
+     * \param t
+     * \param y
+     * \param dydt
+     * \param userData
+     */
+    static void derivativeDecay(double t, double y[], double dydt[], void* userData);
+
+};
+
+
+#endif // ODEOUTPUTSINKTEST_H
@@ -0,0 +1,61 @@
+/*!
+*  \file    odepararealtest.h
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#ifndef ODEPARAREALTEST_H
+#define ODEPARAREALTEST_H
+
+#include <QtTest/QtTest>
+
+class ODEPararealTest : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+
+    /*!
+     * \brief cloneSolver A clone must integrate exactly as the solver it was cloned from
+     */
+    void cloneSolver();
+
+    /*!
+     * \brief convergedPararealRK4 Coarse RK4 slices corrected by fine RK4 must converge to the serial fine solution
+     * in a few iterations
+     */
+    void convergedPararealRK4();
+
+    /*!
+     * \brief exactPararealRKQS With a zero tolerance all iterations run and the serial RKQS solution is reproduced exactly
+     */
+    void exactPararealRKQS();
+
+  public:
+
+    /*!
+     * \brief derivativeForcedDecay dy_i/dt = -(i + 1) y_i + sin(t) y_{i+1 mod n}. userData points to n.
+     * \param t
+     * \param y
+     * \param dydt
+     * \param userData
+     */
+    static void derivativeForcedDecay(double t, double y[], double dydt[], void* userData);
+
+};
+
+
+#endif // ODEPARAREALTEST_H
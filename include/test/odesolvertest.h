@@ -44,6 +44,11 @@ class ODESolverTest : public QObject
      */
     void solveODERKQS_Prob1();
 
+    /*!
+     * \brief solveODELSRK4_Prob1 Solve ODE problem 1 using the low-storage RK4
+     */
+    void solveODELSRK4_Prob1();
+
 #ifdef USE_CVODE
 
     /*!
@@ -73,6 +78,77 @@ class ODESolverTest : public QObject
      */
     void solveODERKQS_Prob2();
 
+    /*!
+     * \brief solveODELSRK45_Prob2 Solve ODE problem 2 using the adaptive low-storage RK4(3)
+     */
+    void solveODELSRK45_Prob2();
+
+    /*!
+     * \brief solveODENativeAdams_Prob2 Solve ODE problem 2 using the built-in variable order Adams PECE
+     */
+    void solveODENativeAdams_Prob2();
+
+    /*!
+     * \brief nativeAdamsHistory The Adams history carries over solve calls and saved states and restarts when y changes
+     */
+    void nativeAdamsHistory();
+
+    /*!
+     * \brief solveODEGBS_Prob1 Solve ODE problem 1 at a tight tolerance using Gragg-Bulirsch-Stoer extrapolation
+     */
+    void solveODEGBS_Prob1();
+
+    /*!
+     * \brief gbsParallelExtrapolation The parallel midpoint sequences give the sequential solution
+     */
+    void gbsParallelExtrapolation();
+
+    /*!
+     * \brief gbsSettingsAfterInitialize Order and parallel extrapolation changed after initialize wait for the next initialize
+     */
+    void gbsSettingsAfterInitialize();
+
+    /*!
+     * \brief solveODERKC_Diffusion Solve the semi-discrete heat equation with Runge-Kutta-Chebyshev
+     */
+    void solveODERKC_Diffusion();
+
+    /*!
+     * \brief solveODEExponential_ReactionDiffusion Solve the semi-discrete Fisher-KPP equation with the Krylov
+     * exponential integrators
+     */
+    void solveODEExponential_ReactionDiffusion();
+
+    /*!
+     * \brief exponentialJacobianVectorProduct EXPRB32 with an analytic Jacobian-vector product in place of differences
+     */
+    void exponentialJacobianVectorProduct();
+
+    /*!
+     * \brief tiledStages RK4 and RKQS stages computed tile by tile give the whole-array solution
+     */
+    void tiledStages();
+
+    /*!
+     * \brief kernelLevels RK4 and RKQS agree across the instruction set levels of the stage kernels
+     */
+    void kernelLevels();
+
+    /*!
+     * \brief solveAsync Chained asynchronous solves give the synchronous result
+     */
+    void solveAsync();
+
+    /*!
+     * \brief solveAsyncCancel A cancelled asynchronous solve stops at an accepted step from which a later solve continues
+     */
+    void solveAsyncCancel();
+
+    /*!
+     * \brief solveAsyncChain Solves queued behind a held solve leave the pool workers free for other solvers
+     */
+    void solveAsyncChain();
+
 #ifdef USE_CVODE
 
     /*!
@@ -87,6 +163,31 @@ class ODESolverTest : public QObject
 
 #endif
 
+    /*!
+     * \brief solveODERK4_Statistics Statistics of RK4 on problem 1
+     */
+    void solveODERK4_Statistics();
+
+    /*!
+     * \brief solveODERKQS_Statistics Statistics of RK45 on problem 2, cumulative and per call
+     */
+    void solveODERKQS_Statistics();
+
+    /*!
+     * \brief solveODERKQS_Controllers PI and PID step size controllers of RK45 on problem 2
+     */
+    void solveODERKQS_Controllers();
+
+    /*!
+     * \brief saveRestoreState_RKQS Restarting RKQS from a saved state continues problem 2 bitwise
+     */
+    void saveRestoreState_RKQS();
+
+    /*!
+     * \brief checkpointBatch Writes and restores a memory-mapped checkpoint of many solvers
+     */
+    void checkpointBatch();
+
     /*!
      * \brief derivativeProb1 Example ODE problem: dy/dt = x * y ^3 / sqrt(1 + x^2); y(0) = -1; y = -1 / sqrt(3 - 2 * sqrt(1+t^2))
      * \param t
@@ -0,0 +1,92 @@
+/*!
+*  \file    odesparsitytest.h
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+
+#ifndef ODESPARSITYTEST_H
+#define ODESPARSITYTEST_H
+
+#include <QtTest/QtTest>
+
+class ODESparsityTest : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+
+    /*!
+     * \brief transposePattern Transpose of a non-symmetric pattern
+     */
+    void transposePattern();
+
+    /*!
+     * \brief affectedComponents Components depending on changed inputs of a tridiagonal pattern
+     */
+    void affectedComponents();
+
+    /*!
+     * \brief sparseDerivativesRK4 RK4 on a localised pulse with partial updates must match full evaluation
+     */
+    void sparseDerivativesRK4();
+
+    /*!
+     * \brief colourTridiagonal A tridiagonal pattern needs three colours whatever its size
+     */
+    void colourTridiagonal();
+
+    /*!
+     * \brief finiteDifferenceJacobian Coloured finite differences, full and partial, against the exact Jacobian of the pulse
+     */
+    void finiteDifferenceJacobian();
+
+    /*!
+     * \brief incompleteFactorization ILU(0) of tridiagonal I - gamma J has no fill so it solves exactly
+     */
+    void incompleteFactorization();
+
+    /*!
+     * \brief jacobianReuse Age, gamma and convergence triggers of the Jacobian reuse policy
+     */
+    void jacobianReuse();
+
+  public:
+
+    /*!
+     * \brief derivativePulse dy_i/dt = y_{i-1} - 2 y_i + y_{i+1} - 0.1 y_i with zero boundaries. userData points to n.
+     * \param t
+     * \param y
+     * \param dydt
+     * \param userData
+     */
+    static void derivativePulse(double t, double y[], double dydt[], void* userData);
+
+    /*!
+     * \brief partialDerivativePulse derivativePulse for the listed components only
+     * \param t
+     * \param y
+     * \param dydt
+     * \param components
+     * \param count
+     * \param userData
+     */
+    static void partialDerivativePulse(double t, double y[], double dydt[], const int components[], int count, void* userData);
+
+};
+
+
+#endif // ODESPARSITYTEST_H
@@ -0,0 +1,77 @@
+/*!
+*  \file    typedodesolvertest.h
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+
+#ifndef TYPEDODESOLVERTEST_H
+#define TYPEDODESOLVERTEST_H
+
+#include <QtTest/QtTest>
+
+class TypedODESolverTest : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+
+    /*!
+     * \brief solveDoubleRKQS TypedODESolver<double> RKQS must match ODESolver RKQS
+     */
+    void solveDoubleRKQS();
+
+    /*!
+     * \brief solveMixedRK4 Float storage with double accumulation against a double reference
+     */
+    void solveMixedRK4();
+
+    /*!
+     * \brief solveFloatRKQS Single precision RKQS against a double reference
+     */
+    void solveFloatRKQS();
+
+    /*!
+     * \brief benchmarkDoubleRK4 RK4 on 2^20 decaying equations in double
+     */
+    void benchmarkDoubleRK4();
+
+    /*!
+     * \brief benchmarkMixedRK4 RK4 on 2^20 decaying equations with float storage and double accumulation
+     */
+    void benchmarkMixedRK4();
+
+    /*!
+     * \brief benchmarkFloatRK4 RK4 on 2^20 decaying equations in float
+     */
+    void benchmarkFloatRK4();
+
+  public:
+
+    /*!
+     * \brief derivativeDecay dy_i/dt = -(1 + i % 7) (y_i - cos(t)). userData points to the number of equations.
+     * \param t
+     * \param y
+     * \param dydt
+     * \param userData
+     */
+    template<typename Real>
+    static void derivativeDecay(double t, Real y[], Real dydt[], void* userData);
+
+};
+
+
+#endif // TYPEDODESOLVERTEST_H
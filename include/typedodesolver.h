@@ -0,0 +1,448 @@
+/*!
+ *  \file    typedodesolver.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  RK4 and RKQS solvers generic over the storage and accumulation scalar types.
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef TYPEDODESOLVER_H
+#define TYPEDODESOLVER_H
+
+#include "odesolver.h"
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+#include <math.h>
+#include <algorithm>
+#include <limits>
+
+/*!
+ * \brief The TypedODESolver class is the classic RK4 and the Cash-Karp RKQS of ODESolver with the state, stages
+ * and scratch arrays stored as Real and every combination of them, including the error norm, computed in
+ * Accumulator. TypedODESolver<float> runs entirely in single precision and TypedODESolver<float, double>
+ * (MixedODESolver) halves the memory traffic of the stage passes while rounding each result to float only once.
+ * RKQS has only a relative tolerance, against which it scales the error by |y| + |dt * dydt| as ODESolver does,
+ * and always uses the elementary step size controller, so TypedODESolver<double> matches ODESolver only with
+ * the default ELEMENTARY controller. There is no absolute tolerance, output, tiling or ODEKernels dispatch.
+ */
+template<typename Real, typename Accumulator = Real>
+class TypedODESolver
+{
+  public:
+
+    /*!
+     * Derivatives of the Real state. The time is always double.
+     */
+    typedef void (*Derivatives)(double t, Real y[], Real dydt[], void* userData);
+
+    /*!
+     * \brief The SolverType enum
+     */
+    enum SolverType
+    {
+      RK4,
+      RKQS
+    };
+
+    /*!
+     * \brief TypedODESolver
+     * \param size
+     * \param solverType
+     */
+    TypedODESolver(int size, SolverType solverType)
+      : m_size(size),
+        m_maxSteps(50000),
+        m_currentIterations(0),
+        m_safety(0.9),
+        m_pgrow(-0.2),
+        m_pshrnk(-0.25),
+        m_errcon(1.89e-4),
+        m_relTol(1e-6),
+        m_work(nullptr),
+        m_solverType(solverType)
+    {
+    }
+
+    ~TypedODESolver()
+    {
+      delete[] m_work;
+    }
+
+    /*!
+     * \brief initialize Allocates the scratch arrays, first touched with the schedule of the stage loops.
+     */
+    void initialize()
+    {
+      delete[] m_work;
+
+      //RK4 uses 4 arrays, RKQS dydt, yscal, yerr, ytemp and five stages
+      int arrays = m_solverType == RKQS ? 9 : 4;
+      m_work = new Real[arrays * static_cast<size_t>(m_size)];
+
+      for(int a = 0; a < arrays; a++)
+      {
+        Real *array = m_work + a * static_cast<size_t>(m_size);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+        for(int i = 0; i < m_size; i++)
+          array[i] = Real(0);
+      }
+    }
+
+    int size() const
+    {
+      return m_size;
+    }
+
+    SolverType solverType() const
+    {
+      return m_solverType;
+    }
+
+    int maxIterations() const
+    {
+      return m_maxSteps;
+    }
+
+    void setMaxIterations(int iterations)
+    {
+      if(iterations > 0)
+        m_maxSteps = iterations;
+    }
+
+    int getIterations() const
+    {
+      return m_currentIterations;
+    }
+
+    double relativeTolerance() const
+    {
+      return m_relTol;
+    }
+
+    void setRelativeTolerance(double tolerance)
+    {
+      m_relTol = tolerance;
+    }
+
+    /*!
+     * \brief statistics Solve calls, steps and derivative evaluations since the last resetStatistics.
+     * Times are not collected.
+     * \return
+     */
+    const ODESolverStatistics &statistics() const
+    {
+      return m_statistics;
+    }
+
+    void resetStatistics()
+    {
+      m_statistics.reset();
+    }
+
+    /*!
+     * \brief solve Advances y from t to t + dt. yout may be y.
+     * \param y
+     * \param n
+     * \param t
+     * \param dt
+     * \param yout
+     * \param derivs
+     * \param userData
+     * \return 0 on success, 2 if the step size underflowed and 3 if maxIterations was exceeded.
+     */
+    int solve(Real y[], int n, double t, double dt, Real yout[], Derivatives derivs, void* userData)
+    {
+      m_statistics.solveCalls++;
+
+      switch (m_solverType)
+      {
+        case RKQS:
+          return rkqsDriver(y, n, t, dt, yout, derivs, userData);
+        default:
+          return rk4(y, n, t, dt, yout, derivs, userData);
+      }
+    }
+
+  private:
+
+    int rk4(Real y[], int n, double t, double dt, Real yout[], Derivatives derivs, void* userData)
+    {
+      Real *dydt = m_work, *dyt = m_work + n, *dym = m_work + 2 * n, *yt = m_work + 3 * n;
+      const Accumulator h = dt, hh = 0.5 * dt, h6 = dt / 6.0;
+
+      derivs(t, y, dydt, userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < n; i++)
+        yt[i] = static_cast<Real>(Accumulator(y[i]) + hh * Accumulator(dydt[i]));
+
+      derivs(t + 0.5 * dt, yt, dyt, userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < n; i++)
+        yt[i] = static_cast<Real>(Accumulator(y[i]) + hh * Accumulator(dyt[i]));
+
+      derivs(t + 0.5 * dt, yt, dym, userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < n; i++)
+      {
+        yt[i] = static_cast<Real>(Accumulator(y[i]) + h * Accumulator(dym[i]));
+        dym[i] = static_cast<Real>(Accumulator(dym[i]) + Accumulator(dyt[i]));
+      }
+
+      derivs(t + dt, yt, dyt, userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < n; i++)
+        yout[i] = static_cast<Real>(Accumulator(y[i]) + h6 * (Accumulator(dydt[i]) + Accumulator(dyt[i]) + Accumulator(2) * Accumulator(dym[i])));
+
+      m_currentIterations = 1;
+      m_statistics.derivativeEvaluations += 4;
+      recordStep(dt, true);
+
+      return 0;
+    }
+
+    int rkqsDriver(Real y[], int n, double t, double dt, Real yout[], Derivatives derivs, void* userData)
+    {
+      Real *dydt = m_work, *yscal = m_work + n;
+      double tDid, tNext;
+      double t_est = t;
+      double dt_est = dt;
+      double t_end = t + dt;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < n; i++)
+        yout[i] = y[i];
+
+      for(int nstp = 1; nstp <= m_maxSteps; nstp++)
+      {
+        m_currentIterations = nstp;
+
+        derivs(t_est, yout, dydt, userData);
+        m_statistics.derivativeEvaluations++;
+
+        const Accumulator h = dt_est;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+        for(int i = 0; i < n; i++)
+          yscal[i] = static_cast<Real>(fabs(Accumulator(yout[i])) + fabs(Accumulator(dydt[i]) * h) + Accumulator(1.0e-30));
+
+        if(((t_est + dt_est) - t_end) * (t_est + dt_est - t) > 0.0)
+          dt_est = t + dt - t_est;
+
+        if(rkqs(&t_est, dydt, yout, n, dt_est, &tDid, &tNext, derivs, userData))
+          break;
+
+        if((t_est - t_end) * (t_end - t) >= 0.0)
+          return 0;
+
+        if(fabs(tNext) <= 0.0)
+          return 2;
+
+        dt_est = tNext;
+      }
+
+      return 3;
+    }
+
+    int rkqs(double *t, Real dydt[], Real yout[], int n, double dtTry, double *dtDid, double *dtNext, Derivatives derivs, void* userData)
+    {
+      Real *yscal = m_work + n, *yerr = m_work + 2 * n, *ytemp = m_work + 3 * n;
+      double dt = dtTry, dtTemp, told = *t;
+
+      for(;;)
+      {
+        rkck(told, dydt, yout, n, dt, derivs, userData);
+
+        Accumulator errmax = 0.0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(max:errmax)
+#endif
+        for(int i = 0; i < n; i++)
+        {
+          Accumulator err = fabs(Accumulator(yerr[i]) / Accumulator(yscal[i]));
+
+          //Stages that overflow in single precision give NaN; reject the step instead of ignoring them
+          errmax = std::max(errmax, err == err ? err : std::numeric_limits<Accumulator>::infinity());
+        }
+
+        double scaledError = errmax / m_relTol;
+
+        if(scaledError > 1.0)
+        {
+          recordStep(dt, false);
+
+          dtTemp = m_safety * dt * pow(scaledError, m_pshrnk);
+          dt = dt >= 0.0 ? std::max(dtTemp, 0.1 * dt) : std::min(dtTemp, 0.1 * dt);
+
+          if(told + dt == told)
+            return 2;
+
+          continue;
+        }
+
+        *dtNext = scaledError > m_errcon ? m_safety * dt * pow(scaledError, m_pgrow) : 5.0 * dt;
+        *t += (*dtDid = dt);
+        recordStep(dt, true);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+        for(int i = 0; i < n; i++)
+          yout[i] = ytemp[i];
+
+        return 0;
+      }
+    }
+
+    void rkck(double t, Real dydt[], Real yout[], int n, double dt, Derivatives derivs, void* userData)
+    {
+      const Accumulator a2 = 0.2, a3 = 0.3, a4 = 0.6, a5 = 1.0, a6 = 0.875,
+          b21 = 0.2, b31 = 3.0 / 40.0, b32 = 9.0 / 40.0, b41 = 0.3, b42 = -0.9, b43 = 1.2,
+          b51 = -11.0 / 54.0, b52 = 2.5, b53 = -70.0 / 27.0, b54 = 35.0 / 27.0,
+          b61 = 1631.0 / 55296.0, b62 = 175.0 / 512.0, b63 = 575.0 / 13824.0,
+          b64 = 44275.0 / 110592.0, b65 = 253.0 / 4096.0, c1 = 37.0 / 378.0,
+          c3 = 250.0 / 621.0, c4 = 125.0 / 594.0, c6 = 512.0 / 1771.0,
+          dc5 = -277.0 / 14336.0;
+      const Accumulator dc1 = c1 - Accumulator(2825.0 / 27648.0), dc3 = c3 - Accumulator(18575.0 / 48384.0),
+          dc4 = c4 - Accumulator(13525.0 / 55296.0), dc6 = c6 - Accumulator(0.25);
+      const Accumulator h = dt;
+
+      Real *yerr = m_work + 2 * n, *ytemp = m_work + 3 * n;
+      Real *ak2 = m_work + 4 * n, *ak3 = m_work + 5 * n, *ak4 = m_work + 6 * n, *ak5 = m_work + 7 * n, *ak6 = m_work + 8 * n;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < n; i++)
+        ytemp[i] = static_cast<Real>(Accumulator(yout[i]) + b21 * h * Accumulator(dydt[i]));
+
+      derivs(t + a2 * dt, ytemp, ak2, userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < n; i++)
+        ytemp[i] = static_cast<Real>(Accumulator(yout[i]) + h * (b31 * Accumulator(dydt[i]) + b32 * Accumulator(ak2[i])));
+
+      derivs(t + a3 * dt, ytemp, ak3, userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < n; i++)
+        ytemp[i] = static_cast<Real>(Accumulator(yout[i]) + h * (b41 * Accumulator(dydt[i]) + b42 * Accumulator(ak2[i]) + b43 * Accumulator(ak3[i])));
+
+      derivs(t + a4 * dt, ytemp, ak4, userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < n; i++)
+        ytemp[i] = static_cast<Real>(Accumulator(yout[i]) + h * (b51 * Accumulator(dydt[i]) + b52 * Accumulator(ak2[i]) +
+                                                                b53 * Accumulator(ak3[i]) + b54 * Accumulator(ak4[i])));
+
+      derivs(t + a5 * dt, ytemp, ak5, userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < n; i++)
+        ytemp[i] = static_cast<Real>(Accumulator(yout[i]) + h * (b61 * Accumulator(dydt[i]) + b62 * Accumulator(ak2[i]) +
+                                                                b63 * Accumulator(ak3[i]) + b64 * Accumulator(ak4[i]) +
+                                                                b65 * Accumulator(ak5[i])));
+
+      derivs(t + a6 * dt, ytemp, ak6, userData);
+
+      //Solution and error estimate in one pass over the stages
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < n; i++)
+      {
+        Accumulator k1 = dydt[i], k3 = ak3[i], k4 = ak4[i], k5 = ak5[i], k6 = ak6[i];
+        ytemp[i] = static_cast<Real>(Accumulator(yout[i]) + h * (c1 * k1 + c3 * k3 + c4 * k4 + c6 * k6));
+        yerr[i] = static_cast<Real>(h * (dc1 * k1 + dc3 * k3 + dc4 * k4 + dc5 * k5 + dc6 * k6));
+      }
+
+      m_statistics.derivativeEvaluations += 5;
+    }
+
+    void recordStep(double dt, bool accepted)
+    {
+      if(accepted)
+      {
+        dt = fabs(dt);
+        m_statistics.minStep = m_statistics.acceptedSteps ? std::min(m_statistics.minStep, dt) : dt;
+        m_statistics.maxStep = m_statistics.acceptedSteps ? std::max(m_statistics.maxStep, dt) : dt;
+        m_statistics.acceptedSteps++;
+      }
+      else
+      {
+        m_statistics.rejectedSteps++;
+      }
+    }
+
+  private:
+
+    int m_size,
+    m_maxSteps,
+    m_currentIterations;
+
+    double m_safety,
+    m_pgrow,
+    m_pshrnk,
+    m_errcon,
+    m_relTol;
+
+    Real *m_work;
+
+    SolverType m_solverType;
+
+    ODESolverStatistics m_statistics;
+};
+
+/*!
+ * Single precision storage with double precision accumulation.
+ */
+typedef TypedODESolver<float, double> MixedODESolver;
+
+/*!
+ * Single precision storage and arithmetic.
+ */
+typedef TypedODESolver<float, float> FloatODESolver;
+
+#endif // TYPEDODESOLVER_H
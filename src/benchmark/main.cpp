@@ -0,0 +1,184 @@
+#include "stdafx.h"
+#include "benchmark/odebenchmark.h"
+#include "benchmark/odebenchmarkproblems.h"
+#include "benchmark/odebenchmarkregression.h"
+
+#include <stdio.h>
+
+static void printUsage()
+{
+  printf("Usage: ODESolverBenchmark [options]\n"
+         "  --problems a,b,...     robertson, brusselator1d, brusselator2d, lorenz96, vanderpol, batchedcells\n"
+         "  --solvers a,b,...      EULER, RK4, RKQS, LSRK4, LSRK45, ADAMS, GBS, RKC, EXPRB32, CVODE_ADAMS, CVODE_BDF\n"
+         "  --precisions a,b,...   double, float, mixed; float and mixed apply to RK4 and RKQS (default double)\n"
+         "  --threads 1,2,...      OpenMP thread counts\n"
+         "  --parareal n           also run each solver as the fine propagator of n Parareal slices and report the speedup\n"
+         "  --max-size n           largest number of equations for the scalable problems (default 1e4)\n"
+         "  --repeats n            timed repetitions of each case (default 3)\n"
+         "  --max-solve-calls n    cap on solve calls per case (default 2000)\n"
+         "  --max-iterations n     ODESolver::setMaxIterations (default 10000)\n"
+         "  --output file.json     write the results as JSON\n"
+         "  --quiet                do not print the results table\n"
+         "  --baseline file.json   compare with a stored run and exit with 2 on regressions\n"
+         "  --threshold x          tolerated relative slowdown in time per step (default 0.1)\n"
+         "  --rhs-threshold x      tolerated relative increase in derivative evaluations (default 0)\n"
+         "  --confidence x         confidence level of the time ratio interval (default 0.95)\n");
+}
+
+int main(int argc, char** argv)
+{
+  ODEBenchmark benchmark;
+  ODEBenchmarkRegression regression;
+  QString output, baseline;
+
+  for(int i = 1; i < argc; i++)
+  {
+    QString option(argv[i]);
+    QString value = i + 1 < argc ? QString(argv[i + 1]) : QString();
+
+    if(option == "--problems")
+    {
+      std::vector<QString> problems;
+
+      for(const QString &name : value.split(","))
+        problems.push_back(name.toLower());
+
+      benchmark.setProblems(problems);
+      i++;
+    }
+    else if(option == "--solvers")
+    {
+      std::vector<ODESolver::SolverType> solverTypes;
+
+      for(const QString &name : value.split(","))
+      {
+        ODESolver::SolverType solverType;
+
+        if(!ODEBenchmark::solverTypeFromName(name, solverType))
+        {
+          fprintf(stderr, "Solver not available in this build: %s\n", name.toStdString().c_str());
+          return 1;
+        }
+
+        solverTypes.push_back(solverType);
+      }
+
+      benchmark.setSolverTypes(solverTypes);
+      i++;
+    }
+    else if(option == "--precisions")
+    {
+      std::vector<QString> precisions;
+
+      for(const QString &name : value.split(","))
+      {
+        QString precision = name.toLower();
+
+        if(precision != "double" && precision != "float" && precision != "mixed")
+        {
+          fprintf(stderr, "Unknown precision: %s\n", name.toStdString().c_str());
+          return 1;
+        }
+
+        precisions.push_back(precision);
+      }
+
+      benchmark.setPrecisions(precisions);
+      i++;
+    }
+    else if(option == "--threads")
+    {
+      std::vector<int> threads;
+
+      for(const QString &count : value.split(","))
+        threads.push_back(std::max(1, count.toInt()));
+
+      benchmark.setThreads(threads);
+      i++;
+    }
+    else if(option == "--parareal")
+    {
+      benchmark.setPararealSlices(value.toInt());
+      i++;
+    }
+    else if(option == "--max-size")
+    {
+      benchmark.setMaxSize(value.toDouble());
+      i++;
+    }
+    else if(option == "--repeats")
+    {
+      benchmark.setRepeats(value.toInt());
+      i++;
+    }
+    else if(option == "--max-solve-calls")
+    {
+      benchmark.setMaxSolveCalls(value.toInt());
+      i++;
+    }
+    else if(option == "--max-iterations")
+    {
+      benchmark.setMaxIterations(value.toInt());
+      i++;
+    }
+    else if(option == "--output")
+    {
+      output = value;
+      i++;
+    }
+    else if(option == "--baseline")
+    {
+      baseline = value;
+      i++;
+    }
+    else if(option == "--threshold")
+    {
+      regression.setTimeThreshold(value.toDouble());
+      i++;
+    }
+    else if(option == "--rhs-threshold")
+    {
+      regression.setEvaluationThreshold(value.toDouble());
+      i++;
+    }
+    else if(option == "--confidence")
+    {
+      regression.setConfidenceLevel(value.toDouble());
+      i++;
+    }
+    else if(option == "--quiet")
+    {
+      benchmark.setVerbose(false);
+    }
+    else
+    {
+      printUsage();
+      return option == "--help" ? 0 : 1;
+    }
+  }
+
+  std::vector<ODEBenchmarkResult> baselineResults;
+
+  if(!baseline.isEmpty() && !ODEBenchmark::readJson(baseline, baselineResults))
+  {
+    fprintf(stderr, "Could not read baseline: %s\n", baseline.toStdString().c_str());
+    return 1;
+  }
+
+  benchmark.run();
+
+  if(!output.isEmpty() && !benchmark.writeJson(output))
+  {
+    return 1;
+  }
+
+  if(!baseline.isEmpty())
+  {
+    std::vector<ODEBenchmarkComparison> comparisons = regression.compare(baselineResults, benchmark.results());
+
+    if(regression.printReport(comparisons, stdout) > 0)
+      return 2;
+  }
+
+  return 0;
+}
@@ -0,0 +1,770 @@
+/*!
+*  \file    odebenchmark.cpp
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#include "stdafx.h"
+#include "benchmark/odebenchmark.h"
+#include "benchmark/odebenchmarkproblems.h"
+#include "typedodesolver.h"
+#include "odeparareal.h"
+#include "odekernels.h"
+
+#include <QFile>
+#include <QJsonArray>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+ODEBenchmarkResult::ODEBenchmarkResult()
+  : parameter(0.0),
+    simulatedTime(0.0),
+    error(0.0),
+    speedup(0.0),
+    size(0),
+    threads(1),
+    status(0),
+    solveCalls(0),
+    acceptedSteps(0),
+    rejectedSteps(0),
+    derivativeEvaluations(0),
+    peakMemory(0)
+{
+}
+
+QString ODEBenchmarkResult::key() const
+{
+  return QString("%1/%2/%3/%4").arg(problem).arg(parameter).arg(solver).arg(threads);
+}
+
+double ODEBenchmarkResult::medianTime() const
+{
+  if(times.empty())
+    return 0.0;
+
+  std::vector<double> sorted(times);
+  std::sort(sorted.begin(), sorted.end());
+  size_t mid = sorted.size() / 2;
+
+  return sorted.size() % 2 ? sorted[mid] : 0.5 * (sorted[mid - 1] + sorted[mid]);
+}
+
+double ODEBenchmarkResult::timePerStep() const
+{
+  return acceptedSteps > 0 ? medianTime() / acceptedSteps : 0.0;
+}
+
+QJsonObject ODEBenchmarkResult::toJson() const
+{
+  QJsonObject object;
+  QJsonArray timesArray;
+
+  for(double time : times)
+    timesArray.append(time);
+
+  object.insert("problem", problem);
+  object.insert("parameter", parameter);
+  object.insert("size", size);
+  object.insert("solver", solver);
+  object.insert("threads", threads);
+  object.insert("status", status);
+  object.insert("simulatedTime", simulatedTime);
+  object.insert("error", error);
+  object.insert("speedup", speedup);
+  object.insert("solveCalls", static_cast<double>(solveCalls));
+  object.insert("acceptedSteps", static_cast<double>(acceptedSteps));
+  object.insert("rejectedSteps", static_cast<double>(rejectedSteps));
+  object.insert("derivativeEvaluations", static_cast<double>(derivativeEvaluations));
+  object.insert("peakMemoryKB", static_cast<double>(peakMemory));
+  object.insert("times", timesArray);
+  object.insert("medianTime", medianTime());
+  object.insert("timePerStep", timePerStep());
+
+  return object;
+}
+
+ODEBenchmarkResult ODEBenchmarkResult::fromJson(const QJsonObject &object)
+{
+  ODEBenchmarkResult result;
+
+  result.problem = object.value("problem").toString();
+  result.parameter = object.value("parameter").toDouble();
+  result.size = object.value("size").toInt();
+  result.solver = object.value("solver").toString();
+  result.threads = object.value("threads").toInt(1);
+  result.status = object.value("status").toInt();
+  result.simulatedTime = object.value("simulatedTime").toDouble();
+  result.error = object.value("error").toDouble();
+  result.speedup = object.value("speedup").toDouble();
+  result.solveCalls = static_cast<long long>(object.value("solveCalls").toDouble());
+  result.acceptedSteps = static_cast<long long>(object.value("acceptedSteps").toDouble());
+  result.rejectedSteps = static_cast<long long>(object.value("rejectedSteps").toDouble());
+  result.derivativeEvaluations = static_cast<long long>(object.value("derivativeEvaluations").toDouble());
+  result.peakMemory = static_cast<long long>(object.value("peakMemoryKB").toDouble());
+
+  QJsonArray timesArray = object.value("times").toArray();
+
+  for(int i = 0; i < timesArray.size(); i++)
+    result.times.push_back(timesArray.at(i).toDouble());
+
+  return result;
+}
+
+ODEBenchmark::ODEBenchmark()
+  : m_problems(ODEBenchmarkProblem::problemNames()),
+    m_solverTypes(availableSolverTypes()),
+    m_precisions({"double"}),
+    m_threads({1}),
+    m_maxSize(1e4),
+    m_repeats(3),
+    m_maxSolveCalls(2000),
+    m_maxIterations(10000),
+    m_pararealSlices(0),
+    m_verbose(true)
+{
+  if(maxThreads() > 1)
+    m_threads.push_back(maxThreads());
+}
+
+void ODEBenchmark::setProblems(const std::vector<QString> &problems)
+{
+  m_problems = problems;
+}
+
+void ODEBenchmark::setSolverTypes(const std::vector<ODESolver::SolverType> &solverTypes)
+{
+  m_solverTypes = solverTypes;
+}
+
+void ODEBenchmark::setPrecisions(const std::vector<QString> &precisions)
+{
+  m_precisions = precisions;
+}
+
+void ODEBenchmark::setPararealSlices(int slices)
+{
+  m_pararealSlices = std::max(slices, 0);
+}
+
+void ODEBenchmark::setThreads(const std::vector<int> &threads)
+{
+  m_threads = threads;
+}
+
+void ODEBenchmark::setMaxSize(double maxSize)
+{
+  m_maxSize = maxSize;
+}
+
+void ODEBenchmark::setRepeats(int repeats)
+{
+  m_repeats = std::max(1, repeats);
+}
+
+void ODEBenchmark::setMaxSolveCalls(int maxSolveCalls)
+{
+  m_maxSolveCalls = std::max(1, maxSolveCalls);
+}
+
+void ODEBenchmark::setMaxIterations(int maxIterations)
+{
+  m_maxIterations = maxIterations;
+}
+
+void ODEBenchmark::setVerbose(bool verbose)
+{
+  m_verbose = verbose;
+}
+
+void ODEBenchmark::run()
+{
+  m_results.clear();
+
+  if(m_verbose)
+  {
+    printf("%-14s %10s %10s %-12s %7s %12s %12s %10s %10s %12s %6s %10s %8s\n", "problem", "parameter", "size", "solver", "threads",
+           "median(s)", "s/step", "steps", "rejected", "rhs evals", "status", "error", "speedup");
+  }
+
+  for(const QString &problemName : m_problems)
+  {
+    for(double scale : ODEBenchmarkProblem::scales(problemName, m_maxSize))
+    {
+      std::unique_ptr<ODEBenchmarkProblem> problem(ODEBenchmarkProblem::create(problemName, scale));
+
+      if(!problem)
+      {
+        fprintf(stderr, "Unknown benchmark problem: %s\n", problemName.toStdString().c_str());
+        break;
+      }
+
+      for(ODESolver::SolverType solverType : m_solverTypes)
+      {
+        for(const QString &precision : m_precisions)
+        {
+          bool typed = precision != "double";
+
+          if(typed && solverType != ODESolver::RK4 && solverType != ODESolver::RKQS)
+            continue;
+
+          for(int threads : m_threads)
+          {
+            ODEBenchmarkResult result = typed ? runPrecisionCase(problem.get(), solverType, precision, threads) :
+                                                runCase(problem.get(), solverType, threads);
+            m_results.push_back(result);
+
+            if(m_verbose)
+              printResult(result);
+
+            if(m_pararealSlices > 0 && !typed)
+            {
+              ODEBenchmarkResult parareal = runPararealCase(problem.get(), solverType, threads);
+              m_results.push_back(parareal);
+
+              if(m_verbose)
+                printResult(parareal);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+ODEBenchmarkResult ODEBenchmark::runCase(ODEBenchmarkProblem *problem, ODESolver::SolverType solverType, int threads) const
+{
+  ODEBenchmarkResult result;
+  result.problem = problem->name();
+  result.parameter = problem->parameter();
+  result.size = problem->size();
+  result.solver = solverName(solverType);
+  result.threads = threads;
+
+#ifdef USE_OPENMP
+  int previousThreads = omp_get_max_threads();
+  omp_set_num_threads(threads);
+#endif
+
+  long long memory = startMemoryMeasurement();
+
+  bool fixedStep = solverType == ODESolver::EULER || solverType == ODESolver::RK4 || solverType == ODESolver::LSRK4;
+  double step = fixedStep ? problem->fixedStep() : problem->outputStep();
+  int n = problem->size();
+  int solveCalls = std::min(m_maxSolveCalls, static_cast<int>(ceil((problem->endTime() - problem->startTime()) / step - 1e-9)));
+
+  std::vector<double> y(n), yout(n);
+
+  for(int r = 0; r < m_repeats; r++)
+  {
+    ODESolver solver(n, solverType);
+    configureSolver(solver, solverType);
+    solver.setCollectStatistics(true);
+    solver.initialize();
+
+    problem->initialConditions(y.data());
+
+    double t = problem->startTime();
+    int status = 0;
+    int call = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for(; call < solveCalls && !status; call++)
+    {
+      status = solver.solve(y.data(), n, t, step, yout.data(), problem->derivatives(), problem);
+      std::swap(y, yout);
+      t += step;
+    }
+
+    result.times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    const ODESolverStatistics &statistics = solver.statistics();
+    result.status = status;
+    result.solveCalls = call;
+    result.simulatedTime = t - problem->startTime();
+    result.acceptedSteps = statistics.acceptedSteps;
+    result.rejectedSteps = statistics.rejectedSteps;
+    result.derivativeEvaluations = statistics.derivativeEvaluations;
+  }
+
+  result.peakMemory = peakMemory(memory);
+
+#ifdef USE_OPENMP
+  omp_set_num_threads(previousThreads);
+#endif
+
+  return result;
+}
+
+ODEBenchmarkResult ODEBenchmark::runPararealCase(ODEBenchmarkProblem *problem, ODESolver::SolverType solverType, int threads) const
+{
+  ODEBenchmarkResult result;
+  result.problem = problem->name();
+  result.parameter = problem->parameter();
+  result.size = problem->size();
+  result.solver = solverName(solverType) + "_PARAREAL" + QString::number(m_pararealSlices);
+  result.threads = threads;
+
+#ifdef USE_OPENMP
+  int previousThreads = omp_get_max_threads();
+  omp_set_num_threads(threads);
+#endif
+
+  long long memory = startMemoryMeasurement();
+
+  bool fixedStep = solverType == ODESolver::EULER || solverType == ODESolver::RK4 || solverType == ODESolver::LSRK4;
+  double step = fixedStep ? problem->fixedStep() : problem->outputStep();
+  int n = problem->size();
+  int solveCalls = std::min(m_maxSolveCalls, static_cast<int>(ceil((problem->endTime() - problem->startTime()) / step - 1e-9)));
+
+  //Each slice covers the same whole number of solve calls as the serial run
+  int callsPerSlice = std::max(1, solveCalls / m_pararealSlices);
+  solveCalls = callsPerSlice * m_pararealSlices;
+
+  ODESolver fine(n, solverType), coarse(n, solverType);
+  configureSolver(fine, solverType);
+  configureSolver(coarse, solverType);
+  fine.setCollectStatistics(true);
+
+  if(!fixedStep)
+  {
+    coarse.setRelativeTolerance(1e-3);
+    coarse.setAbsoluteTolerance(1e-5);
+  }
+
+  std::vector<double> y0(n), ySerial(n), yParareal(n), yout(n);
+  problem->initialConditions(y0.data());
+
+  double serialTime = 0.0;
+  std::vector<double> serialTimes;
+
+  for(int r = 0; r < m_repeats; r++)
+  {
+    fine.initialize();
+    ySerial = y0;
+
+    double t = problem->startTime();
+    int status = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for(int call = 0; call < solveCalls && !status; call++)
+    {
+      status = fine.solve(ySerial.data(), n, t, step, yout.data(), problem->derivatives(), problem);
+      std::swap(ySerial, yout);
+      t += step;
+    }
+
+    serialTimes.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  std::sort(serialTimes.begin(), serialTimes.end());
+  serialTime = serialTimes[serialTimes.size() / 2];
+
+  for(int r = 0; r < m_repeats; r++)
+  {
+    ODEParareal parareal(coarse, fine, m_pararealSlices);
+    parareal.setFineSteps(callsPerSlice);
+    parareal.setCoarseSteps(fixedStep ? std::max(1, callsPerSlice / 10) : 1);
+    parareal.initialize();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    result.status = parareal.solve(y0.data(), n, problem->startTime(), solveCalls * step, yParareal.data(), problem->derivatives(), problem);
+
+    result.times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    ODESolverStatistics statistics = parareal.statistics();
+    result.acceptedSteps = statistics.acceptedSteps;
+    result.rejectedSteps = statistics.rejectedSteps;
+    result.derivativeEvaluations = statistics.derivativeEvaluations;
+  }
+
+  double maxDifference = 0.0, maxReference = 0.0;
+
+  for(int i = 0; i < n; i++)
+  {
+    double difference = fabs(yParareal[i] - ySerial[i]);
+    maxDifference = difference == difference ? std::max(maxDifference, difference) : difference;
+    maxReference = std::max(maxReference, fabs(ySerial[i]));
+  }
+
+  result.error = maxDifference / std::max(maxReference, 1e-30);
+  result.speedup = result.medianTime() > 0.0 ? serialTime / result.medianTime() : 0.0;
+  result.solveCalls = 1;
+  result.simulatedTime = solveCalls * step;
+  result.peakMemory = peakMemory(memory);
+
+#ifdef USE_OPENMP
+  omp_set_num_threads(previousThreads);
+#endif
+
+  return result;
+}
+
+/*!
+ * \brief runTyped Integrates a problem with TypedODESolver and returns the final state in double.
+ */
+template<typename Real, typename Accumulator>
+static int runTyped(ODEBenchmarkProblem *problem, typename TypedODESolver<Real, Accumulator>::Derivatives derivs,
+                    ODESolver::SolverType solverType, double step, int solveCalls, int maxIterations,
+                    std::vector<double> &yFinal, ODESolverStatistics &statistics, int &calls, double &elapsed)
+{
+  int n = problem->size();
+  std::vector<double> y0(n);
+  std::vector<Real> y(n), yout(n);
+
+  problem->initialConditions(y0.data());
+  std::copy(y0.begin(), y0.end(), y.begin());
+
+  TypedODESolver<Real, Accumulator> solver(n, solverType == ODESolver::RKQS ? TypedODESolver<Real, Accumulator>::RKQS :
+                                                                              TypedODESolver<Real, Accumulator>::RK4);
+  solver.setRelativeTolerance(1e-6);
+  solver.setMaxIterations(maxIterations);
+  solver.initialize();
+
+  double t = problem->startTime();
+  int status = 0;
+  calls = 0;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  for(; calls < solveCalls && !status; calls++)
+  {
+    status = solver.solve(y.data(), n, t, step, yout.data(), derivs, problem);
+    std::swap(y, yout);
+    t += step;
+  }
+
+  elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  yFinal.assign(y.begin(), y.end());
+  statistics = solver.statistics();
+
+  return status;
+}
+
+ODEBenchmarkResult ODEBenchmark::runPrecisionCase(ODEBenchmarkProblem *problem, ODESolver::SolverType solverType, const QString &precision, int threads) const
+{
+  ODEBenchmarkResult result;
+  result.problem = problem->name();
+  result.parameter = problem->parameter();
+  result.size = problem->size();
+  result.solver = solverName(solverType) + "_" + precision.toUpper();
+  result.threads = threads;
+
+#ifdef USE_OPENMP
+  int previousThreads = omp_get_max_threads();
+  omp_set_num_threads(threads);
+#endif
+
+  long long memory = startMemoryMeasurement();
+
+  double step = solverType == ODESolver::RK4 ? problem->fixedStep() : problem->outputStep();
+  int solveCalls = std::min(m_maxSolveCalls, static_cast<int>(ceil((problem->endTime() - problem->startTime()) / step - 1e-9)));
+
+  std::vector<double> reference, yFinal;
+  ODESolverStatistics statistics;
+  int calls = 0;
+  double elapsed = 0.0;
+
+  //Untimed double precision reference for the error
+  runTyped<double, double>(problem, problem->derivatives(), solverType, step, solveCalls, m_maxIterations, reference, statistics, calls, elapsed);
+
+  for(int r = 0; r < m_repeats; r++)
+  {
+    if(precision == "mixed")
+      result.status = runTyped<float, double>(problem, problem->derivativesFloat(), solverType, step, solveCalls, m_maxIterations, yFinal, statistics, calls, elapsed);
+    else if(precision == "float")
+      result.status = runTyped<float, float>(problem, problem->derivativesFloat(), solverType, step, solveCalls, m_maxIterations, yFinal, statistics, calls, elapsed);
+    else
+      result.status = runTyped<double, double>(problem, problem->derivatives(), solverType, step, solveCalls, m_maxIterations, yFinal, statistics, calls, elapsed);
+
+    result.times.push_back(elapsed);
+  }
+
+  double maxDifference = 0.0, maxReference = 0.0;
+
+  for(size_t i = 0; i < reference.size(); i++)
+  {
+    double difference = fabs(yFinal[i] - reference[i]);
+
+    //A diverged run reports NaN rather than a misleading zero
+    maxDifference = difference == difference ? std::max(maxDifference, difference) : difference;
+    maxReference = std::max(maxReference, fabs(reference[i]));
+  }
+
+  result.error = maxDifference / std::max(maxReference, 1e-30);
+  result.solveCalls = calls;
+  result.simulatedTime = calls * step;
+  result.acceptedSteps = statistics.acceptedSteps;
+  result.rejectedSteps = statistics.rejectedSteps;
+  result.derivativeEvaluations = statistics.derivativeEvaluations;
+  result.peakMemory = peakMemory(memory);
+
+#ifdef USE_OPENMP
+  omp_set_num_threads(previousThreads);
+#endif
+
+  return result;
+}
+
+const std::vector<ODEBenchmarkResult> &ODEBenchmark::results() const
+{
+  return m_results;
+}
+
+QJsonDocument ODEBenchmark::toJson() const
+{
+  QJsonObject root;
+  QJsonObject machine;
+  QJsonArray results;
+
+  machine.insert("maxThreads", maxThreads());
+#ifdef USE_OPENMP
+  machine.insert("openmp", true);
+#else
+  machine.insert("openmp", false);
+#endif
+#ifdef USE_CVODE
+  machine.insert("cvode", true);
+#else
+  machine.insert("cvode", false);
+#endif
+  machine.insert("kernels", ODEKernels::isaName(ODEKernels::isa()));
+
+  for(const ODEBenchmarkResult &result : m_results)
+    results.append(result.toJson());
+
+  root.insert("version", 1);
+  root.insert("repeats", m_repeats);
+  root.insert("maxSolveCalls", m_maxSolveCalls);
+  root.insert("machine", machine);
+  root.insert("results", results);
+
+  return QJsonDocument(root);
+}
+
+bool ODEBenchmark::writeJson(const QString &filePath) const
+{
+  QFile file(filePath);
+
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    fprintf(stderr, "Could not open %s for writing\n", filePath.toStdString().c_str());
+    return false;
+  }
+
+  file.write(toJson().toJson());
+  file.close();
+
+  return true;
+}
+
+bool ODEBenchmark::readJson(const QString &filePath, std::vector<ODEBenchmarkResult> &results)
+{
+  QFile file(filePath);
+
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    fprintf(stderr, "Could not open %s for reading\n", filePath.toStdString().c_str());
+    return false;
+  }
+
+  QJsonParseError error;
+  QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+
+  if(error.error != QJsonParseError::NoError || !document.isObject())
+  {
+    fprintf(stderr, "Could not parse %s: %s\n", filePath.toStdString().c_str(), error.errorString().toStdString().c_str());
+    return false;
+  }
+
+  QJsonArray array = document.object().value("results").toArray();
+
+  for(int i = 0; i < array.size(); i++)
+    results.push_back(ODEBenchmarkResult::fromJson(array.at(i).toObject()));
+
+  return true;
+}
+
+QString ODEBenchmark::solverName(ODESolver::SolverType solverType)
+{
+  switch (solverType)
+  {
+    case ODESolver::EULER:
+      return "EULER";
+    case ODESolver::RK4:
+      return "RK4";
+    case ODESolver::RKQS:
+      return "RKQS";
+    case ODESolver::LSRK4:
+      return "LSRK4";
+    case ODESolver::LSRK45:
+      return "LSRK45";
+    case ODESolver::ADAMS:
+      return "ADAMS";
+    case ODESolver::GBS:
+      return "GBS";
+    case ODESolver::RKC:
+      return "RKC";
+    case ODESolver::EXPRK2:
+      return "EXPRK2";
+    case ODESolver::EXPRB32:
+      return "EXPRB32";
+#ifdef USE_CVODE
+    case ODESolver::CVODE_ADAMS:
+      return "CVODE_ADAMS";
+    case ODESolver::CVODE_BDF:
+      return "CVODE_BDF";
+#endif
+  }
+
+  return "UNKNOWN";
+}
+
+bool ODEBenchmark::solverTypeFromName(const QString &name, ODESolver::SolverType &solverType)
+{
+  for(ODESolver::SolverType type : availableSolverTypes())
+  {
+    if(solverName(type) == name.toUpper())
+    {
+      solverType = type;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+std::vector<ODESolver::SolverType> ODEBenchmark::availableSolverTypes()
+{
+  //EXPRK2 needs the linear part of the right-hand side, which the benchmark problems do not split off
+  std::vector<ODESolver::SolverType> solverTypes = {ODESolver::EULER, ODESolver::RK4, ODESolver::RKQS, ODESolver::LSRK4, ODESolver::LSRK45, ODESolver::ADAMS,
+                                                       ODESolver::GBS, ODESolver::RKC, ODESolver::EXPRB32};
+
+#ifdef USE_CVODE
+  solverTypes.push_back(ODESolver::CVODE_ADAMS);
+  solverTypes.push_back(ODESolver::CVODE_BDF);
+#endif
+
+  return solverTypes;
+}
+
+int ODEBenchmark::maxThreads()
+{
+#ifdef USE_OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+long long ODEBenchmark::startMemoryMeasurement()
+{
+#if defined(__linux__)
+  //Writing 5 to clear_refs resets the peak resident memory to the current one (Linux 4.0+)
+  FILE *file = fopen("/proc/self/clear_refs", "w");
+
+  if(!file)
+    return -1;
+
+  bool reset = fputs("5", file) >= 0;
+  reset = fclose(file) == 0 && reset;
+
+  return reset ? memoryStatus("VmRSS") : -1;
+#else
+  return -1;
+#endif
+}
+
+long long ODEBenchmark::peakMemory(long long start)
+{
+#if defined(__linux__)
+  if(start < 0)
+    return 0;
+
+  long long peak = memoryStatus("VmHWM");
+  return peak > start ? peak - start : 0;
+#else
+  (void)start;
+  return 0;
+#endif
+}
+
+long long ODEBenchmark::memoryStatus(const char *field)
+{
+  long long value = -1;
+
+#if defined(__linux__)
+  FILE *file = fopen("/proc/self/status", "r");
+
+  if(file)
+  {
+    char line[256];
+    size_t length = strlen(field);
+
+    while(fgets(line, sizeof(line), file))
+    {
+      if(!strncmp(line, field, length) && line[length] == ':')
+      {
+        sscanf(line + length + 1, "%lld", &value);
+        break;
+      }
+    }
+
+    fclose(file);
+  }
+#else
+  (void)field;
+#endif
+
+  return value;
+}
+
+void ODEBenchmark::printResult(const ODEBenchmarkResult &result) const
+{
+  printf("%-14s %10g %10d %-12s %7d %12.5g %12.5g %10lld %10lld %12lld %6d %10.3g %8.3g\n", result.problem.toStdString().c_str(), result.parameter,
+         result.size, result.solver.toStdString().c_str(), result.threads, result.medianTime(), result.timePerStep(),
+         result.acceptedSteps, result.rejectedSteps, result.derivativeEvaluations, result.status, result.error, result.speedup);
+  fflush(stdout);
+}
+
+void ODEBenchmark::configureSolver(ODESolver &solver, ODESolver::SolverType solverType) const
+{
+  solver.setRelativeTolerance(1e-6);
+  solver.setAbsoluteTolerance(1e-8);
+  solver.setMaxIterations(m_maxIterations);
+
+#ifdef USE_CVODE
+  if(solverType == ODESolver::CVODE_BDF)
+  {
+    solver.setSolverIterationMethod(ODESolver::NEWTON);
+    solver.setLinearSolverType(ODESolver::GMRES);
+  }
+#else
+  (void)solverType;
+#endif
+}
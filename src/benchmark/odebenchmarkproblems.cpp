@@ -0,0 +1,325 @@
+/*!
+*  \file    odebenchmarkproblems.cpp
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#include "stdafx.h"
+#include "benchmark/odebenchmarkproblems.h"
+
+#include <math.h>
+#include <algorithm>
+
+ODEBenchmarkProblem *ODEBenchmarkProblem::create(const QString &name, double scale)
+{
+  if(name == "robertson")
+    return new RobertsonProblem();
+  else if(name == "brusselator1d")
+    return new Brusselator1DProblem(std::max(1, static_cast<int>(scale / 2)));
+  else if(name == "brusselator2d")
+    return new Brusselator2DProblem(std::max(2, static_cast<int>(sqrt(scale / 2.0) + 0.5)));
+  else if(name == "lorenz96")
+    return new Lorenz96Problem(std::max(4, static_cast<int>(scale)));
+  else if(name == "vanderpol")
+    return new VanDerPolProblem(scale);
+  else if(name == "batchedcells")
+    return new BatchedCellsProblem(std::max(1, static_cast<int>(scale / 3)));
+
+  return nullptr;
+}
+
+std::vector<QString> ODEBenchmarkProblem::problemNames()
+{
+  return {"robertson", "brusselator1d", "brusselator2d", "lorenz96", "vanderpol", "batchedcells"};
+}
+
+std::vector<double> ODEBenchmarkProblem::scales(const QString &name, double maxSize)
+{
+  std::vector<double> values;
+
+  if(name == "robertson")
+  {
+    values.push_back(3);
+  }
+  else if(name == "vanderpol")
+  {
+    values = {1.0, 10.0, 100.0, 1000.0};
+  }
+  else
+  {
+    for(double scale = 100; scale <= maxSize * 1.0001; scale *= 10)
+      values.push_back(scale);
+  }
+
+  return values;
+}
+
+RobertsonProblem::RobertsonProblem()
+{
+  m_size = 3;
+  m_parameter = 3;
+  m_startTime = 0.0;
+  m_endTime = 1.0;
+  m_outputStep = 0.1;
+  m_fixedStep = 1e-4;
+}
+
+void RobertsonProblem::initialConditions(double y[]) const
+{
+  y[0] = 1.0;
+  y[1] = 0.0;
+  y[2] = 0.0;
+}
+
+template<typename Real>
+void RobertsonProblem::computeDerivatives(double, Real y[], Real dydt[], void *)
+{
+  dydt[0] = Real(-0.04) * y[0] + Real(1.0e4) * y[1] * y[2];
+  dydt[2] = Real(3.0e7) * y[1] * y[1];
+  dydt[1] = -dydt[0] - dydt[2];
+}
+
+template void RobertsonProblem::computeDerivatives<double>(double t, double y[], double dydt[], void* userData);
+template void RobertsonProblem::computeDerivatives<float>(double t, float y[], float dydt[], void* userData);
+
+Brusselator1DProblem::Brusselator1DProblem(int gridSize)
+  : m_gridSize(gridSize),
+    m_alpha(0.02)
+{
+  double dx2 = 1.0 / ((gridSize + 1.0) * (gridSize + 1.0));
+
+  m_size = 2 * gridSize;
+  m_parameter = gridSize;
+  m_startTime = 0.0;
+  m_endTime = 1.0;
+  m_outputStep = 0.1;
+  m_fixedStep = std::min(0.01, 0.5 / (4.0 * m_alpha / dx2 + 5.0));
+}
+
+void Brusselator1DProblem::initialConditions(double y[]) const
+{
+  for(int i = 0; i < m_gridSize; i++)
+  {
+    double x = (i + 1.0) / (m_gridSize + 1.0);
+    y[2 * i] = 1.0 + sin(2.0 * M_PI * x);
+    y[2 * i + 1] = 3.0;
+  }
+}
+
+template<typename Real>
+void Brusselator1DProblem::computeDerivatives(double, Real y[], Real dydt[], void *userData)
+{
+  const Brusselator1DProblem *problem = static_cast<const Brusselator1DProblem*>(userData);
+  const int N = problem->m_gridSize;
+  const Real A = 1.0, B = 3.0;
+  const Real c = problem->m_alpha * (N + 1.0) * (N + 1.0);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for(int i = 0; i < N; i++)
+  {
+    Real u = y[2 * i], v = y[2 * i + 1];
+    Real uw = i > 0 ? y[2 * (i - 1)] : Real(1.0), ue = i < N - 1 ? y[2 * (i + 1)] : Real(1.0);
+    Real vw = i > 0 ? y[2 * (i - 1) + 1] : Real(3.0), ve = i < N - 1 ? y[2 * (i + 1) + 1] : Real(3.0);
+
+    dydt[2 * i] = A + u * u * v - (B + Real(1.0)) * u + c * (uw - Real(2.0) * u + ue);
+    dydt[2 * i + 1] = B * u - u * u * v + c * (vw - Real(2.0) * v + ve);
+  }
+}
+
+template void Brusselator1DProblem::computeDerivatives<double>(double t, double y[], double dydt[], void* userData);
+template void Brusselator1DProblem::computeDerivatives<float>(double t, float y[], float dydt[], void* userData);
+
+Brusselator2DProblem::Brusselator2DProblem(int gridSize)
+  : m_gridSize(gridSize),
+    m_alpha(0.002)
+{
+  double dx2 = 1.0 / (1.0 * gridSize * gridSize);
+
+  m_size = 2 * gridSize * gridSize;
+  m_parameter = gridSize;
+  m_startTime = 0.0;
+  m_endTime = 1.0;
+  m_outputStep = 0.1;
+  m_fixedStep = std::min(0.01, 0.5 / (8.0 * m_alpha / dx2 + 5.0));
+}
+
+void Brusselator2DProblem::initialConditions(double y[]) const
+{
+  const int N = m_gridSize;
+
+  for(int j = 0; j < N; j++)
+  {
+    for(int i = 0; i < N; i++)
+    {
+      double x = i / (1.0 * N), yc = j / (1.0 * N);
+      y[2 * (j * N + i)] = 22.0 * yc * pow(1.0 - yc, 1.5);
+      y[2 * (j * N + i) + 1] = 27.0 * x * pow(1.0 - x, 1.5);
+    }
+  }
+}
+
+template<typename Real>
+void Brusselator2DProblem::computeDerivatives(double, Real y[], Real dydt[], void *userData)
+{
+  const Brusselator2DProblem *problem = static_cast<const Brusselator2DProblem*>(userData);
+  const int N = problem->m_gridSize;
+  const Real A = 1.0, B = 3.4;
+  const Real c = problem->m_alpha * N * N;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for(int j = 0; j < N; j++)
+  {
+    int jn = (j + 1) % N, js = (j + N - 1) % N;
+
+    for(int i = 0; i < N; i++)
+    {
+      int ie = (i + 1) % N, iw = (i + N - 1) % N;
+      int k = 2 * (j * N + i);
+      Real u = y[k], v = y[k + 1];
+      Real lu = y[2 * (j * N + ie)] + y[2 * (j * N + iw)] + y[2 * (jn * N + i)] + y[2 * (js * N + i)] - Real(4.0) * u;
+      Real lv = y[2 * (j * N + ie) + 1] + y[2 * (j * N + iw) + 1] + y[2 * (jn * N + i) + 1] + y[2 * (js * N + i) + 1] - Real(4.0) * v;
+
+      dydt[k] = A + u * u * v - (B + Real(1.0)) * u + c * lu;
+      dydt[k + 1] = B * u - u * u * v + c * lv;
+    }
+  }
+}
+
+template void Brusselator2DProblem::computeDerivatives<double>(double t, double y[], double dydt[], void* userData);
+template void Brusselator2DProblem::computeDerivatives<float>(double t, float y[], float dydt[], void* userData);
+
+Lorenz96Problem::Lorenz96Problem(int size)
+{
+  m_size = size;
+  m_parameter = size;
+  m_startTime = 0.0;
+  m_endTime = 1.0;
+  m_outputStep = 0.1;
+  m_fixedStep = 0.005;
+}
+
+void Lorenz96Problem::initialConditions(double y[]) const
+{
+  for(int i = 0; i < m_size; i++)
+    y[i] = 8.0 + 0.01 * sin(0.1 * i);
+
+  y[0] += 0.01;
+}
+
+template<typename Real>
+void Lorenz96Problem::computeDerivatives(double, Real y[], Real dydt[], void *userData)
+{
+  const int n = static_cast<const Lorenz96Problem*>(userData)->m_size;
+  const Real F = 8.0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for(int i = 0; i < n; i++)
+  {
+    int ip1 = i + 1 < n ? i + 1 : i + 1 - n;
+    int im1 = i >= 1 ? i - 1 : i - 1 + n;
+    int im2 = i >= 2 ? i - 2 : i - 2 + n;
+
+    dydt[i] = (y[ip1] - y[im2]) * y[im1] - y[i] + F;
+  }
+}
+
+template void Lorenz96Problem::computeDerivatives<double>(double t, double y[], double dydt[], void* userData);
+template void Lorenz96Problem::computeDerivatives<float>(double t, float y[], float dydt[], void* userData);
+
+VanDerPolProblem::VanDerPolProblem(double mu)
+{
+  m_size = 2;
+  m_parameter = mu;
+  m_startTime = 0.0;
+  m_endTime = 2.0;
+  m_outputStep = 0.1;
+  m_fixedStep = std::min(1e-2, 0.1 / mu);
+}
+
+void VanDerPolProblem::initialConditions(double y[]) const
+{
+  y[0] = 2.0;
+  y[1] = 0.0;
+}
+
+template<typename Real>
+void VanDerPolProblem::computeDerivatives(double, Real y[], Real dydt[], void *userData)
+{
+  Real mu = static_cast<const VanDerPolProblem*>(userData)->m_parameter;
+
+  dydt[0] = y[1];
+  dydt[1] = mu * ((Real(1.0) - y[0] * y[0]) * y[1] - y[0]);
+}
+
+template void VanDerPolProblem::computeDerivatives<double>(double t, double y[], double dydt[], void* userData);
+template void VanDerPolProblem::computeDerivatives<float>(double t, float y[], float dydt[], void* userData);
+
+BatchedCellsProblem::BatchedCellsProblem(int numCells)
+  : m_numCells(numCells),
+    m_k1(numCells),
+    m_k2(numCells)
+{
+  m_size = 3 * numCells;
+  m_parameter = numCells;
+  m_startTime = 0.0;
+  m_endTime = 1.0;
+  m_outputStep = 0.1;
+  m_fixedStep = 0.002;
+
+  for(int c = 0; c < numCells; c++)
+  {
+    m_k1[c] = 0.5 + 4.5 * ((c * 7919) % 1000) / 1000.0;
+    m_k2[c] = 1.0 + 99.0 * ((c * 104729) % 1000) / 1000.0;
+  }
+}
+
+void BatchedCellsProblem::initialConditions(double y[]) const
+{
+  for(int c = 0; c < m_numCells; c++)
+  {
+    y[3 * c] = 1.0;
+    y[3 * c + 1] = 0.0;
+    y[3 * c + 2] = 0.0;
+  }
+}
+
+template<typename Real>
+void BatchedCellsProblem::computeDerivatives(double, Real y[], Real dydt[], void *userData)
+{
+  const BatchedCellsProblem *problem = static_cast<const BatchedCellsProblem*>(userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for(int c = 0; c < problem->m_numCells; c++)
+  {
+    Real r1 = Real(problem->m_k1[c]) * y[3 * c];
+    Real r2 = Real(problem->m_k2[c]) * y[3 * c + 1] * y[3 * c + 1];
+
+    dydt[3 * c] = -r1;
+    dydt[3 * c + 1] = r1 - Real(2.0) * r2;
+    dydt[3 * c + 2] = r2;
+  }
+}
+
+template void BatchedCellsProblem::computeDerivatives<double>(double t, double y[], double dydt[], void* userData);
+template void BatchedCellsProblem::computeDerivatives<float>(double t, float y[], float dydt[], void* userData);
@@ -0,0 +1,206 @@
+/*!
+*  \file    odebenchmarkregression.cpp
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#include "stdafx.h"
+#include "benchmark/odebenchmarkregression.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+
+ODEBenchmarkComparison::ODEBenchmarkComparison()
+  : baselineTimePerStep(0.0),
+    currentTimePerStep(0.0),
+    timeRatio(1.0),
+    timeRatioLower(1.0),
+    timeRatioUpper(1.0),
+    baselineEvaluations(0),
+    currentEvaluations(0),
+    missingBaseline(false),
+    statusRegression(false),
+    timeRegression(false),
+    evaluationRegression(false)
+{
+}
+
+bool ODEBenchmarkComparison::regression() const
+{
+  return statusRegression || timeRegression || evaluationRegression;
+}
+
+ODEBenchmarkRegression::ODEBenchmarkRegression()
+  : m_timeThreshold(0.1),
+    m_evaluationThreshold(0.0),
+    m_confidenceLevel(0.95),
+    m_bootstrapSamples(2000)
+{
+}
+
+void ODEBenchmarkRegression::setTimeThreshold(double threshold)
+{
+  m_timeThreshold = std::max(0.0, threshold);
+}
+
+void ODEBenchmarkRegression::setEvaluationThreshold(double threshold)
+{
+  m_evaluationThreshold = std::max(0.0, threshold);
+}
+
+void ODEBenchmarkRegression::setConfidenceLevel(double level)
+{
+  m_confidenceLevel = std::min(0.999, std::max(0.5, level));
+}
+
+void ODEBenchmarkRegression::setBootstrapSamples(int samples)
+{
+  m_bootstrapSamples = std::max(100, samples);
+}
+
+std::vector<ODEBenchmarkComparison> ODEBenchmarkRegression::compare(const std::vector<ODEBenchmarkResult> &baseline,
+                                                                    const std::vector<ODEBenchmarkResult> &current) const
+{
+  std::map<std::string, const ODEBenchmarkResult*> baselineByKey;
+
+  for(const ODEBenchmarkResult &result : baseline)
+    baselineByKey[result.key().toStdString()] = &result;
+
+  std::vector<ODEBenchmarkComparison> comparisons;
+
+  for(const ODEBenchmarkResult &result : current)
+  {
+    ODEBenchmarkComparison comparison;
+    comparison.key = result.key();
+    comparison.currentTimePerStep = result.timePerStep();
+    comparison.currentEvaluations = result.derivativeEvaluations;
+
+    std::map<std::string, const ODEBenchmarkResult*>::const_iterator it = baselineByKey.find(result.key().toStdString());
+
+    if(it == baselineByKey.end())
+    {
+      comparison.missingBaseline = true;
+      comparisons.push_back(comparison);
+      continue;
+    }
+
+    const ODEBenchmarkResult &reference = *it->second;
+    comparison.baselineTimePerStep = reference.timePerStep();
+    comparison.baselineEvaluations = reference.derivativeEvaluations;
+    comparison.statusRegression = reference.status == 0 && result.status != 0;
+
+    //Normalise each repeat by its step count so a change in the number of steps shows up in the evaluations check only
+    if(reference.acceptedSteps > 0 && result.acceptedSteps > 0 && !reference.times.empty() && !result.times.empty())
+    {
+      std::vector<double> baselinePerStep, currentPerStep;
+
+      for(double time : reference.times)
+        baselinePerStep.push_back(time / reference.acceptedSteps);
+
+      for(double time : result.times)
+        currentPerStep.push_back(time / result.acceptedSteps);
+
+      comparison.timeRatio = median(currentPerStep) / median(baselinePerStep);
+      bootstrapRatio(baselinePerStep, currentPerStep, comparison.timeRatioLower, comparison.timeRatioUpper);
+      comparison.timeRegression = comparison.timeRatioLower > 1.0 + m_timeThreshold;
+    }
+
+    comparison.evaluationRegression = comparison.currentEvaluations > comparison.baselineEvaluations * (1.0 + m_evaluationThreshold);
+
+    comparisons.push_back(comparison);
+  }
+
+  return comparisons;
+}
+
+int ODEBenchmarkRegression::printReport(const std::vector<ODEBenchmarkComparison> &comparisons, FILE *stream) const
+{
+  int regressions = 0;
+  int missing = 0;
+
+  fprintf(stream, "Benchmark regression check: time threshold %.1f%% at %.0f%% confidence, evaluation threshold %.1f%%\n",
+          100.0 * m_timeThreshold, 100.0 * m_confidenceLevel, 100.0 * m_evaluationThreshold);
+
+  for(const ODEBenchmarkComparison &comparison : comparisons)
+  {
+    std::string keyString = comparison.key.toStdString();
+    const char *key = keyString.c_str();
+
+    if(comparison.missingBaseline)
+    {
+      missing++;
+      fprintf(stream, "  NEW         %s (no baseline entry)\n", key);
+      continue;
+    }
+
+    const char *label = comparison.regression() ? "REGRESSION" :
+                        comparison.timeRatioUpper < 1.0 - m_timeThreshold ? "IMPROVED" : "OK";
+
+    fprintf(stream, "  %-11s %s time/step %+.1f%% [%+.1f%%, %+.1f%%] rhs evals %lld -> %lld%s\n", label, key,
+            100.0 * (comparison.timeRatio - 1.0), 100.0 * (comparison.timeRatioLower - 1.0), 100.0 * (comparison.timeRatioUpper - 1.0),
+            comparison.baselineEvaluations, comparison.currentEvaluations,
+            comparison.statusRegression ? " (solver failed)" : "");
+
+    if(comparison.regression())
+      regressions++;
+  }
+
+  fprintf(stream, "%d regression(s), %d case(s) without baseline, %d case(s) compared\n",
+          regressions, missing, static_cast<int>(comparisons.size()) - missing);
+
+  return regressions;
+}
+
+void ODEBenchmarkRegression::bootstrapRatio(const std::vector<double> &baseline, const std::vector<double> &current,
+                                            double &lower, double &upper) const
+{
+  //Fixed seed so the gate gives the same verdict for the same measurements
+  std::mt19937 generator(20180101);
+  std::uniform_int_distribution<size_t> baselineIndex(0, baseline.size() - 1);
+  std::uniform_int_distribution<size_t> currentIndex(0, current.size() - 1);
+
+  std::vector<double> ratios(m_bootstrapSamples);
+  std::vector<double> baselineSample(baseline.size()), currentSample(current.size());
+
+  for(int b = 0; b < m_bootstrapSamples; b++)
+  {
+    for(size_t i = 0; i < baseline.size(); i++)
+      baselineSample[i] = baseline[baselineIndex(generator)];
+
+    for(size_t i = 0; i < current.size(); i++)
+      currentSample[i] = current[currentIndex(generator)];
+
+    ratios[b] = median(currentSample) / median(baselineSample);
+  }
+
+  std::sort(ratios.begin(), ratios.end());
+
+  double alpha = 0.5 * (1.0 - m_confidenceLevel);
+  size_t lowerIndex = static_cast<size_t>(alpha * (m_bootstrapSamples - 1));
+  size_t upperIndex = static_cast<size_t>((1.0 - alpha) * (m_bootstrapSamples - 1) + 0.5);
+
+  lower = ratios[lowerIndex];
+  upper = ratios[std::min(upperIndex, ratios.size() - 1)];
+}
+
+double ODEBenchmarkRegression::median(std::vector<double> values)
+{
+  std::sort(values.begin(), values.end());
+  size_t mid = values.size() / 2;
+
+  return values.size() % 2 ? values[mid] : 0.5 * (values[mid - 1] + values[mid]);
+}
@@ -0,0 +1,534 @@
+/*!
+ *  \file    lockstepodesolver.cpp
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#include "stdafx.h"
+#include "lockstepodesolver.h"
+#include "odebatchstate.h"
+#include "odekernels.h"
+
+#if defined(USE_OPENMP)
+#include <omp.h>
+#endif
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#define ODE_TINY 1.0e-30
+
+//Number of n * lanes arrays in a thread workspace: packed y, dydt, yscal, ytemp, yerr and five stages.
+#define LOCKSTEP_ARRAYS 10
+
+LockstepODESolver::LockstepODESolver(int size, int lanes, SolverType solverType)
+  : m_size(size),
+    m_lanes(lanes >= 8 ? 8 : 4),
+    m_maxSteps(50000),
+    m_currentIterations(0),
+    m_numThreads(1),
+    m_safety(0.9),
+    m_pgrow(-0.2),
+    m_pshrnk(-0.25),
+    m_errcon(1.89e-4),
+    m_relTol(1e-6),
+    m_workspace(nullptr),
+    m_solverType(solverType)
+{
+}
+
+LockstepODESolver::~LockstepODESolver()
+{
+  clearMemory();
+}
+
+void LockstepODESolver::initialize()
+{
+  clearMemory();
+
+#ifdef USE_OPENMP
+  m_numThreads = omp_get_max_threads();
+#else
+  m_numThreads = 1;
+#endif
+
+  m_workspace = ODEBatchState::allocate(static_cast<size_t>(m_numThreads) * workspaceSize());
+
+  //Each thread first touches its own workspace so it is placed on the thread's NUMA node
+#ifdef USE_OPENMP
+#pragma omp parallel num_threads(m_numThreads)
+  {
+    memset(&m_workspace[omp_get_thread_num() * workspaceSize()], 0, workspaceSize() * sizeof(double));
+  }
+#else
+  memset(m_workspace, 0, workspaceSize() * sizeof(double));
+#endif
+}
+
+int LockstepODESolver::size() const
+{
+  return m_size;
+}
+
+void LockstepODESolver::setSize(int size)
+{
+  m_size = size;
+}
+
+int LockstepODESolver::lanes() const
+{
+  return m_lanes;
+}
+
+void LockstepODESolver::setLanes(int lanes)
+{
+  m_lanes = lanes >= 8 ? 8 : 4;
+}
+
+LockstepODESolver::SolverType LockstepODESolver::solverType() const
+{
+  return m_solverType;
+}
+
+void LockstepODESolver::setSolverType(SolverType solverType)
+{
+  m_solverType = solverType;
+}
+
+int LockstepODESolver::maxIterations() const
+{
+  return m_maxSteps;
+}
+
+void LockstepODESolver::setMaxIterations(int iterations)
+{
+  if(iterations > 0)
+    m_maxSteps = iterations;
+}
+
+int LockstepODESolver::getIterations() const
+{
+  return m_currentIterations;
+}
+
+double LockstepODESolver::relativeTolerance() const
+{
+  return m_relTol;
+}
+
+void LockstepODESolver::setRelativeTolerance(double tolerance)
+{
+  m_relTol = tolerance;
+}
+
+int LockstepODESolver::solve(double y[], int numSystems, double t, double dt, double yout[], ComputeLockstepDerivatives derivs, void *userData)
+{
+  switch (m_lanes)
+  {
+    case 8:
+      return solveBlocks<8>(y, numSystems, t, dt, yout, derivs, userData);
+    default:
+      return solveBlocks<4>(y, numSystems, t, dt, yout, derivs, userData);
+  }
+}
+
+int LockstepODESolver::solve(const ODEBatchState &y, double t, double dt, ODEBatchState &yout, ComputeLockstepDerivatives derivs, void *userData)
+{
+  if(y.size() != m_size || y.lanes() != m_lanes || yout.size() != m_size ||
+     yout.lanes() != m_lanes || yout.numSystems() != y.numSystems())
+  {
+    return 1;
+  }
+
+  switch (m_lanes)
+  {
+    case 8:
+      return solveBatch<8>(y, t, dt, yout, derivs, userData);
+    default:
+      return solveBatch<4>(y, t, dt, yout, derivs, userData);
+  }
+}
+
+template<int W>
+int LockstepODESolver::solveBatch(const ODEBatchState &y, double t, double dt, ODEBatchState &yout, ComputeLockstepDerivatives derivs, void *userData)
+{
+  int n = m_size;
+  int numBlocks = y.numBlocks();
+  int result = 0;
+  int maxSteps = 0;
+
+  yout.pad();
+
+  //Same static schedule as the first touch in ODEBatchState
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) reduction(max:maxSteps)
+#endif
+  for(int b = 0; b < numBlocks; b++)
+  {
+#ifdef USE_OPENMP
+    double *workspace = &m_workspace[omp_get_thread_num() * workspaceSize()];
+#else
+    double *workspace = m_workspace;
+#endif
+
+    double *yp = yout.block(b);
+
+    if(&y != &yout)
+      memcpy(yp, y.block(b), n * W * sizeof(double));
+
+    int steps = 0;
+    int blockResult = m_solverType == RKQS ? rkqs<W>(workspace + n * W, yp, b * W, t, dt, &steps, derivs, userData) :
+                                             rk4<W>(workspace + n * W, yp, b * W, t, dt, &steps, derivs, userData);
+
+    maxSteps = std::max(maxSteps, steps);
+
+    if(blockResult)
+    {
+#ifdef USE_OPENMP
+#pragma omp critical (LockstepODESolver_result)
+#endif
+      {
+        if(!result)
+          result = blockResult;
+      }
+    }
+  }
+
+  m_currentIterations = maxSteps;
+
+  return result;
+}
+
+template<int W>
+int LockstepODESolver::solveBlocks(double y[], int numSystems, double t, double dt, double yout[], ComputeLockstepDerivatives derivs, void *userData)
+{
+  int n = m_size;
+  int numBlocks = (numSystems + W - 1) / W;
+  int result = 0;
+  int maxSteps = 0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) reduction(max:maxSteps)
+#endif
+  for(int b = 0; b < numBlocks; b++)
+  {
+#ifdef USE_OPENMP
+    double *workspace = &m_workspace[omp_get_thread_num() * workspaceSize()];
+#else
+    double *workspace = m_workspace;
+#endif
+
+    double *yp = workspace;
+    int firstSystem = b * W;
+    int activeLanes = std::min(W, numSystems - firstSystem);
+
+    //Pack, padding trailing lanes with the last system of the block
+    for(int l = 0; l < W; l++)
+    {
+      const double *ys = &y[(firstSystem + std::min(l, activeLanes - 1)) * n];
+
+      for(int i = 0; i < n; i++)
+        yp[i * W + l] = ys[i];
+    }
+
+    int steps = 0;
+    int blockResult = m_solverType == RKQS ? rkqs<W>(workspace + n * W, yp, firstSystem, t, dt, &steps, derivs, userData) :
+                                             rk4<W>(workspace + n * W, yp, firstSystem, t, dt, &steps, derivs, userData);
+
+    for(int l = 0; l < activeLanes; l++)
+    {
+      double *ys = &yout[(firstSystem + l) * n];
+
+      for(int i = 0; i < n; i++)
+        ys[i] = yp[i * W + l];
+    }
+
+    maxSteps = std::max(maxSteps, steps);
+
+    if(blockResult)
+    {
+#ifdef USE_OPENMP
+#pragma omp critical (LockstepODESolver_result)
+#endif
+      {
+        if(!result)
+          result = blockResult;
+      }
+    }
+  }
+
+  m_currentIterations = maxSteps;
+
+  return result;
+}
+
+template<int W>
+int LockstepODESolver::rk4(double *workspace, double y[], int firstSystem, double t, double dt, int *steps, ComputeLockstepDerivatives derivs, void *userData)
+{
+  int n = m_size;
+  int nw = n * W;
+  double *dydt = workspace;
+  double *dym = workspace + nw;
+  double *dyt = workspace + 2 * nw;
+  double *yt = workspace + 3 * nw;
+
+  double dtt = dt * 0.5;
+  double dt6 = dt / 6.0;
+  double tl[W], tdt[W], tend[W];
+
+  for(int l = 0; l < W; l++)
+  {
+    tl[l] = t;
+    tdt[l] = t + dtt;
+    tend[l] = t + dt;
+  }
+
+  const double one = 1.0, weights[3] = {1.0, 1.0, 2.0};
+
+  //The lanes share the step, so the packed arrays are combined as single arrays of n * W components
+  derivs(tl, y, dydt, n, firstSystem, W, userData);
+
+  ODEKernels::combine(nw, 1, y, &dtt, 1, &one, &dydt, yt, false); //First step.
+
+  derivs(tdt, yt, dyt, n, firstSystem, W, userData); //Second step.
+
+  ODEKernels::combine(nw, 1, y, &dtt, 1, &one, &dyt, yt, false);
+
+  derivs(tdt, yt, dym, n, firstSystem, W, userData); //Third step.
+
+  ODEKernels::combine(nw, 1, y, &dt, 1, &one, &dym, yt, false);
+  ODEKernels::combine(nw, 1, dym, &one, 1, &one, &dyt, dym, false);
+
+  derivs(tend, yt, dyt, n, firstSystem, W, userData); //Fourth step.
+
+  const double *increments[3] = {dydt, dyt, dym};
+  ODEKernels::combine(nw, 1, y, &dt6, 3, weights, increments, y, false);
+
+  *steps = 1;
+
+  return 0;
+}
+
+template<int W>
+int LockstepODESolver::rkqs(double *workspace, double y[], int firstSystem, double t, double dt, int *steps, ComputeLockstepDerivatives derivs, void *userData)
+{
+  int n = m_size;
+  int nw = n * W;
+  double *dydt = workspace;
+  double *yscal = workspace + nw;
+  double *ytemp = workspace + 2 * nw;
+  double *yerr = workspace + 3 * nw;
+  double t_end = t + dt;
+
+  double tl[W], dtl[W], h[W], errmax[W];
+  bool active[W], newStep[W], accept[W];
+  int laneSteps[W], laneResult[W];
+
+  for(int l = 0; l < W; l++)
+  {
+    tl[l] = t;
+    dtl[l] = dt;
+    active[l] = true;
+    newStep[l] = true;
+    laneSteps[l] = 0;
+    laneResult[l] = 0;
+  }
+
+  bool anyActive = true;
+
+  while(anyActive)
+  {
+    bool anyNewStep = false;
+
+    for(int l = 0; l < W; l++)
+      anyNewStep |= newStep[l];
+
+    // --- derivatives and error scaling for the lanes starting a new step
+    if(anyNewStep)
+    {
+      derivs(tl, y, dydt, n, firstSystem, W, userData);
+
+      for(int i = 0; i < n; i++)
+      {
+        double *ysi = &yscal[i * W];
+        const double *yi = &y[i * W];
+        const double *dydti = &dydt[i * W];
+
+#ifdef USE_OPENMP
+#pragma omp simd
+#endif
+        for(int l = 0; l < W; l++)
+          ysi[l] = newStep[l] ? fabs(yi[l]) + fabs(dydti[l] * dtl[l]) + ODE_TINY : ysi[l];
+      }
+
+      for(int l = 0; l < W; l++)
+      {
+        if (newStep[l] && ((tl[l] + dtl[l]) - t_end) * (tl[l] + dtl[l] - t) > 0.0)
+        {
+          dtl[l] = t_end - tl[l];
+        }
+      }
+    }
+
+    // --- finished lanes take a zero step
+    for(int l = 0; l < W; l++)
+    {
+      h[l] = active[l] ? dtl[l] : 0.0;
+      errmax[l] = 0.0;
+    }
+
+    rkck<W>(workspace + 2 * nw, tl, h, dydt, y, firstSystem, derivs, userData);
+
+    // --- compute scaled maximum error per lane
+    ODEKernels::maxScaledError(n, W, yerr, yscal, errmax, false);
+
+    anyActive = false;
+
+    for(int l = 0; l < W; l++)
+    {
+      accept[l] = false;
+      newStep[l] = false;
+
+      if(!active[l])
+        continue;
+
+      double err = errmax[l] / m_relTol;
+
+      // --- error too large; reduce stepsize & repeat
+      if(err > 1.0)
+      {
+        double dtTemp = m_safety * dtl[l] * pow(err, m_pshrnk);
+
+        if (dtl[l] >= 0)
+          dtl[l] = dtTemp > 0.1 * dtl[l] ? dtTemp : 0.1 * dtl[l];
+        else
+          dtl[l] = dtTemp < 0.1 * dtl[l] ? dtTemp : 0.1 * dtl[l];
+
+        if (tl[l] + dtl[l] == tl[l])
+        {
+          laneResult[l] = 2;
+          active[l] = false;
+        }
+      }
+      // --- step succeeded; compute size of next step
+      else
+      {
+        double dtNext = err > m_errcon ? m_safety * dtl[l] * pow(err, m_pgrow) : 5.0 * dtl[l];
+
+        accept[l] = true;
+        tl[l] += dtl[l];
+        laneSteps[l]++;
+
+        if((tl[l] - t_end) * (t_end - t) >= 0.0)
+        {
+          active[l] = false;
+        }
+        else if (fabs(dtNext) <= 0.0)
+        {
+          laneResult[l] = 2;
+          active[l] = false;
+        }
+        else if (laneSteps[l] >= m_maxSteps)
+        {
+          laneResult[l] = 3;
+          active[l] = false;
+        }
+        else
+        {
+          dtl[l] = dtNext;
+          newStep[l] = true;
+        }
+      }
+
+      anyActive |= active[l];
+    }
+
+    // --- masked update of the accepted lanes
+    for(int i = 0; i < n; i++)
+    {
+      double *yi = &y[i * W];
+      const double *ytempi = &ytemp[i * W];
+
+#ifdef USE_OPENMP
+#pragma omp simd
+#endif
+      for(int l = 0; l < W; l++)
+        yi[l] = accept[l] ? ytempi[l] : yi[l];
+    }
+  }
+
+  int result = 0;
+
+  for(int l = 0; l < W; l++)
+  {
+    *steps = std::max(*steps, laneSteps[l]);
+
+    if(!result)
+      result = laneResult[l];
+  }
+
+  return result;
+}
+
+template<int W>
+void LockstepODESolver::rkck(double *workspace, const double t[], const double dt[], double dydt[], double y[], int firstSystem, ComputeLockstepDerivatives derivs, void *userData)
+{
+  //Cash-Karp tableau, as in ODESolver::rkck
+  static const double a[6] = {0.0, 0.2, 0.3, 0.6, 1.0, 0.875};
+  static const double b[5][5] = {{0.2},
+                                 {3.0 / 40.0, 9.0 / 40.0},
+                                 {0.3, -0.9, 1.2},
+                                 {-11.0 / 54.0, 2.5, -70.0 / 27.0, 35.0 / 27.0},
+                                 {1631.0 / 55296.0, 175.0 / 512.0, 575.0 / 13824.0, 44275.0 / 110592.0, 253.0 / 4096.0}};
+  static const double c[4] = {37.0 / 378.0, 250.0 / 621.0, 125.0 / 594.0, 512.0 / 1771.0};
+  static const double dc[5] = {37.0 / 378.0 - 2825.0 / 27648.0, 250.0 / 621.0 - 18575.0 / 48384.0,
+                               125.0 / 594.0 - 13525.0 / 55296.0, -277.0 / 14336.0, 512.0 / 1771.0 - 0.25};
+
+  int n = m_size;
+  int nw = n * W;
+  double *ytemp = workspace;
+  double *yerr = workspace + nw;
+  double *k[6] = {dydt, workspace + 2 * nw, workspace + 3 * nw, workspace + 4 * nw, workspace + 5 * nw, workspace + 6 * nw};
+  double ts[W];
+
+  for(int s = 1; s < 6; s++)
+  {
+    ODEKernels::combine(n, W, y, dt, s, b[s - 1], k, ytemp, false);
+
+    for(int l = 0; l < W; l++) ts[l] = t[l] + a[s] * dt[l];
+    derivs(ts, ytemp, k[s], n, firstSystem, W, userData);
+  }
+
+  const double *solution[4] = {k[0], k[2], k[3], k[5]};
+  const double *error[5] = {k[0], k[2], k[3], k[4], k[5]};
+
+  ODEKernels::combine(n, W, y, dt, 4, c, solution, ytemp, false);
+  ODEKernels::combine(n, W, nullptr, dt, 5, dc, error, yerr, false);
+}
+
+int LockstepODESolver::workspaceSize() const
+{
+  return LOCKSTEP_ARRAYS * m_size * m_lanes;
+}
+
+void LockstepODESolver::clearMemory()
+{
+  if(m_workspace)
+  {
+    ODEBatchState::deallocate(m_workspace); m_workspace = nullptr;
+  }
+}
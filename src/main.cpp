@@ -1,5 +1,13 @@
 #include "stdafx.h"
 #include "test/odesolvertest.h"
+#include "test/fixedodesolvertest.h"
+#include "test/lockstepodesolvertest.h"
+#include "test/odeoutputsinktest.h"
+#include "test/typedodesolvertest.h"
+#include "test/odesparsitytest.h"
+#include "test/odepararealtest.h"
+#include "test/odeensembletest.h"
+#include "test/odeautotunertest.h"
 
 int main(int argc, char** argv)
 {
@@ -14,5 +22,53 @@ int main(int argc, char** argv)
     status |= QTest::qExec(&odeSolverTest, argc, argv);
   }
 
+  //Test Two
+  {
+    FixedODESolverTest fixedODESolverTest;
+    status |= QTest::qExec(&fixedODESolverTest, argc, argv);
+  }
+
+  //Test Three
+  {
+    LockstepODESolverTest lockstepODESolverTest;
+    status |= QTest::qExec(&lockstepODESolverTest, argc, argv);
+  }
+
+  //Test Four
+  {
+    ODEOutputSinkTest odeOutputSinkTest;
+    status |= QTest::qExec(&odeOutputSinkTest, argc, argv);
+  }
+
+  //Test Five
+  {
+    TypedODESolverTest typedODESolverTest;
+    status |= QTest::qExec(&typedODESolverTest, argc, argv);
+  }
+
+  //Test Six
+  {
+    ODESparsityTest odeSparsityTest;
+    status |= QTest::qExec(&odeSparsityTest, argc, argv);
+  }
+
+  //Test Seven
+  {
+    ODEPararealTest odePararealTest;
+    status |= QTest::qExec(&odePararealTest, argc, argv);
+  }
+
+  //Test Eight
+  {
+    ODEEnsembleTest odeEnsembleTest;
+    status |= QTest::qExec(&odeEnsembleTest, argc, argv);
+  }
+
+  //Test Nine
+  {
+    ODEAutotunerTest odeAutotunerTest;
+    status |= QTest::qExec(&odeAutotunerTest, argc, argv);
+  }
+
   return status;
 }
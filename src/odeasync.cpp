@@ -0,0 +1,197 @@
+/*!
+ *  \file    odeasync.cpp
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#include "stdafx.h"
+#include "odeasync.h"
+
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+
+ODESolveHandle::ODESolveHandle(double t, double dt)
+  : m_t(t),
+    m_dt(dt),
+    m_currentTime(t),
+    m_cancel(false),
+    m_status(-1),
+    m_finished(false)
+{
+}
+
+bool ODESolveHandle::isFinished() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_finished;
+}
+
+int ODESolveHandle::wait() const
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_finishedCondition.wait(lock, [this]{ return m_finished; });
+
+  return m_status;
+}
+
+bool ODESolveHandle::waitFor(double seconds) const
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  return m_finishedCondition.wait_for(lock, std::chrono::duration<double>(seconds), [this]{ return m_finished; });
+}
+
+int ODESolveHandle::status() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_status;
+}
+
+void ODESolveHandle::cancel()
+{
+  m_cancel = true;
+}
+
+bool ODESolveHandle::cancelRequested() const
+{
+  return m_cancel;
+}
+
+double ODESolveHandle::currentTime() const
+{
+  return m_currentTime;
+}
+
+double ODESolveHandle::progress() const
+{
+  if(m_dt == 0.0)
+    return isFinished() ? 1.0 : 0.0;
+
+  return std::min(std::max((m_currentTime - m_t) / m_dt, 0.0), 1.0);
+}
+
+void ODESolveHandle::setCurrentTime(double t)
+{
+  m_currentTime = t;
+}
+
+bool ODESolveHandle::setContinuation(const std::function<void()> &task)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if(m_finished)
+    return false;
+
+  m_continuation = task;
+
+  return true;
+}
+
+void ODESolveHandle::finish(int status)
+{
+  if(status == 0)
+    m_currentTime = m_t + m_dt;
+
+  std::function<void()> continuation;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_status = status;
+    m_finished = true;
+    continuation.swap(m_continuation);
+  }
+
+  m_finishedCondition.notify_all();
+
+  if(continuation)
+    ODEThreadPool::instance().submit(continuation);
+}
+
+ODEThreadPool &ODEThreadPool::instance()
+{
+  static ODEThreadPool pool;
+  return pool;
+}
+
+ODEThreadPool::ODEThreadPool()
+  : m_threads(std::max(1, static_cast<int>(std::thread::hardware_concurrency()))),
+    m_idle(0),
+    m_stop(false)
+{
+}
+
+ODEThreadPool::~ODEThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+
+  m_taskCondition.notify_all();
+
+  for(std::thread &worker : m_workers)
+    worker.join();
+}
+
+int ODEThreadPool::threads() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_threads;
+}
+
+void ODEThreadPool::setThreads(int threads)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_threads = std::max(1, threads);
+}
+
+void ODEThreadPool::submit(const std::function<void()> &task)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push_back(task);
+
+    //Start a worker when none is free to take the task
+    if(m_idle < static_cast<int>(m_tasks.size()) && static_cast<int>(m_workers.size()) < m_threads)
+      m_workers.push_back(std::thread(&ODEThreadPool::work, this));
+  }
+
+  m_taskCondition.notify_one();
+}
+
+void ODEThreadPool::work()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  for(;;)
+  {
+    m_idle++;
+    m_taskCondition.wait(lock, [this]{ return m_stop || !m_tasks.empty(); });
+    m_idle--;
+
+    //Queued tasks are finished before the pool shuts down
+    if(m_tasks.empty())
+      return;
+
+    std::function<void()> task = m_tasks.front();
+    m_tasks.pop_front();
+
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+}
@@ -0,0 +1,453 @@
+/*!
+ *  \file    odeautotuner.cpp
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#include "stdafx.h"
+#include "odeautotuner.h"
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+
+#define ODEAUTOTUNER_CACHE_VERSION 1
+
+ODEAutotunerResult::ODEAutotunerResult()
+  : solverType(ODESolver::RKQS),
+    iterationMethod(ODESolver::NEWTON),
+    linearSolverType(ODESolver::GMRES),
+    status(0),
+    abandoned(false),
+    error(HUGE_VAL),
+    time(HUGE_VAL),
+    derivativeEvaluations(0)
+{
+}
+
+bool ODEAutotunerResult::meetsTolerance() const
+{
+  return status == 0 && !abandoned && error <= 1.0;
+}
+
+ODEAutotuner::ODEAutotuner(const ODESolver &configuration)
+  : m_configuration(configuration.clone()),
+    m_best(-1),
+    m_solveCalls(100),
+    m_repeats(3),
+    m_relTol(configuration.relativeTolerance()),
+    m_absTol(configuration.absoluteTolerance()),
+    m_referenceFactor(1e-3),
+    m_referenceSolverType(ODESolver::RKQS),
+    m_fromCache(false)
+{
+}
+
+ODEAutotuner::~ODEAutotuner()
+{
+  delete m_configuration;
+}
+
+void ODEAutotuner::addCandidate(ODESolver::SolverType solverType, ODESolver::IterationMethod iterationMethod,
+                                ODESolver::LinearSolverType linearSolverType)
+{
+  ODEAutotunerResult candidate;
+  candidate.solverType = solverType;
+  candidate.iterationMethod = iterationMethod;
+  candidate.linearSolverType = linearSolverType;
+  m_candidates.push_back(candidate);
+}
+
+void ODEAutotuner::addDefaultCandidates()
+{
+  //Adaptive solvers first, so the fixed step ones can be stopped early once they are slower
+  addCandidate(ODESolver::RKQS);
+  addCandidate(ODESolver::LSRK45);
+  addCandidate(ODESolver::ADAMS);
+  addCandidate(ODESolver::GBS);
+  addCandidate(ODESolver::RKC);
+  addCandidate(ODESolver::EXPRB32);
+
+  if(m_configuration->linearOperator())
+    addCandidate(ODESolver::EXPRK2);
+
+#ifdef USE_CVODE
+  ODESolver::SolverType cvodeTypes[2] = {ODESolver::CVODE_ADAMS, ODESolver::CVODE_BDF};
+  ODESolver::LinearSolverType linearSolverTypes[5] = {ODESolver::GMRES, ODESolver::FGMRES, ODESolver::Bi_CGStab,
+                                                      ODESolver::TFQMR, ODESolver::PCG};
+
+  for(int i = 0; i < 2; i++)
+  {
+    addCandidate(cvodeTypes[i], ODESolver::FUNCTIONAL);
+
+    for(int j = 0; j < 5; j++)
+      addCandidate(cvodeTypes[i], ODESolver::NEWTON, linearSolverTypes[j]);
+  }
+#endif
+
+  addCandidate(ODESolver::RK4);
+  addCandidate(ODESolver::LSRK4);
+  addCandidate(ODESolver::EULER);
+}
+
+void ODEAutotuner::clearCandidates()
+{
+  m_candidates.clear();
+}
+
+int ODEAutotuner::candidateCount() const
+{
+  return static_cast<int>(m_candidates.size());
+}
+
+int ODEAutotuner::solveCalls() const
+{
+  return m_solveCalls;
+}
+
+void ODEAutotuner::setSolveCalls(int calls)
+{
+  m_solveCalls = std::max(1, calls);
+}
+
+int ODEAutotuner::repeats() const
+{
+  return m_repeats;
+}
+
+void ODEAutotuner::setRepeats(int repeats)
+{
+  m_repeats = std::max(1, repeats);
+}
+
+double ODEAutotuner::relativeTolerance() const
+{
+  return m_relTol;
+}
+
+double ODEAutotuner::absoluteTolerance() const
+{
+  return m_absTol;
+}
+
+void ODEAutotuner::setTolerance(double relativeTolerance, double absoluteTolerance)
+{
+  m_relTol = relativeTolerance;
+  m_absTol = absoluteTolerance;
+}
+
+ODESolver::SolverType ODEAutotuner::referenceSolverType() const
+{
+  return m_referenceSolverType;
+}
+
+void ODEAutotuner::setReferenceSolverType(ODESolver::SolverType solverType)
+{
+  m_referenceSolverType = solverType;
+}
+
+double ODEAutotuner::referenceFactor() const
+{
+  return m_referenceFactor;
+}
+
+void ODEAutotuner::setReferenceFactor(double factor)
+{
+  m_referenceFactor = factor;
+}
+
+QString ODEAutotuner::cacheFile() const
+{
+  return m_cacheFile;
+}
+
+void ODEAutotuner::setCacheFile(const QString &filePath)
+{
+  m_cacheFile = filePath;
+}
+
+int ODEAutotuner::tune(const double y[], int n, double t, double dt, ComputeDerivatives derivs, void *userData,
+                       const QString &problem)
+{
+  m_results.clear();
+  m_best = -1;
+  m_fromCache = false;
+
+  if(n != m_configuration->size())
+    return 1;
+
+  QString key = problem.isEmpty() || m_cacheFile.isEmpty() ? QString() : signature(problem, n);
+
+  if(!key.isEmpty() && readCache(key))
+  {
+    m_fromCache = true;
+    return 0;
+  }
+
+  std::vector<double> reference(n), yout(n);
+
+  ODESolver *referenceSolver = m_configuration->clone();
+  referenceSolver->setSolverType(m_referenceSolverType);
+  referenceSolver->setRelativeTolerance(m_configuration->relativeTolerance() * m_referenceFactor);
+  referenceSolver->setAbsoluteTolerance(m_configuration->absoluteTolerance() * m_referenceFactor);
+  referenceSolver->initialize();
+
+  double referenceTime = 0.0;
+  int status = run(referenceSolver, y, n, t, dt, reference.data(), derivs, userData, HUGE_VAL, &referenceTime);
+
+  delete referenceSolver;
+
+  if(status)
+    return status;
+
+  double bestTime = HUGE_VAL;
+
+  for(size_t c = 0; c < m_candidates.size(); c++)
+  {
+    ODEAutotunerResult result = m_candidates[c];
+
+    for(int r = 0; r < m_repeats; r++)
+    {
+      ODESolver *solver = createCandidate(result);
+      solver->setCollectStatistics(true);
+
+      //Only the first run is cut short; later ones are timed in full for the minimum
+      double time = 0.0;
+      status = run(solver, y, n, t, dt, yout.data(), derivs, userData, r ? HUGE_VAL : bestTime, &time);
+
+      if(r == 0)
+        result.derivativeEvaluations = solver->statistics().derivativeEvaluations;
+
+      delete solver;
+
+      if(status < 0)
+      {
+        result.abandoned = true;
+        break;
+      }
+      else if(status)
+      {
+        result.status = status;
+        break;
+      }
+
+      result.time = std::min(result.time, time);
+
+      if(r == 0)
+      {
+        result.error = 0.0;
+
+        for(int i = 0; i < n; i++)
+        {
+          double e = fabs(yout[i] - reference[i]) / (m_absTol + m_relTol * fabs(reference[i]));
+
+          //NaN compares false and would otherwise pass
+          result.error = std::max(result.error, e == e ? e : HUGE_VAL);
+        }
+
+        if(result.error > 1.0)
+          break;
+      }
+    }
+
+    if(result.meetsTolerance() && result.time < bestTime)
+    {
+      bestTime = result.time;
+      m_best = static_cast<int>(m_results.size());
+    }
+
+    m_results.push_back(result);
+  }
+
+  if(m_best < 0)
+    return 1;
+
+  if(!key.isEmpty())
+    writeCache(key);
+
+  return 0;
+}
+
+const std::vector<ODEAutotunerResult> &ODEAutotuner::results() const
+{
+  return m_results;
+}
+
+const ODEAutotunerResult &ODEAutotuner::best() const
+{
+  return m_results[m_best];
+}
+
+bool ODEAutotuner::fromCache() const
+{
+  return m_fromCache;
+}
+
+ODESolver *ODEAutotuner::createSolver() const
+{
+  return createCandidate(best());
+}
+
+QString ODEAutotuner::signature(const QString &problem, int n) const
+{
+#ifdef USE_OPENMP
+  int threads = omp_get_max_threads();
+#else
+  int threads = 1;
+#endif
+
+  return QString("%1/n=%2/rtol=%3/atol=%4/threads=%5").arg(problem).arg(n).arg(m_relTol).arg(m_absTol).arg(threads);
+}
+
+ODESolver *ODEAutotuner::createCandidate(const ODEAutotunerResult &result) const
+{
+  ODESolver *solver = m_configuration->clone();
+  solver->setSolverType(result.solverType);
+  solver->setSolverIterationMethod(result.iterationMethod);
+  solver->setLinearSolverType(result.linearSolverType);
+  solver->initialize();
+
+  return solver;
+}
+
+int ODEAutotuner::run(ODESolver *solver, const double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs,
+                      void *userData, double timeLimit, double *time) const
+{
+  std::vector<double> ycurrent(y, y + n);
+  double h = dt / m_solveCalls;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  for(int c = 0; c < m_solveCalls; c++)
+  {
+    int status = solver->solve(ycurrent.data(), n, t + c * h, h, yout, derivs, userData);
+
+    *time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if(status)
+      return status;
+
+    if(*time > timeLimit)
+      return -1;
+
+    std::copy(yout, yout + n, ycurrent.begin());
+  }
+
+  return 0;
+}
+
+bool ODEAutotuner::readCache(const QString &key)
+{
+  QFile file(m_cacheFile);
+
+  if(!file.open(QIODevice::ReadOnly))
+    return false;
+
+  QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+  file.close();
+
+  QJsonObject root = document.object();
+
+  if(root.value("version").toInt() != ODEAUTOTUNER_CACHE_VERSION)
+    return false;
+
+  QJsonObject entry = root.value("configurations").toObject().value(key).toObject();
+
+  if(entry.isEmpty())
+    return false;
+
+  //Entries written by a build with other solvers are ignored
+  int solverType = entry.value("solverType").toInt(-1);
+
+#ifdef USE_CVODE
+  if(solverType < ODESolver::EULER || solverType > ODESolver::EXPRB32)
+#else
+  if(solverType < ODESolver::EULER || solverType > ODESolver::EXPRB32 || solverType == 3 || solverType == 4)
+#endif
+    return false;
+
+  ODEAutotunerResult result;
+  result.solverType = static_cast<ODESolver::SolverType>(solverType);
+  result.iterationMethod = static_cast<ODESolver::IterationMethod>(entry.value("iterationMethod").toInt(ODESolver::NEWTON));
+  result.linearSolverType = static_cast<ODESolver::LinearSolverType>(entry.value("linearSolverType").toInt(ODESolver::GMRES));
+  result.error = entry.value("error").toDouble();
+  result.time = entry.value("time").toDouble();
+  result.derivativeEvaluations = static_cast<long long>(entry.value("derivativeEvaluations").toDouble());
+
+  m_results.push_back(result);
+  m_best = 0;
+
+  return true;
+}
+
+bool ODEAutotuner::writeCache(const QString &key) const
+{
+  QJsonObject root;
+  QFile file(m_cacheFile);
+
+  if(file.open(QIODevice::ReadOnly))
+  {
+    root = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+  }
+
+  if(root.value("version").toInt() != ODEAUTOTUNER_CACHE_VERSION)
+    root = QJsonObject();
+
+  const ODEAutotunerResult &result = best();
+  QJsonObject entry;
+  entry.insert("solverType", static_cast<int>(result.solverType));
+  entry.insert("iterationMethod", static_cast<int>(result.iterationMethod));
+  entry.insert("linearSolverType", static_cast<int>(result.linearSolverType));
+  entry.insert("error", result.error);
+  entry.insert("time", result.time);
+  entry.insert("derivativeEvaluations", static_cast<double>(result.derivativeEvaluations));
+
+  QJsonObject configurations = root.value("configurations").toObject();
+  configurations.insert(key, entry);
+  root.insert("version", ODEAUTOTUNER_CACHE_VERSION);
+  root.insert("configurations", configurations);
+
+  //QSaveFile writes a temporary file and renames it over the cache on commit, so an interrupted write leaves the
+  //previous cache intact
+  QSaveFile saveFile(m_cacheFile);
+
+  if(!saveFile.open(QIODevice::WriteOnly))
+  {
+    fprintf(stderr, "Could not write autotuner cache %s\n", m_cacheFile.toStdString().c_str());
+    return false;
+  }
+
+  saveFile.write(QJsonDocument(root).toJson());
+
+  if(!saveFile.commit())
+  {
+    fprintf(stderr, "Could not replace autotuner cache %s\n", m_cacheFile.toStdString().c_str());
+    return false;
+  }
+
+  return true;
+}
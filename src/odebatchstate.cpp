@@ -0,0 +1,257 @@
+/*!
+ *  \file    odebatchstate.cpp
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#include "stdafx.h"
+#include "odebatchstate.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <stdlib.h>
+#endif
+
+#include <string.h>
+#include <algorithm>
+#include <new>
+
+ODEBatchState::ODEBatchState(int size, int numSystems, int lanes)
+  : m_size(size),
+    m_numSystems(numSystems),
+    m_lanes(lanes >= 8 ? 8 : 4),
+    m_numBlocks(0),
+    m_blockStride(0),
+    m_data(nullptr)
+{
+  allocateBlocks();
+}
+
+ODEBatchState::ODEBatchState(const ODEBatchState &other)
+  : m_size(other.m_size),
+    m_numSystems(other.m_numSystems),
+    m_lanes(other.m_lanes),
+    m_numBlocks(0),
+    m_blockStride(0),
+    m_data(nullptr)
+{
+  allocateBlocks();
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for(int b = 0; b < m_numBlocks; b++)
+  {
+    memcpy(block(b), other.block(b), m_blockStride * sizeof(double));
+  }
+}
+
+ODEBatchState::~ODEBatchState()
+{
+  deallocate(m_data);
+}
+
+ODEBatchState &ODEBatchState::operator=(const ODEBatchState &other)
+{
+  if(this != &other)
+  {
+    if(m_size != other.m_size || m_numSystems != other.m_numSystems || m_lanes != other.m_lanes)
+    {
+      deallocate(m_data);
+      m_size = other.m_size;
+      m_numSystems = other.m_numSystems;
+      m_lanes = other.m_lanes;
+      allocateBlocks();
+    }
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for(int b = 0; b < m_numBlocks; b++)
+    {
+      memcpy(block(b), other.block(b), m_blockStride * sizeof(double));
+    }
+  }
+
+  return *this;
+}
+
+int ODEBatchState::size() const
+{
+  return m_size;
+}
+
+int ODEBatchState::numSystems() const
+{
+  return m_numSystems;
+}
+
+int ODEBatchState::lanes() const
+{
+  return m_lanes;
+}
+
+int ODEBatchState::numBlocks() const
+{
+  return m_numBlocks;
+}
+
+size_t ODEBatchState::blockStride() const
+{
+  return m_blockStride;
+}
+
+double *ODEBatchState::block(int b)
+{
+  return m_data + b * m_blockStride;
+}
+
+const double *ODEBatchState::block(int b) const
+{
+  return m_data + b * m_blockStride;
+}
+
+double &ODEBatchState::value(int system, int component)
+{
+  return block(system / m_lanes)[component * m_lanes + system % m_lanes];
+}
+
+double ODEBatchState::value(int system, int component) const
+{
+  return block(system / m_lanes)[component * m_lanes + system % m_lanes];
+}
+
+void ODEBatchState::setSystem(int system, const double y[])
+{
+  double *values = block(system / m_lanes) + system % m_lanes;
+
+  for(int i = 0; i < m_size; i++)
+    values[i * m_lanes] = y[i];
+}
+
+void ODEBatchState::system(int system, double y[]) const
+{
+  const double *values = block(system / m_lanes) + system % m_lanes;
+
+  for(int i = 0; i < m_size; i++)
+    y[i] = values[i * m_lanes];
+}
+
+void ODEBatchState::setSystems(const double y[])
+{
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for(int b = 0; b < m_numBlocks; b++)
+  {
+    double *values = block(b);
+    int firstSystem = b * m_lanes;
+    int activeLanes = std::min(m_lanes, m_numSystems - firstSystem);
+
+    for(int l = 0; l < m_lanes; l++)
+    {
+      const double *ys = &y[(firstSystem + std::min(l, activeLanes - 1)) * static_cast<size_t>(m_size)];
+
+      for(int i = 0; i < m_size; i++)
+        values[i * m_lanes + l] = ys[i];
+    }
+  }
+}
+
+void ODEBatchState::systems(double y[]) const
+{
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for(int b = 0; b < m_numBlocks; b++)
+  {
+    const double *values = block(b);
+    int firstSystem = b * m_lanes;
+    int activeLanes = std::min(m_lanes, m_numSystems - firstSystem);
+
+    for(int l = 0; l < activeLanes; l++)
+    {
+      double *ys = &y[(firstSystem + l) * static_cast<size_t>(m_size)];
+
+      for(int i = 0; i < m_size; i++)
+        ys[i] = values[i * m_lanes + l];
+    }
+  }
+}
+
+void ODEBatchState::pad()
+{
+  if(m_numSystems <= 0)
+    return;
+
+  double *values = block(m_numBlocks - 1);
+  int last = (m_numSystems - 1) % m_lanes;
+
+  for(int l = last + 1; l < m_lanes; l++)
+  {
+    for(int i = 0; i < m_size; i++)
+      values[i * m_lanes + l] = values[i * m_lanes + last];
+  }
+}
+
+double *ODEBatchState::allocate(size_t count)
+{
+  void *data = nullptr;
+  size_t bytes = std::max(count, static_cast<size_t>(1)) * sizeof(double);
+
+#ifdef _WIN32
+  data = _aligned_malloc(bytes, ODE_BATCH_ALIGNMENT);
+#else
+  if(posix_memalign(&data, ODE_BATCH_ALIGNMENT, bytes))
+    data = nullptr;
+#endif
+
+  if(!data)
+    throw std::bad_alloc();
+
+  return static_cast<double*>(data);
+}
+
+void ODEBatchState::deallocate(double *data)
+{
+  if(data)
+  {
+#ifdef _WIN32
+    _aligned_free(data);
+#else
+    free(data);
+#endif
+  }
+}
+
+void ODEBatchState::allocateBlocks()
+{
+  const size_t alignDoubles = ODE_BATCH_ALIGNMENT / sizeof(double);
+
+  m_numBlocks = (m_numSystems + m_lanes - 1) / m_lanes;
+  m_blockStride = (static_cast<size_t>(m_size) * m_lanes + alignDoubles - 1) / alignDoubles * alignDoubles;
+  m_data = allocate(m_numBlocks * m_blockStride);
+
+  //First touch by the thread that integrates each block
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for(int b = 0; b < m_numBlocks; b++)
+  {
+    memset(block(b), 0, m_blockStride * sizeof(double));
+  }
+}
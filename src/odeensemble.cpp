@@ -0,0 +1,252 @@
+/*!
+ *  \file    odeensemble.cpp
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#include "stdafx.h"
+#include "odeensemble.h"
+#include "lockstepodesolver.h"
+
+#if defined(USE_OPENMP)
+#include <omp.h>
+#endif
+
+#include <algorithm>
+
+/*!
+ * \brief The EnsembleRedirectionData struct binds the parameters of one member to the ensemble right-hand side.
+ */
+struct EnsembleRedirectionData
+{
+    ComputeEnsembleDerivatives deriv;
+    ComputeEnsembleLockstepDerivatives lockstepDeriv;
+    const double *parameters;
+    int numParameters;
+    void *userData;
+};
+
+ODEEnsemble::ODEEnsemble(const ODESolver &configuration, int numParameters)
+  : m_configuration(configuration.clone()),
+    m_lockstepSolver(nullptr),
+    m_size(configuration.size()),
+    m_numParameters(numParameters),
+    m_lanes(8)
+{
+}
+
+ODEEnsemble::~ODEEnsemble()
+{
+  clearMemory();
+  delete m_configuration;
+}
+
+void ODEEnsemble::initialize()
+{
+  clearMemory();
+
+#ifdef USE_OPENMP
+  int numThreads = omp_get_max_threads();
+#else
+  int numThreads = 1;
+#endif
+
+  for(int i = 0; i < numThreads; i++)
+  {
+    ODESolver *solver = m_configuration->clone();
+    solver->initialize();
+    m_solvers.push_back(solver);
+  }
+
+  m_initial.assign(static_cast<size_t>(numThreads) * m_size, 0.0);
+
+  if(m_configuration->solverType() == ODESolver::RK4 || m_configuration->solverType() == ODESolver::RKQS)
+  {
+    m_lockstepSolver = new LockstepODESolver(m_size, m_lanes, m_configuration->solverType() == ODESolver::RKQS ?
+                                                                LockstepODESolver::RKQS : LockstepODESolver::RK4);
+    m_lockstepSolver->setRelativeTolerance(m_configuration->relativeTolerance());
+    m_lockstepSolver->setMaxIterations(m_configuration->maxIterations());
+    m_lockstepSolver->initialize();
+  }
+}
+
+int ODEEnsemble::size() const
+{
+  return m_size;
+}
+
+int ODEEnsemble::numParameters() const
+{
+  return m_numParameters;
+}
+
+int ODEEnsemble::lanes() const
+{
+  return m_lanes;
+}
+
+void ODEEnsemble::setLanes(int lanes)
+{
+  m_lanes = lanes >= 8 ? 8 : 4;
+}
+
+int ODEEnsemble::solve(int members, const double y0[], const double parameters[], double t, double dt, int numOutputs, double output[],
+                       ComputeEnsembleDerivatives derivs, void *userData)
+{
+  const int n = m_size;
+  const size_t stride = static_cast<size_t>(members) * n;
+
+  m_memberStatus.assign(members, 0);
+
+  //Members differ in cost so they are handed out one at a time rather than in equal shares
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for(int m = 0; m < members; m++)
+  {
+#ifdef USE_OPENMP
+    int thread = omp_get_thread_num();
+#else
+    int thread = 0;
+#endif
+
+    ODESolver *solver = m_solvers[thread];
+    double *y = &m_initial[static_cast<size_t>(thread) * n];
+    std::copy(y0 + static_cast<size_t>(m) * n, y0 + static_cast<size_t>(m + 1) * n, y);
+
+    EnsembleRedirectionData redirectData;
+    redirectData.deriv = derivs;
+    redirectData.lockstepDeriv = nullptr;
+    redirectData.parameters = parameters + static_cast<size_t>(m) * m_numParameters;
+    redirectData.numParameters = m_numParameters;
+    redirectData.userData = userData;
+
+    for(int k = 0; k < numOutputs; k++)
+    {
+      double *yout = output + k * stride + static_cast<size_t>(m) * n;
+      int status = solver->solve(y, n, t + k * dt, dt, yout, &ODEEnsemble::computeDerivatives, &redirectData);
+
+      if(status)
+      {
+        m_memberStatus[m] = status;
+        break;
+      }
+
+      y = yout;
+    }
+  }
+
+  for(int status : m_memberStatus)
+  {
+    if(status)
+      return status;
+  }
+
+  return 0;
+}
+
+int ODEEnsemble::solve(int members, const double y0[], const double parameters[], double t, double dt, int numOutputs, double output[],
+                       ComputeEnsembleLockstepDerivatives derivs, void *userData)
+{
+  if(!m_lockstepSolver)
+    return 1;
+
+  const int n = m_size;
+  const int lanes = m_lockstepSolver->lanes();
+  const int numBlocks = (members + lanes - 1) / lanes;
+  const size_t stride = static_cast<size_t>(members) * n;
+
+  //Interleave the parameters of each block like the packed state, padding with the last member
+  m_lockstepParameters.resize(static_cast<size_t>(numBlocks) * m_numParameters * lanes);
+
+  for(int b = 0; b < numBlocks; b++)
+  {
+    double *blockParameters = &m_lockstepParameters[static_cast<size_t>(b) * m_numParameters * lanes];
+
+    for(int l = 0; l < lanes; l++)
+    {
+      int m = std::min(b * lanes + l, members - 1);
+
+      for(int j = 0; j < m_numParameters; j++)
+        blockParameters[j * lanes + l] = parameters[static_cast<size_t>(m) * m_numParameters + j];
+    }
+  }
+
+  EnsembleRedirectionData redirectData;
+  redirectData.deriv = nullptr;
+  redirectData.lockstepDeriv = derivs;
+  redirectData.parameters = m_lockstepParameters.data();
+  redirectData.numParameters = m_numParameters;
+  redirectData.userData = userData;
+
+  const double *y = y0;
+
+  for(int k = 0; k < numOutputs; k++)
+  {
+    double *yout = output + k * stride;
+
+    //The lockstep solver packs its input before writing yout so the constant initial conditions are only read
+    int status = m_lockstepSolver->solve(const_cast<double*>(y), members, t + k * dt, dt, yout,
+                                         &ODEEnsemble::computeLockstepDerivatives, &redirectData);
+
+    if(status)
+      return status;
+
+    y = yout;
+  }
+
+  return 0;
+}
+
+const std::vector<int> &ODEEnsemble::memberStatus() const
+{
+  return m_memberStatus;
+}
+
+ODESolverStatistics ODEEnsemble::statistics() const
+{
+  ODESolverStatistics statistics;
+
+  for(ODESolver *solver : m_solvers)
+    statistics.accumulate(solver->statistics());
+
+  return statistics;
+}
+
+void ODEEnsemble::computeDerivatives(double t, double y[], double dydt[], void *userData)
+{
+  EnsembleRedirectionData *redirectData = static_cast<EnsembleRedirectionData*>(userData);
+  redirectData->deriv(t, y, dydt, redirectData->parameters, redirectData->userData);
+}
+
+void ODEEnsemble::computeLockstepDerivatives(const double t[], double y[], double dydt[], int n, int firstSystem, int lanes, void *userData)
+{
+  EnsembleRedirectionData *redirectData = static_cast<EnsembleRedirectionData*>(userData);
+  const double *parameters = redirectData->parameters + static_cast<size_t>(firstSystem / lanes) * redirectData->numParameters * lanes;
+
+  redirectData->lockstepDeriv(t, y, dydt, n, parameters, lanes, redirectData->userData);
+}
+
+void ODEEnsemble::clearMemory()
+{
+  for(ODESolver *solver : m_solvers)
+    delete solver;
+
+  m_solvers.clear();
+
+  delete m_lockstepSolver;
+  m_lockstepSolver = nullptr;
+}
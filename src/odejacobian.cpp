@@ -0,0 +1,470 @@
+/*!
+ *  \file    odejacobian.cpp
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#include "stdafx.h"
+#include "odejacobian.h"
+
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+
+ODEJacobian::ODEJacobian(const ODESparsityPattern &pattern)
+  : m_numColours(0),
+    m_perturbationFloor(1.0),
+    m_maxAge(50),
+    m_maxGammaChange(0.3),
+    m_maxLinearIterationRate(4.0),
+    m_evaluated(false),
+    m_factored(false),
+    m_factorGamma(0.0),
+    m_evaluationSteps(0),
+    m_evaluationNewtonIterations(0),
+    m_evaluationLinearIterations(0),
+    m_sparse(nullptr),
+    m_evaluations(0),
+    m_derivativeEvaluations(0),
+    m_factorizations(0),
+    m_jacobianReuses(0),
+    m_factorizationReuses(0)
+{
+  const int n = pattern.size();
+  const std::vector<int> &offsets = pattern.rowOffsets();
+  const std::vector<int> &columns = pattern.columns();
+
+  std::vector<int> rowOffsets(n + 1, 0), sortedColumns;
+  sortedColumns.reserve(columns.size() + n);
+
+  //The factorization of I - gamma J needs the diagonal and sorted rows
+  for(int i = 0; i < n; i++)
+  {
+    std::vector<int> row(columns.begin() + offsets[i], columns.begin() + offsets[i + 1]);
+    row.push_back(i);
+    std::sort(row.begin(), row.end());
+    row.erase(std::unique(row.begin(), row.end()), row.end());
+
+    sortedColumns.insert(sortedColumns.end(), row.begin(), row.end());
+    rowOffsets[i + 1] = static_cast<int>(sortedColumns.size());
+  }
+
+  m_pattern = ODESparsityPattern(n, rowOffsets, sortedColumns);
+
+  m_diagonal.resize(n);
+  m_columnOffsets.assign(n + 1, 0);
+  m_columnRows.resize(sortedColumns.size());
+  m_columnEntries.resize(sortedColumns.size());
+
+  for(int column : sortedColumns)
+    m_columnOffsets[column + 1]++;
+
+  for(int j = 0; j < n; j++)
+    m_columnOffsets[j + 1] += m_columnOffsets[j];
+
+  std::vector<int> next(m_columnOffsets.begin(), m_columnOffsets.end() - 1);
+
+  for(int i = 0; i < n; i++)
+  {
+    for(int k = rowOffsets[i]; k < rowOffsets[i + 1]; k++)
+    {
+      int j = sortedColumns[k];
+      m_columnRows[next[j]] = i;
+      m_columnEntries[next[j]++] = k;
+
+      if(j == i)
+        m_diagonal[i] = k;
+    }
+  }
+
+  m_values.assign(sortedColumns.size(), 0.0);
+  m_factor.assign(sortedColumns.size(), 0.0);
+  m_positions.assign(n, -1);
+  m_yPerturbed.resize(n);
+  m_dydt.resize(n);
+  m_dydtPerturbed.resize(n);
+  m_increments.resize(n);
+
+  colourColumns();
+}
+
+const ODESparsityPattern &ODEJacobian::pattern() const
+{
+  return m_pattern;
+}
+
+int ODEJacobian::size() const
+{
+  return m_pattern.size();
+}
+
+int ODEJacobian::numColours() const
+{
+  return m_numColours;
+}
+
+const std::vector<int> &ODEJacobian::colours() const
+{
+  return m_colours;
+}
+
+double ODEJacobian::perturbationFloor() const
+{
+  return m_perturbationFloor;
+}
+
+void ODEJacobian::setPerturbationFloor(double floor)
+{
+  m_perturbationFloor = floor;
+}
+
+void ODEJacobian::setSparseDerivatives(ODESparseDerivatives *sparse)
+{
+  m_sparse = sparse;
+}
+
+void ODEJacobian::evaluate(double t, const double y[], const double dydt[], ComputeDerivatives derivs, void *userData)
+{
+  const int n = m_pattern.size();
+  const double srur = sqrt(DBL_EPSILON);
+  double *yPerturbed = m_yPerturbed.data(), *dydtPerturbed = m_dydtPerturbed.data(), *increments = m_increments.data();
+
+  std::copy(y, y + n, yPerturbed);
+
+  if(!dydt)
+  {
+    if(m_sparse)
+      m_sparse->evaluate(t, yPerturbed, m_dydt.data());
+    else
+      derivs(t, yPerturbed, m_dydt.data(), userData);
+
+    m_derivativeEvaluations++;
+    dydt = m_dydt.data();
+  }
+
+  for(int c = 0; c < m_numColours; c++)
+  {
+    const int *columns = m_colourColumns.data() + m_colourOffsets[c];
+    int count = m_colourOffsets[c + 1] - m_colourOffsets[c];
+
+    for(int k = 0; k < count; k++)
+    {
+      int j = columns[k];
+      yPerturbed[j] = y[j] + srur * std::max(fabs(y[j]), m_perturbationFloor);
+
+      //Difference of the representable values so the quotient uses the increment actually applied
+      increments[j] = yPerturbed[j] - y[j];
+    }
+
+    if(m_sparse)
+    {
+      //Rows of the colour from this pattern rather than the sparse one, which may lack the added diagonal
+      m_affected.clear();
+
+      for(int k = 0; k < count; k++)
+      {
+        for(int e = m_columnOffsets[columns[k]]; e < m_columnOffsets[columns[k] + 1]; e++)
+        {
+          int i = m_columnRows[e];
+
+          if(m_positions[i] < 0)
+          {
+            m_positions[i] = 0;
+            m_affected.push_back(i);
+          }
+        }
+      }
+
+      for(int i : m_affected)
+        m_positions[i] = -1;
+
+      m_sparse->evaluateComponents(t, yPerturbed, dydtPerturbed, m_affected.data(), static_cast<int>(m_affected.size()));
+    }
+    else
+    {
+      derivs(t, yPerturbed, dydtPerturbed, userData);
+    }
+
+    m_derivativeEvaluations++;
+
+    //Columns of one colour share no row so their entries are written independently
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for(int k = 0; k < count; k++)
+    {
+      int j = columns[k];
+
+      for(int e = m_columnOffsets[j]; e < m_columnOffsets[j + 1]; e++)
+      {
+        int i = m_columnRows[e];
+        m_values[m_columnEntries[e]] = (dydtPerturbed[i] - dydt[i]) / increments[j];
+      }
+
+      yPerturbed[j] = y[j];
+    }
+  }
+
+  m_evaluations++;
+  m_evaluated = true;
+  m_factored = false;
+}
+
+const std::vector<double> &ODEJacobian::values() const
+{
+  return m_values;
+}
+
+void ODEJacobian::multiply(const double x[], double result[]) const
+{
+  const int n = m_pattern.size();
+  const int *offsets = m_pattern.rowOffsets().data();
+  const int *columns = m_pattern.columns().data();
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for(int i = 0; i < n; i++)
+  {
+    double sum = 0.0;
+
+    for(int k = offsets[i]; k < offsets[i + 1]; k++)
+      sum += m_values[k] * x[columns[k]];
+
+    result[i] = sum;
+  }
+}
+
+int ODEJacobian::factor(double gamma)
+{
+  const int n = m_pattern.size();
+  const int *offsets = m_pattern.rowOffsets().data();
+  const int *columns = m_pattern.columns().data();
+
+  for(int i = 0; i < n; i++)
+  {
+    for(int k = offsets[i]; k < offsets[i + 1]; k++)
+      m_factor[k] = (columns[k] == i ? 1.0 : 0.0) - gamma * m_values[k];
+  }
+
+  m_factorizations++;
+
+  //Row by row ILU(0): eliminate with the earlier rows, keeping only the entries of the pattern
+  for(int i = 0; i < n; i++)
+  {
+    for(int k = offsets[i]; k < offsets[i + 1]; k++)
+      m_positions[columns[k]] = k;
+
+    //Earlier pivots were checked when their rows were eliminated
+    for(int k = offsets[i]; k < m_diagonal[i]; k++)
+    {
+      int p = columns[k];
+      double lik = m_factor[k] /= m_factor[m_diagonal[p]];
+
+      for(int m = m_diagonal[p] + 1; m < offsets[p + 1]; m++)
+      {
+        int position = m_positions[columns[m]];
+
+        if(position >= 0)
+          m_factor[position] -= lik * m_factor[m];
+      }
+    }
+
+    for(int k = offsets[i]; k < offsets[i + 1]; k++)
+      m_positions[columns[k]] = -1;
+
+    if(m_factor[m_diagonal[i]] == 0.0)
+    {
+      m_factored = false;
+      return 1;
+    }
+  }
+
+  m_factored = true;
+  m_factorGamma = gamma;
+
+  return 0;
+}
+
+void ODEJacobian::solve(const double r[], double z[]) const
+{
+  const int n = m_pattern.size();
+  const int *offsets = m_pattern.rowOffsets().data();
+  const int *columns = m_pattern.columns().data();
+
+  for(int i = 0; i < n; i++)
+  {
+    double sum = r[i];
+
+    for(int k = offsets[i]; k < m_diagonal[i]; k++)
+      sum -= m_factor[k] * z[columns[k]];
+
+    z[i] = sum;
+  }
+
+  for(int i = n - 1; i >= 0; i--)
+  {
+    double sum = z[i];
+
+    for(int k = m_diagonal[i] + 1; k < offsets[i + 1]; k++)
+      sum -= m_factor[k] * z[columns[k]];
+
+    z[i] = sum / m_factor[m_diagonal[i]];
+  }
+}
+
+int ODEJacobian::maxAge() const
+{
+  return m_maxAge;
+}
+
+void ODEJacobian::setMaxAge(int steps)
+{
+  m_maxAge = steps;
+}
+
+double ODEJacobian::maxGammaChange() const
+{
+  return m_maxGammaChange;
+}
+
+void ODEJacobian::setMaxGammaChange(double change)
+{
+  m_maxGammaChange = change;
+}
+
+double ODEJacobian::maxLinearIterationRate() const
+{
+  return m_maxLinearIterationRate;
+}
+
+void ODEJacobian::setMaxLinearIterationRate(double rate)
+{
+  m_maxLinearIterationRate = rate;
+}
+
+void ODEJacobian::invalidate()
+{
+  m_evaluated = false;
+  m_factored = false;
+}
+
+int ODEJacobian::setup(double t, const double y[], const double dydt[], double gamma, long long steps, long long newtonIterations,
+                       long long linearIterations, bool convergenceFailed, ComputeDerivatives derivs, void *userData, bool &evaluated)
+{
+  long long age = steps - m_evaluationSteps;
+  long long iterations = newtonIterations - m_evaluationNewtonIterations;
+  double linearIterationRate = iterations > 0 ? (linearIterations - m_evaluationLinearIterations) / static_cast<double>(iterations) : 0.0;
+
+  //A failure with a Jacobian from the current step is left to the step size reduction
+  evaluated = !m_evaluated || age >= m_maxAge ||
+              (age > 0 && convergenceFailed) ||
+              (age > 0 && m_maxLinearIterationRate > 0.0 && linearIterationRate > m_maxLinearIterationRate);
+
+  if(evaluated)
+  {
+    evaluate(t, y, dydt, derivs, userData);
+
+    m_evaluationSteps = steps;
+    m_evaluationNewtonIterations = newtonIterations;
+    m_evaluationLinearIterations = linearIterations;
+  }
+  else
+  {
+    m_jacobianReuses++;
+
+    if(m_factored && fabs(gamma / m_factorGamma - 1.0) <= m_maxGammaChange)
+    {
+      m_factorizationReuses++;
+      return 0;
+    }
+  }
+
+  return factor(gamma);
+}
+
+long long ODEJacobian::jacobianReuses() const
+{
+  return m_jacobianReuses;
+}
+
+long long ODEJacobian::factorizationReuses() const
+{
+  return m_factorizationReuses;
+}
+
+long long ODEJacobian::evaluations() const
+{
+  return m_evaluations;
+}
+
+long long ODEJacobian::derivativeEvaluations() const
+{
+  return m_derivativeEvaluations;
+}
+
+long long ODEJacobian::factorizations() const
+{
+  return m_factorizations;
+}
+
+void ODEJacobian::colourColumns()
+{
+  const int n = m_pattern.size();
+  const int *offsets = m_pattern.rowOffsets().data();
+  const int *columns = m_pattern.columns().data();
+
+  //Greedy distance-2 colouring: a column takes the lowest colour not used by a column sharing one of its rows
+  std::vector<int> forbidden(n + 1, -1);
+  m_colours.assign(n, -1);
+  m_numColours = 0;
+
+  for(int j = 0; j < n; j++)
+  {
+    for(int e = m_columnOffsets[j]; e < m_columnOffsets[j + 1]; e++)
+    {
+      int i = m_columnRows[e];
+
+      for(int k = offsets[i]; k < offsets[i + 1]; k++)
+      {
+        if(m_colours[columns[k]] >= 0)
+          forbidden[m_colours[columns[k]]] = j;
+      }
+    }
+
+    int colour = 0;
+
+    while(forbidden[colour] == j)
+      colour++;
+
+    m_colours[j] = colour;
+    m_numColours = std::max(m_numColours, colour + 1);
+  }
+
+  m_colourOffsets.assign(m_numColours + 1, 0);
+  m_colourColumns.resize(n);
+
+  for(int j = 0; j < n; j++)
+    m_colourOffsets[m_colours[j] + 1]++;
+
+  for(int c = 0; c < m_numColours; c++)
+    m_colourOffsets[c + 1] += m_colourOffsets[c];
+
+  std::vector<int> next(m_colourOffsets.begin(), m_colourOffsets.end() - 1);
+
+  for(int j = 0; j < n; j++)
+    m_colourColumns[next[m_colours[j]]++] = j;
+}
@@ -0,0 +1,383 @@
+/*!
+ *  \file    odekernels.cpp
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#include "stdafx.h"
+#include "odekernels.h"
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+#include <math.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <algorithm>
+
+//The kernel bodies are inlined into one wrapper per level, which the compiler vectorizes for that level
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ODE_KERNELS_X86
+#define ODE_KERNEL_INLINE inline __attribute__((always_inline))
+#define ODE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define ODE_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#else
+#define ODE_KERNEL_INLINE inline
+#endif
+
+typedef void (*CombineKernel)(int begin, int end, int lanes, const double y[], const double h[], int count, const double c[],
+                              const double *const k[], double out[]);
+typedef void (*ErrorKernel)(int begin, int end, int lanes, const double err[], const double scale[], double errmax[]);
+
+struct ODEKernelTable
+{
+    CombineKernel combine;
+    ErrorKernel maxScaledError;
+};
+
+template<int COUNT, bool START>
+static ODE_KERNEL_INLINE void combineTerms(int begin, int end, int lanes, const double y[], const double h[], const double c[],
+                                           const double *const k[], double out[])
+{
+  double cj[COUNT];
+  const double *kj[COUNT];
+
+  for(int j = 0; j < COUNT; j++)
+  {
+    cj[j] = c[j];
+    kj[j] = k[j];
+  }
+
+  if(lanes == 1)
+  {
+    const double h0 = h[0];
+
+#ifdef USE_OPENMP
+#pragma omp simd
+#endif
+    for(int i = begin; i < end; i++)
+    {
+      double sum = cj[0] * kj[0][i];
+
+      for(int j = 1; j < COUNT; j++)
+        sum += cj[j] * kj[j][i];
+
+      out[i] = START ? y[i] + h0 * sum : h0 * sum;
+    }
+  }
+  else
+  {
+    for(int i = begin; i < end; i++)
+    {
+      const int offset = i * lanes;
+
+#ifdef USE_OPENMP
+#pragma omp simd
+#endif
+      for(int l = 0; l < lanes; l++)
+      {
+        double sum = cj[0] * kj[0][offset + l];
+
+        for(int j = 1; j < COUNT; j++)
+          sum += cj[j] * kj[j][offset + l];
+
+        out[offset + l] = START ? y[offset + l] + h[l] * sum : h[l] * sum;
+      }
+    }
+  }
+}
+
+template<bool START>
+static ODE_KERNEL_INLINE void combineCount(int begin, int end, int lanes, const double y[], const double h[], int count, const double c[],
+                                           const double *const k[], double out[])
+{
+  switch (count)
+  {
+    case 1: combineTerms<1, START>(begin, end, lanes, y, h, c, k, out); break;
+    case 2: combineTerms<2, START>(begin, end, lanes, y, h, c, k, out); break;
+    case 3: combineTerms<3, START>(begin, end, lanes, y, h, c, k, out); break;
+    case 4: combineTerms<4, START>(begin, end, lanes, y, h, c, k, out); break;
+    case 5: combineTerms<5, START>(begin, end, lanes, y, h, c, k, out); break;
+    case 6: combineTerms<6, START>(begin, end, lanes, y, h, c, k, out); break;
+  }
+}
+
+static ODE_KERNEL_INLINE void combineBody(int begin, int end, int lanes, const double y[], const double h[], int count, const double c[],
+                                          const double *const k[], double out[])
+{
+  if(y)
+    combineCount<true>(begin, end, lanes, y, h, count, c, k, out);
+  else
+    combineCount<false>(begin, end, lanes, y, h, count, c, k, out);
+}
+
+static ODE_KERNEL_INLINE void maxScaledErrorBody(int begin, int end, int lanes, const double err[], const double scale[], double errmax[])
+{
+  if(lanes == 1)
+  {
+    double maximum = errmax[0];
+
+#ifdef USE_OPENMP
+#pragma omp simd reduction(max:maximum)
+#endif
+    for(int i = begin; i < end; i++)
+    {
+      double e = fabs(err[i] / scale[i]);
+
+      //NaN compares false and would otherwise pass the error test
+      maximum = std::max(maximum, e == e ? e : HUGE_VAL);
+    }
+
+    errmax[0] = maximum;
+  }
+  else
+  {
+    for(int i = begin; i < end; i++)
+    {
+      const int offset = i * lanes;
+
+#ifdef USE_OPENMP
+#pragma omp simd
+#endif
+      for(int l = 0; l < lanes; l++)
+      {
+        double e = fabs(err[offset + l] / scale[offset + l]);
+        errmax[l] = std::max(errmax[l], e == e ? e : HUGE_VAL);
+      }
+    }
+  }
+}
+
+static void combineGeneric(int begin, int end, int lanes, const double y[], const double h[], int count, const double c[],
+                           const double *const k[], double out[])
+{
+  combineBody(begin, end, lanes, y, h, count, c, k, out);
+}
+
+static void maxScaledErrorGeneric(int begin, int end, int lanes, const double err[], const double scale[], double errmax[])
+{
+  maxScaledErrorBody(begin, end, lanes, err, scale, errmax);
+}
+
+#ifdef ODE_KERNELS_X86
+
+ODE_TARGET_AVX2 static void combineAvx2(int begin, int end, int lanes, const double y[], const double h[], int count, const double c[],
+                                        const double *const k[], double out[])
+{
+  combineBody(begin, end, lanes, y, h, count, c, k, out);
+}
+
+ODE_TARGET_AVX2 static void maxScaledErrorAvx2(int begin, int end, int lanes, const double err[], const double scale[], double errmax[])
+{
+  maxScaledErrorBody(begin, end, lanes, err, scale, errmax);
+}
+
+ODE_TARGET_AVX512 static void combineAvx512(int begin, int end, int lanes, const double y[], const double h[], int count, const double c[],
+                                            const double *const k[], double out[])
+{
+  combineBody(begin, end, lanes, y, h, count, c, k, out);
+}
+
+ODE_TARGET_AVX512 static void maxScaledErrorAvx512(int begin, int end, int lanes, const double err[], const double scale[], double errmax[])
+{
+  maxScaledErrorBody(begin, end, lanes, err, scale, errmax);
+}
+
+static const ODEKernelTable ODE_KERNEL_TABLES[3] =
+{
+  {&combineGeneric, &maxScaledErrorGeneric},
+  {&combineAvx2, &maxScaledErrorAvx2},
+  {&combineAvx512, &maxScaledErrorAvx512}
+};
+
+#else
+
+static const ODEKernelTable ODE_KERNEL_TABLES[3] =
+{
+  {&combineGeneric, &maxScaledErrorGeneric},
+  {&combineGeneric, &maxScaledErrorGeneric},
+  {&combineGeneric, &maxScaledErrorGeneric}
+};
+
+#endif
+
+static ODEKernels::Isa initialIsa()
+{
+  ODEKernels::Isa supported = ODEKernels::supportedIsa();
+  ODEKernels::Isa requested;
+  const char *name = getenv("ODESOLVER_ISA");
+
+  if(name && ODEKernels::isaFromName(name, requested) && requested <= supported)
+    return requested;
+
+  return supported;
+}
+
+static ODEKernels::Isa &selectedIsa()
+{
+  static ODEKernels::Isa isa = initialIsa();
+  return isa;
+}
+
+//Chooses the kernels when the library is loaded rather than in the first solve
+static const ODEKernels::Isa ODE_KERNELS_LOADED = ODEKernels::isa();
+
+ODEKernels::Isa ODEKernels::isa()
+{
+  return selectedIsa();
+}
+
+ODEKernels::Isa ODEKernels::supportedIsa()
+{
+#ifdef ODE_KERNELS_X86
+  __builtin_cpu_init();
+
+  if(__builtin_cpu_supports("avx512f"))
+    return AVX512;
+
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return AVX2;
+#endif
+
+  return GENERIC;
+}
+
+bool ODEKernels::setIsa(Isa isa)
+{
+  if(isa < GENERIC || isa > supportedIsa())
+    return false;
+
+  selectedIsa() = isa;
+
+  return true;
+}
+
+const char *ODEKernels::isaName(Isa isa)
+{
+  switch (isa)
+  {
+    case GENERIC:
+      return "generic";
+    case AVX2:
+      return "avx2";
+    case AVX512:
+      return "avx512";
+  }
+
+  return "unknown";
+}
+
+bool ODEKernels::isaFromName(const char *name, Isa &isa)
+{
+  for(int level = GENERIC; level <= AVX512; level++)
+  {
+    const char *candidate = isaName(static_cast<Isa>(level));
+    const char *c = name;
+
+    while(*c && *candidate && tolower(static_cast<unsigned char>(*c)) == *candidate)
+    {
+      c++;
+      candidate++;
+    }
+
+    if(!*c && !*candidate)
+    {
+      isa = static_cast<Isa>(level);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ODEKernels::combine(int n, int lanes, const double y[], const double h[], int count, const double c[], const double *const k[],
+                         double out[], bool parallel)
+{
+  CombineKernel kernel = ODE_KERNEL_TABLES[selectedIsa()].combine;
+
+#ifdef USE_OPENMP
+  if(parallel)
+  {
+    //Contiguous blocks of components per thread, as the static schedule of the loops the arrays were first touched by
+#pragma omp parallel
+    {
+      int threads = omp_get_num_threads(), thread = omp_get_thread_num();
+      int begin = static_cast<int>(static_cast<long long>(n) * thread / threads);
+      int end = static_cast<int>(static_cast<long long>(n) * (thread + 1) / threads);
+
+      kernel(begin, end, lanes, y, h, count, c, k, out);
+    }
+
+    return;
+  }
+#else
+  (void)parallel;
+#endif
+
+  kernel(0, n, lanes, y, h, count, c, k, out);
+}
+
+void ODEKernels::maxScaledError(int n, int lanes, const double err[], const double scale[], double errmax[], bool parallel)
+{
+  ErrorKernel kernel = ODE_KERNEL_TABLES[selectedIsa()].maxScaledError;
+
+#ifdef USE_OPENMP
+  if(parallel)
+  {
+    if(lanes == 1)
+    {
+      double maximum = errmax[0];
+
+#pragma omp parallel reduction(max:maximum)
+      {
+        int threads = omp_get_num_threads(), thread = omp_get_thread_num();
+        int begin = static_cast<int>(static_cast<long long>(n) * thread / threads);
+        int end = static_cast<int>(static_cast<long long>(n) * (thread + 1) / threads);
+
+        kernel(begin, end, 1, err, scale, &maximum);
+      }
+
+      errmax[0] = maximum;
+
+      return;
+    }
+
+#pragma omp parallel
+    {
+      int threads = omp_get_num_threads(), thread = omp_get_thread_num();
+      int begin = static_cast<int>(static_cast<long long>(n) * thread / threads);
+      int end = static_cast<int>(static_cast<long long>(n) * (thread + 1) / threads);
+
+      double local[ODE_KERNELS_MAX_LANES];
+      std::copy(errmax, errmax + lanes, local);
+      kernel(begin, end, lanes, err, scale, local);
+
+#pragma omp critical(odeKernelsMaxScaledError)
+      {
+        for(int l = 0; l < lanes; l++)
+          errmax[l] = std::max(errmax[l], local[l]);
+      }
+    }
+
+    return;
+  }
+#else
+  (void)parallel;
+#endif
+
+  kernel(0, n, lanes, err, scale, errmax);
+}
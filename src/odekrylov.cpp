@@ -0,0 +1,395 @@
+/*!
+ *  \file    odekrylov.cpp
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#include "stdafx.h"
+#include "odekrylov.h"
+#include "odebatchstate.h"
+
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+
+//Degree of the diagonal Pade approximant of the exponential
+static const int KRYLOV_PADE_DEGREE = 6;
+
+ODEKrylov::ODEKrylov(int size, int maxDimension)
+  : m_size(size),
+    m_maxDimension(std::max(1, maxDimension)),
+    m_lastDimension(0)
+{
+  m_basis = ODEBatchState::allocate((size_t)(m_maxDimension + 1) * m_size);
+  m_hessenberg.resize((m_maxDimension + 1) * m_maxDimension, 0.0);
+}
+
+ODEKrylov::~ODEKrylov()
+{
+  ODEBatchState::deallocate(m_basis);
+}
+
+int ODEKrylov::size() const
+{
+  return m_size;
+}
+
+int ODEKrylov::maxDimension() const
+{
+  return m_maxDimension;
+}
+
+int ODEKrylov::phi(int p, double h, const double v[], double w[], double tolerance, MatrixVectorProduct product, void *context)
+{
+  const int n = m_size;
+  const int md = m_maxDimension;
+  double *V = m_basis;
+  double *H = m_hessenberg.data();
+
+  double beta = 0.0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(+:beta)
+#endif
+  for(int i = 0; i < n; i++)
+  {
+    beta += v[i] * v[i];
+  }
+
+  beta = sqrt(beta);
+
+  if(beta == 0.0)
+  {
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for(int i = 0; i < n; i++)
+    {
+      w[i] = 0.0;
+    }
+
+    m_lastDimension = 0;
+    return 0;
+  }
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for(int i = 0; i < n; i++)
+  {
+    V[i] = v[i] / beta;
+  }
+
+  std::fill(m_hessenberg.begin(), m_hessenberg.end(), 0.0);
+
+  std::vector<double> phiP(md + 1), phiP1(md + 1);
+  int m = 0;
+  int nextCheck = 1;
+  int status = 1;
+
+  for(int j = 0; j < md; j++)
+  {
+    double *vj = V + (size_t)j * n;
+    double *vj1 = V + (size_t)(j + 1) * n;
+
+    product(vj, vj1, context);
+
+    //Modified Gram-Schmidt against the basis so far
+    for(int i = 0; i <= j; i++)
+    {
+      const double *vi = V + (size_t)i * n;
+      double hij = 0.0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(+:hij)
+#endif
+      for(int k = 0; k < n; k++)
+      {
+        hij += vi[k] * vj1[k];
+      }
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int k = 0; k < n; k++)
+      {
+        vj1[k] -= hij * vi[k];
+      }
+
+      H[i * md + j] = hij;
+    }
+
+    double hj1 = 0.0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(+:hj1)
+#endif
+    for(int k = 0; k < n; k++)
+    {
+      hj1 += vj1[k] * vj1[k];
+    }
+
+    hj1 = sqrt(hj1);
+    m = j + 1;
+
+    //Happy breakdown: the subspace is invariant and the projection exact
+    double scale = 0.0;
+
+    for(int i = 0; i <= j; i++)
+    {
+      scale += fabs(H[i * md + j]);
+    }
+
+    bool breakdown = hj1 <= 8.0 * DBL_EPSILON * std::max(scale, 1.0);
+
+    if(breakdown || m == md || m >= nextCheck)
+    {
+      phiHessenberg(p, h, m, phiP.data(), phiP1.data());
+
+      double error = breakdown ? 0.0 : beta * fabs(h) * hj1 * fabs(phiP1[m - 1]);
+
+      if(error <= tolerance)
+      {
+        status = 0;
+        break;
+      }
+
+      nextCheck = std::max(m + 1, (int)(1.3 * m));
+    }
+
+    if(breakdown)
+    {
+      status = 0;
+      break;
+    }
+
+    H[(j + 1) * md + j] = hj1;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for(int k = 0; k < n; k++)
+    {
+      vj1[k] /= hj1;
+    }
+  }
+
+  m_lastDimension = m;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for(int k = 0; k < n; k++)
+  {
+    double sum = 0.0;
+
+    for(int i = 0; i < m; i++)
+    {
+      sum += V[(size_t)i * n + k] * phiP[i];
+    }
+
+    w[k] = beta * sum;
+  }
+
+  return status;
+}
+
+int ODEKrylov::lastDimension() const
+{
+  return m_lastDimension;
+}
+
+void ODEKrylov::phiHessenberg(int p, double h, int m, double phiP[], double phiP1[])
+{
+  const int md = m_maxDimension;
+  const int size = m + p + 1;
+
+  //[[h H, e_1, 0], [0, 0, I_p], [0, 0, 0]]: column m + k of its exponential holds phi_{k+1}(h H) e_1
+  m_augmented.assign(size * size, 0.0);
+
+  for(int i = 0; i < m; i++)
+  {
+    for(int j = std::max(0, i - 1); j < m; j++)
+    {
+      m_augmented[i * size + j] = h * m_hessenberg[i * md + j];
+    }
+  }
+
+  m_augmented[m] = 1.0;
+
+  for(int k = 0; k < p; k++)
+  {
+    m_augmented[(m + k) * size + m + k + 1] = 1.0;
+  }
+
+  exponential(m_augmented, size, m_exponential);
+
+  int columnP = p == 0 ? 0 : m + p - 1;
+  int columnP1 = m + p;
+
+  for(int i = 0; i < m; i++)
+  {
+    phiP[i] = m_exponential[i * size + columnP];
+    phiP1[i] = m_exponential[i * size + columnP1];
+  }
+}
+
+void ODEKrylov::exponential(std::vector<double> &A, int size, std::vector<double> &E)
+{
+  double norm = 0.0;
+
+  for(int i = 0; i < size; i++)
+  {
+    double row = 0.0;
+
+    for(int j = 0; j < size; j++)
+    {
+      row += fabs(A[i * size + j]);
+    }
+
+    norm = std::max(norm, row);
+  }
+
+  int squarings = norm > 0.5 ? (int)ceil(log2(norm / 0.5)) : 0;
+  double scale = ldexp(1.0, -squarings);
+
+  for(size_t i = 0; i < A.size(); i++)
+  {
+    A[i] *= scale;
+  }
+
+  //Numerator and denominator of the Pade approximant from the powers of A
+  std::vector<double> numerator(size * size, 0.0), denominator(size * size, 0.0),
+      power(size * size, 0.0), next(size * size);
+
+  for(int i = 0; i < size; i++)
+  {
+    numerator[i * size + i] = denominator[i * size + i] = power[i * size + i] = 1.0;
+  }
+
+  const int q = KRYLOV_PADE_DEGREE;
+  double c = 1.0;
+
+  for(int k = 1; k <= q; k++)
+  {
+    c *= (double)(q - k + 1) / (double)(k * (2 * q - k + 1));
+
+    for(int i = 0; i < size; i++)
+    {
+      for(int j = 0; j < size; j++)
+      {
+        double sum = 0.0;
+
+        for(int l = 0; l < size; l++)
+        {
+          sum += power[i * size + l] * A[l * size + j];
+        }
+
+        next[i * size + j] = sum;
+      }
+    }
+
+    power.swap(next);
+
+    double sign = k % 2 ? -1.0 : 1.0;
+
+    for(int i = 0; i < size * size; i++)
+    {
+      numerator[i] += c * power[i];
+      denominator[i] += sign * c * power[i];
+    }
+  }
+
+  //Solve denominator E = numerator by Gaussian elimination with partial pivoting
+  for(int k = 0; k < size; k++)
+  {
+    int pivot = k;
+
+    for(int i = k + 1; i < size; i++)
+    {
+      if(fabs(denominator[i * size + k]) > fabs(denominator[pivot * size + k]))
+        pivot = i;
+    }
+
+    if(pivot != k)
+    {
+      for(int j = 0; j < size; j++)
+      {
+        std::swap(denominator[k * size + j], denominator[pivot * size + j]);
+        std::swap(numerator[k * size + j], numerator[pivot * size + j]);
+      }
+    }
+
+    double diagonal = denominator[k * size + k];
+
+    for(int i = k + 1; i < size; i++)
+    {
+      double factor = denominator[i * size + k] / diagonal;
+
+      if(factor != 0.0)
+      {
+        for(int j = k; j < size; j++)
+        {
+          denominator[i * size + j] -= factor * denominator[k * size + j];
+        }
+
+        for(int j = 0; j < size; j++)
+        {
+          numerator[i * size + j] -= factor * numerator[k * size + j];
+        }
+      }
+    }
+  }
+
+  for(int k = size - 1; k >= 0; k--)
+  {
+    double diagonal = denominator[k * size + k];
+
+    for(int j = 0; j < size; j++)
+    {
+      double sum = numerator[k * size + j];
+
+      for(int l = k + 1; l < size; l++)
+      {
+        sum -= denominator[k * size + l] * numerator[l * size + j];
+      }
+
+      numerator[k * size + j] = sum / diagonal;
+    }
+  }
+
+  E.swap(numerator);
+
+  for(int s = 0; s < squarings; s++)
+  {
+    for(int i = 0; i < size; i++)
+    {
+      for(int j = 0; j < size; j++)
+      {
+        double sum = 0.0;
+
+        for(int l = 0; l < size; l++)
+        {
+          sum += E[i * size + l] * E[l * size + j];
+        }
+
+        next[i * size + j] = sum;
+      }
+    }
+
+    E.swap(next);
+  }
+}
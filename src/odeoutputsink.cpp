@@ -0,0 +1,314 @@
+/*!
+ *  \file    odeoutputsink.cpp
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#include "stdafx.h"
+#include "odeoutputsink.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#define ODE_TRAJECTORY_MAGIC 0x5445444Fu
+#define ODE_TRAJECTORY_VERSION 1u
+
+//Magic, version, size and number of components followed by the components, padded to eight bytes
+static long long trajectoryHeaderSize(size_t numComponents)
+{
+  return ((4 + numComponents) * sizeof(int) + 7) & ~7ll;
+}
+
+ODETrajectoryWriter::ODETrajectoryWriter(const QString &filePath)
+  : m_filePath(filePath),
+    m_size(0),
+    m_downsample(1),
+    m_chunkSize(1024),
+    m_received(0),
+    m_records(0),
+    m_frontCount(0),
+    m_backCount(0),
+    m_open(false),
+    m_backFull(false),
+    m_stop(false),
+    m_failed(false)
+{
+}
+
+ODETrajectoryWriter::~ODETrajectoryWriter()
+{
+  close();
+}
+
+void ODETrajectoryWriter::setComponents(const std::vector<int> &components)
+{
+  m_components = components;
+}
+
+void ODETrajectoryWriter::setDownsample(int downsample)
+{
+  m_downsample = std::max(1, downsample);
+}
+
+void ODETrajectoryWriter::setChunkSize(int records)
+{
+  m_chunkSize = std::max(1, records);
+}
+
+bool ODETrajectoryWriter::open(int size)
+{
+  close();
+
+  m_size = size;
+
+  if(m_components.empty())
+  {
+    for(int i = 0; i < size; i++)
+      m_components.push_back(i);
+  }
+
+  for(int component : m_components)
+  {
+    if(component < 0 || component >= size)
+    {
+      fprintf(stderr, "Trajectory component %i out of range\n", component);
+      return false;
+    }
+  }
+
+  m_file.setFileName(m_filePath);
+
+  if(!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    fprintf(stderr, "Could not open %s for writing\n", m_filePath.toStdString().c_str());
+    return false;
+  }
+
+  std::vector<int> header(trajectoryHeaderSize(m_components.size()) / sizeof(int), 0);
+  header[0] = static_cast<int>(ODE_TRAJECTORY_MAGIC);
+  header[1] = static_cast<int>(ODE_TRAJECTORY_VERSION);
+  header[2] = size;
+  header[3] = static_cast<int>(m_components.size());
+  std::copy(m_components.begin(), m_components.end(), header.begin() + 4);
+
+  long long headerBytes = header.size() * sizeof(int);
+
+  if(m_file.write(reinterpret_cast<const char*>(header.data()), headerBytes) != headerBytes)
+  {
+    m_file.close();
+    return false;
+  }
+
+  size_t chunkDoubles = static_cast<size_t>(m_chunkSize) * (1 + m_components.size());
+  m_front.assign(chunkDoubles, 0.0);
+  m_back.assign(chunkDoubles, 0.0);
+  m_frontCount = 0;
+  m_backCount = 0;
+  m_received = 0;
+  m_records = 0;
+  m_backFull = false;
+  m_stop = false;
+  m_failed = false;
+  m_open = true;
+
+  m_thread = std::thread(&ODETrajectoryWriter::writerLoop, this);
+
+  return true;
+}
+
+void ODETrajectoryWriter::write(double t, const double y[], int n)
+{
+  if(!m_open || m_received++ % m_downsample)
+    return;
+
+  double *record = &m_front[m_frontCount];
+  record[0] = t;
+
+  for(size_t i = 0; i < m_components.size(); i++)
+    record[i + 1] = m_components[i] < n ? y[m_components[i]] : 0.0;
+
+  m_frontCount += 1 + m_components.size();
+  m_records++;
+
+  if(m_frontCount == m_front.size())
+    flushFront();
+}
+
+bool ODETrajectoryWriter::close()
+{
+  if(!m_open)
+    return !m_failed;
+
+  if(m_frontCount)
+    flushFront();
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+
+  m_condition.notify_all();
+  m_thread.join();
+  m_file.close();
+  m_open = false;
+
+  return !m_failed;
+}
+
+long long ODETrajectoryWriter::records() const
+{
+  return m_records;
+}
+
+void ODETrajectoryWriter::flushFront()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]{ return !m_backFull; });
+
+    m_front.swap(m_back);
+    m_backCount = m_frontCount;
+    m_backFull = true;
+  }
+
+  m_condition.notify_all();
+  m_frontCount = 0;
+}
+
+void ODETrajectoryWriter::writerLoop()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  for(;;)
+  {
+    m_condition.wait(lock, [this]{ return m_backFull || m_stop; });
+
+    if(m_backFull)
+    {
+      //The back buffer belongs to this thread until m_backFull is cleared
+      lock.unlock();
+
+      long long bytes = m_backCount * sizeof(double);
+      bool failed = m_file.write(reinterpret_cast<const char*>(m_back.data()), bytes) != bytes;
+
+      lock.lock();
+      m_failed = m_failed || failed;
+      m_backFull = false;
+      m_condition.notify_all();
+    }
+    else
+    {
+      break;
+    }
+  }
+}
+
+ODETrajectoryReader::ODETrajectoryReader()
+  : m_data(nullptr),
+    m_headerSize(0),
+    m_records(0),
+    m_size(0)
+{
+}
+
+ODETrajectoryReader::~ODETrajectoryReader()
+{
+  close();
+}
+
+bool ODETrajectoryReader::open(const QString &filePath)
+{
+  close();
+
+  m_file.setFileName(filePath);
+
+  if(!m_file.open(QIODevice::ReadOnly))
+  {
+    fprintf(stderr, "Could not open %s for reading\n", filePath.toStdString().c_str());
+    return false;
+  }
+
+  long long fileSize = m_file.size();
+  int header[4] = {0, 0, 0, 0};
+
+  if(fileSize >= static_cast<long long>(sizeof(header)))
+  {
+    m_data = m_file.map(0, fileSize);
+
+    if(m_data)
+      memcpy(header, m_data, sizeof(header));
+  }
+
+  if(!m_data || header[0] != static_cast<int>(ODE_TRAJECTORY_MAGIC) || header[1] != static_cast<int>(ODE_TRAJECTORY_VERSION) ||
+     header[3] < 0 || trajectoryHeaderSize(header[3]) > fileSize)
+  {
+    fprintf(stderr, "Not a supported trajectory file %s\n", filePath.toStdString().c_str());
+    close();
+    return false;
+  }
+
+  m_size = header[2];
+  m_components.resize(header[3]);
+  memcpy(m_components.data(), m_data + 4 * sizeof(int), header[3] * sizeof(int));
+
+  m_headerSize = trajectoryHeaderSize(header[3]);
+  m_records = (fileSize - m_headerSize) / static_cast<long long>((1 + m_components.size()) * sizeof(double));
+
+  return true;
+}
+
+void ODETrajectoryReader::close()
+{
+  if(m_data)
+  {
+    m_file.unmap(const_cast<unsigned char*>(m_data));
+    m_data = nullptr;
+  }
+
+  if(m_file.isOpen())
+    m_file.close();
+
+  m_headerSize = 0;
+  m_records = 0;
+  m_size = 0;
+  m_components.clear();
+}
+
+int ODETrajectoryReader::size() const
+{
+  return m_size;
+}
+
+const std::vector<int> &ODETrajectoryReader::components() const
+{
+  return m_components;
+}
+
+long long ODETrajectoryReader::records() const
+{
+  return m_records;
+}
+
+double ODETrajectoryReader::time(long long record) const
+{
+  return values(record)[-1];
+}
+
+const double *ODETrajectoryReader::values(long long record) const
+{
+  return reinterpret_cast<const double*>(m_data + m_headerSize) + record * (1 + m_components.size()) + 1;
+}
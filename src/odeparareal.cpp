@@ -0,0 +1,307 @@
+/*!
+ *  \file    odeparareal.cpp
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#include "stdafx.h"
+#include "odeparareal.h"
+
+#include <math.h>
+#include <algorithm>
+
+ODEParareal::ODEParareal(const ODESolver &coarse, const ODESolver &fine, int slices)
+  : m_coarseConfiguration(coarse.clone()),
+    m_fineConfiguration(fine.clone()),
+    m_coarse(nullptr),
+    m_size(fine.size()),
+    m_slices(std::max(slices, 1)),
+    m_coarseSteps(1),
+    m_fineSteps(1),
+    m_maxIterations(m_slices),
+    m_iterations(0),
+    m_firstSlice(0),
+    m_lastSlice(0),
+    m_tolerance(1.0)
+  #ifdef USE_MPI
+  , m_communicator(MPI_COMM_WORLD)
+  #endif
+{
+}
+
+ODEParareal::~ODEParareal()
+{
+  clearMemory();
+  delete m_coarseConfiguration;
+  delete m_fineConfiguration;
+}
+
+void ODEParareal::initialize()
+{
+  clearMemory();
+
+  int rank = 0, ranks = 1;
+
+#ifdef USE_MPI
+  MPI_Comm_rank(m_communicator, &rank);
+  MPI_Comm_size(m_communicator, &ranks);
+
+  m_counts.resize(ranks);
+  m_displacements.resize(ranks);
+
+  for(int r = 0; r < ranks; r++)
+  {
+    m_displacements[r] = (r * m_slices / ranks) * m_size;
+    m_counts[r] = ((r + 1) * m_slices / ranks) * m_size - m_displacements[r];
+  }
+#endif
+
+  m_firstSlice = rank * m_slices / ranks;
+  m_lastSlice = (rank + 1) * m_slices / ranks;
+
+  m_coarse = m_coarseConfiguration->clone();
+  m_coarse->initialize();
+
+  for(int s = m_firstSlice; s < m_lastSlice; s++)
+  {
+    ODESolver *fine = m_fineConfiguration->clone();
+    fine->initialize();
+    m_fine.push_back(fine);
+  }
+
+  m_u.assign(static_cast<size_t>(m_slices + 1) * m_size, 0.0);
+  m_coarseValues.assign(static_cast<size_t>(m_slices) * m_size, 0.0);
+  m_fineValues.assign(static_cast<size_t>(m_slices) * m_size, 0.0);
+
+  //One buffer per owned slice followed by the coarse state and its scratch buffer
+  m_work.assign(static_cast<size_t>(m_lastSlice - m_firstSlice + 2) * m_size, 0.0);
+}
+
+int ODEParareal::size() const
+{
+  return m_size;
+}
+
+int ODEParareal::slices() const
+{
+  return m_slices;
+}
+
+void ODEParareal::setSlices(int slices)
+{
+  if(slices > 0)
+  {
+    m_maxIterations = m_maxIterations == m_slices ? slices : m_maxIterations;
+    m_slices = slices;
+  }
+}
+
+int ODEParareal::coarseSteps() const
+{
+  return m_coarseSteps;
+}
+
+void ODEParareal::setCoarseSteps(int steps)
+{
+  if(steps > 0)
+    m_coarseSteps = steps;
+}
+
+int ODEParareal::fineSteps() const
+{
+  return m_fineSteps;
+}
+
+void ODEParareal::setFineSteps(int steps)
+{
+  if(steps > 0)
+    m_fineSteps = steps;
+}
+
+int ODEParareal::maxIterations() const
+{
+  return m_maxIterations;
+}
+
+void ODEParareal::setMaxIterations(int iterations)
+{
+  if(iterations > 0)
+    m_maxIterations = iterations;
+}
+
+double ODEParareal::tolerance() const
+{
+  return m_tolerance;
+}
+
+void ODEParareal::setTolerance(double tolerance)
+{
+  m_tolerance = tolerance;
+}
+
+#ifdef USE_MPI
+void ODEParareal::setCommunicator(MPI_Comm communicator)
+{
+  m_communicator = communicator;
+}
+#endif
+
+int ODEParareal::solve(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void *userData)
+{
+  if(n != m_size || !m_coarse)
+    return 1;
+
+  const double h = dt / m_slices;
+  const double absTol = m_fineConfiguration->absoluteTolerance();
+  const double relTol = m_fineConfiguration->relativeTolerance();
+  const int localSlices = m_lastSlice - m_firstSlice;
+
+  double *u = m_u.data(), *coarse = m_coarseValues.data(), *fine = m_fineValues.data();
+  double *coarseNew = m_work.data() + static_cast<size_t>(localSlices) * n;
+  double *coarseWork = coarseNew + n;
+
+  std::copy(y, y + n, u);
+
+  int status = 0;
+
+  //Sequential coarse sweep for the initial slice starting values
+  for(int s = 0; s < m_slices && !status; s++)
+  {
+    status = propagate(m_coarse, m_coarseSteps, u + s * n, n, t + s * h, h, coarse + s * n, coarseWork, derivs, userData);
+    std::copy(coarse + s * n, coarse + (s + 1) * n, u + (s + 1) * n);
+  }
+
+  m_iterations = 0;
+  int maxIterations = std::min(m_maxIterations, m_slices);
+  std::vector<int> statuses(std::max(localSlices, 1), 0);
+
+  for(int k = 0; k < maxIterations && !status; k++)
+  {
+    //Slices before k already hold the serial fine solution
+    int first = std::max(k, m_firstSlice);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int s = first; s < m_lastSlice; s++)
+    {
+      int local = s - m_firstSlice;
+      statuses[local] = propagate(m_fine[local], m_fineSteps, u + s * n, n, t + s * h, h, fine + s * n,
+                                  m_work.data() + static_cast<size_t>(local) * n, derivs, userData);
+    }
+
+    for(int s = first; s < m_lastSlice && !status; s++)
+      status = statuses[s - m_firstSlice];
+
+#ifdef USE_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &status, 1, MPI_INT, MPI_MAX, m_communicator);
+    MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, fine, m_counts.data(), m_displacements.data(), MPI_DOUBLE, m_communicator);
+#endif
+
+    if(status)
+      break;
+
+    m_iterations = k + 1;
+
+    //Correction sweep: U[s + 1] = G(U[s]) + F(U_old[s]) - G(U_old[s]); U[k] did not change so U[k + 1] = F(U[k])
+    double change = 0.0;
+
+    for(int s = k; s < m_slices; s++)
+    {
+      double *uNext = u + (s + 1) * n;
+      double *fineSlice = fine + s * n;
+      double *coarseSlice = coarse + s * n;
+
+      if(s > k)
+      {
+        status = propagate(m_coarse, m_coarseSteps, u + s * n, n, t + s * h, h, coarseNew, coarseWork, derivs, userData);
+
+        if(status)
+          break;
+      }
+
+      for(int i = 0; i < n; i++)
+      {
+        //Taken exactly so that the last iteration reproduces the serial fine solution bit for bit
+        double value = s > k ? coarseNew[i] + fineSlice[i] - coarseSlice[i] : fineSlice[i];
+        double difference = fabs(value - uNext[i]) / (absTol + relTol * fabs(value));
+
+        //A NaN must not pass for convergence
+        change = difference == difference ? std::max(change, difference) : difference;
+        uNext[i] = value;
+
+        if(s > k)
+          coarseSlice[i] = coarseNew[i];
+      }
+    }
+
+    if(status || change <= m_tolerance)
+      break;
+  }
+
+  std::copy(u + m_slices * n, u + (m_slices + 1) * n, yout);
+
+  return status;
+}
+
+int ODEParareal::getIterations() const
+{
+  return m_iterations;
+}
+
+ODESolverStatistics ODEParareal::statistics() const
+{
+  ODESolverStatistics statistics;
+
+  if(m_coarse)
+    statistics.accumulate(m_coarse->statistics());
+
+  for(ODESolver *fine : m_fine)
+    statistics.accumulate(fine->statistics());
+
+  return statistics;
+}
+
+int ODEParareal::propagate(ODESolver *solver, int steps, const double y[], int n, double t, double dt, double yout[], double work[],
+                           ComputeDerivatives derivs, void *userData)
+{
+  double h = dt / steps;
+  std::copy(y, y + n, yout);
+
+  for(int s = 0; s < steps; s++)
+  {
+    //Separate input and output arrays since not every solver supports solving in place
+    std::copy(yout, yout + n, work);
+
+    int status = solver->solve(work, n, t + s * h, h, yout, derivs, userData);
+
+    if(status)
+      return status;
+  }
+
+  return 0;
+}
+
+void ODEParareal::clearMemory()
+{
+  delete m_coarse;
+  m_coarse = nullptr;
+
+  for(ODESolver *fine : m_fine)
+    delete fine;
+
+  m_fine.clear();
+}
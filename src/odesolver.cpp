@@ -20,6 +20,12 @@
 
 #include "stdafx.h"
 #include "odesolver.h"
+#include "odeoutputsink.h"
+#include "odebatchstate.h"
+#include "odejacobian.h"
+#include "odekrylov.h"
+#include "odekernels.h"
+#include "odeasync.h"
 
 #ifdef USE_CVODE
 #include <cvode/cvode.h>
@@ -45,13 +51,328 @@
 #endif
 
 #include <math.h>
+#include <float.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
 
 #define ODE_TINY 1.0e-30
+#define ODESOLVER_STATE_MAGIC 0x5345444Fu
+#define ODESOLVER_STATE_BYTE_ORDER 0x01020304u
+
+template<typename T>
+static void writeStateValue(char *&buffer, const T &value)
+{
+  memcpy(buffer, &value, sizeof(T));
+  buffer += sizeof(T);
+}
+
+template<typename T>
+static void readStateValue(const char *&buffer, T &value)
+{
+  memcpy(&value, buffer, sizeof(T));
+  buffer += sizeof(T);
+}
+
+static void writeStateStatistics(char *&buffer, const ODESolverStatistics &statistics)
+{
+  writeStateValue(buffer, statistics.solveCalls);
+  writeStateValue(buffer, statistics.derivativeEvaluations);
+  writeStateValue(buffer, statistics.acceptedSteps);
+  writeStateValue(buffer, statistics.rejectedSteps);
+  writeStateValue(buffer, statistics.jacobianEvaluations);
+  writeStateValue(buffer, statistics.linearSolverSetups);
+  writeStateValue(buffer, statistics.linearIterations);
+  writeStateValue(buffer, statistics.linearFailures);
+  writeStateValue(buffer, statistics.jacobianVectorProducts);
+  writeStateValue(buffer, statistics.nonLinearIterations);
+  writeStateValue(buffer, statistics.nonLinearFailures);
+  writeStateValue(buffer, statistics.minStep);
+  writeStateValue(buffer, statistics.maxStep);
+  writeStateValue(buffer, statistics.derivativeTime);
+  writeStateValue(buffer, statistics.solveTime);
+  writeStateValue(buffer, statistics.linearSolveTime);
+  writeStateValue(buffer, statistics.stepControlTime);
+}
+
+static void readStateStatistics(const char *&buffer, ODESolverStatistics &statistics)
+{
+  readStateValue(buffer, statistics.solveCalls);
+  readStateValue(buffer, statistics.derivativeEvaluations);
+  readStateValue(buffer, statistics.acceptedSteps);
+  readStateValue(buffer, statistics.rejectedSteps);
+  readStateValue(buffer, statistics.jacobianEvaluations);
+  readStateValue(buffer, statistics.linearSolverSetups);
+  readStateValue(buffer, statistics.linearIterations);
+  readStateValue(buffer, statistics.linearFailures);
+  readStateValue(buffer, statistics.jacobianVectorProducts);
+  readStateValue(buffer, statistics.nonLinearIterations);
+  readStateValue(buffer, statistics.nonLinearFailures);
+  readStateValue(buffer, statistics.minStep);
+  readStateValue(buffer, statistics.maxStep);
+  readStateValue(buffer, statistics.derivativeTime);
+  readStateValue(buffer, statistics.solveTime);
+  readStateValue(buffer, statistics.linearSolveTime);
+  readStateValue(buffer, statistics.stepControlTime);
+}
+
+//Carpenter and Kennedy (1994) five stage fourth order 2N-storage coefficients
+static const double LSRK_A[5] = {0.0, -567301805773.0 / 1357537059087.0, -2404267990393.0 / 2016746695238.0,
+                                 -3550918686646.0 / 2091501179385.0, -1275806237668.0 / 842570457699.0};
+static const double LSRK_B[5] = {1432997174477.0 / 9575080441755.0, 5161836677717.0 / 13612068292357.0,
+                                 1720146321549.0 / 2090206949498.0, 3134564353537.0 / 4481467310338.0,
+                                 2277821191437.0 / 14882151754819.0};
+static const double LSRK_C[5] = {0.0, 1432997174477.0 / 9575080441755.0, 2526269341429.0 / 6820363962896.0,
+                                 2006345519317.0 / 3224310063776.0, 2802321613138.0 / 2924317926251.0};
+
+//Weights of the fourth order solution minus those of the third order solution with no second stage weight
+static const double LSRK_E[5] = {-0.16033435641008234, 0.34474304234056707, -0.24407312659415953,
+                                 0.054651527079573693, 0.0050129135841011242};
+
+//Cash-Karp tableau: stage times, the weights of k_1, ..., k_s in the argument of stage s + 1, the fifth order weights
+//of k_1, k_3, k_4 and k_6, and their differences from the embedded fourth order weights of k_1, k_3, k_4, k_5 and k_6
+static const double RKCK_A[6] = {0.0, 0.2, 0.3, 0.6, 1.0, 0.875};
+static const double RKCK_B[5][5] = {{0.2},
+                                    {3.0 / 40.0, 9.0 / 40.0},
+                                    {0.3, -0.9, 1.2},
+                                    {-11.0 / 54.0, 2.5, -70.0 / 27.0, 35.0 / 27.0},
+                                    {1631.0 / 55296.0, 175.0 / 512.0, 575.0 / 13824.0, 44275.0 / 110592.0, 253.0 / 4096.0}};
+static const double RKCK_C[4] = {37.0 / 378.0, 250.0 / 621.0, 125.0 / 594.0, 512.0 / 1771.0};
+static const double RKCK_DC[5] = {37.0 / 378.0 - 2825.0 / 27648.0, 250.0 / 621.0 - 18575.0 / 48384.0,
+                                  125.0 / 594.0 - 13525.0 / 55296.0, -277.0 / 14336.0, 512.0 / 1771.0 - 0.25};
+
+//Highest order of the native Adams formulas, as for CVODE_ADAMS
+static const int ADAMS_MAX_ORDER = 12;
+
+//Rows of the Gragg-Bulirsch-Stoer extrapolation table. Row j extrapolates the modified midpoint rule over 2 * (j + 1) substeps.
+static const int GBS_MAX_ROWS = 12;
+
+//Most stages of an RKC step; longer steps are shortened rather than let round-off grow with the stage count
+static const int RKC_MAX_STAGES = 250;
+
+//Bytes of stage arrays per tile window of the tiled RK4 and RKQS stages when no tile size is set
+static const size_t ODESOLVER_TILE_CACHE_BYTES = 256 * 1024;
+
+/*!
+ * \brief The ExponentialOperatorData struct holds what the Krylov products of the exponential integrators need: the linear
+ * operator and its data for EXPRK2, or the point and derivatives the Jacobian is differenced about for EXPRB32.
+ */
+struct ExponentialOperatorData
+{
+    ComputeLinearOperator linearOperator;
+    ComputeJacobianVectorProduct jacobianVectorProduct;
+    ComputeDerivatives derivs;
+    void *userData,
+    *callerData;
+    long long *products;
+    double t;
+    const double *y;
+    const double *dydt;
+    double *work;
+    double ynorm;
+    int n;
+};
+
+static void linearOperatorProduct(const double v[], double Av[], void *context)
+{
+  ExponentialOperatorData *data = static_cast<ExponentialOperatorData*>(context);
+  data->linearOperator(data->t, const_cast<double*>(v), Av, data->callerData);
+
+  if(data->products)
+    (*data->products)++;
+}
+
+static void jacobianProduct(const double v[], double Jv[], void *context)
+{
+  ExponentialOperatorData *data = static_cast<ExponentialOperatorData*>(context);
+  const int n = data->n;
+
+  if(data->jacobianVectorProduct)
+  {
+    data->jacobianVectorProduct(data->t, const_cast<double*>(data->y), const_cast<double*>(data->dydt), const_cast<double*>(v), Jv,
+                                data->callerData);
+
+    if(data->products)
+      (*data->products)++;
+
+    return;
+  }
+
+  double vnorm = 0.0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(+:vnorm)
+#endif
+  for(int i = 0; i < n; i++)
+  {
+    vnorm += v[i] * v[i];
+  }
+
+  vnorm = sqrt(vnorm);
+
+  if(vnorm == 0.0)
+  {
+    std::fill(Jv, Jv + n, 0.0);
+    return;
+  }
+
+  //Forward difference with the increment balancing truncation and round-off
+  double epsilon = sqrt(DBL_EPSILON) * (1.0 + data->ynorm) / vnorm;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for(int i = 0; i < n; i++)
+  {
+    data->work[i] = data->y[i] + epsilon * v[i];
+  }
+
+  data->derivs(data->t, data->work, Jv, data->userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for(int i = 0; i < n; i++)
+  {
+    Jv[i] = (Jv[i] - data->dydt[i]) / epsilon;
+  }
+
+  if(data->products)
+    (*data->products)++;
+}
+
+/*!
+ * \brief The PhaseTimer class adds the wall time of its scope to a statistics time. A null time, passed when statistics
+ * are not collected, leaves the clock unread.
+ */
+class PhaseTimer
+{
+  public:
+
+    PhaseTimer(double *time)
+      : m_time(time)
+    {
+      if(m_time)
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    ~PhaseTimer()
+    {
+      if(m_time)
+        *m_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+  private:
+
+    double *m_time;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+//Header (magic, byte order, version, size), twelve ints, nine doubles and two statistics records
+static const size_t ODESOLVER_STATE_FIXED_SIZE = 4 * sizeof(unsigned int) + 12 * sizeof(int) + 9 * sizeof(double)
+                                                 + 2 * (11 * sizeof(long long) + 6 * sizeof(double));
+
+/*!
+ * \brief adamsWeights Integrals over [0, 1] of the Lagrange basis polynomials on nodes, so that the integral of the
+ * interpolant of values f at the nodes is the sum of weights[j] * f[j].
+ * \param nodes Distinct nodes in units of the step measured from its start.
+ * \param count Number of nodes, at most ADAMS_MAX_ORDER + 2.
+ * \param weights
+ */
+static void adamsWeights(const double nodes[], int count, double weights[])
+{
+  double poly[ADAMS_MAX_ORDER + 2];
+
+  for(int j = 0; j < count; j++)
+  {
+    poly[0] = 1.0;
+    int degree = 0;
+
+    for(int m = 0; m < count; m++)
+    {
+      if(m == j)
+        continue;
+
+      //Multiply by (x - nodes[m]) / (nodes[j] - nodes[m])
+      double scale = 1.0 / (nodes[j] - nodes[m]);
+      poly[degree + 1] = 0.0;
+
+      for(int p = degree + 1; p > 0; p--)
+        poly[p] = (poly[p - 1] - nodes[m] * poly[p]) * scale;
+
+      poly[0] *= -nodes[m] * scale;
+      degree++;
+    }
+
+    weights[j] = 0.0;
+
+    for(int p = degree; p >= 0; p--)
+      weights[j] += poly[p] / (p + 1);
+  }
+}
+
+ODESolverStatistics::ODESolverStatistics()
+{
+  reset();
+}
+
+void ODESolverStatistics::reset()
+{
+  solveCalls = 0;
+  derivativeEvaluations = 0;
+  acceptedSteps = 0;
+  rejectedSteps = 0;
+  jacobianEvaluations = 0;
+  linearSolverSetups = 0;
+  linearIterations = 0;
+  linearFailures = 0;
+  jacobianVectorProducts = 0;
+  nonLinearIterations = 0;
+  nonLinearFailures = 0;
+  minStep = 0.0;
+  maxStep = 0.0;
+  derivativeTime = 0.0;
+  solveTime = 0.0;
+  linearSolveTime = 0.0;
+  stepControlTime = 0.0;
+  kernels = ODEKernels::isaName(ODEKernels::isa());
+}
+
+void ODESolverStatistics::accumulate(const ODESolverStatistics &other)
+{
+  if(other.acceptedSteps)
+  {
+    minStep = acceptedSteps ? std::min(minStep, other.minStep) : other.minStep;
+    maxStep = acceptedSteps ? std::max(maxStep, other.maxStep) : other.maxStep;
+  }
+
+  solveCalls += other.solveCalls;
+  derivativeEvaluations += other.derivativeEvaluations;
+  acceptedSteps += other.acceptedSteps;
+  rejectedSteps += other.rejectedSteps;
+  jacobianEvaluations += other.jacobianEvaluations;
+  linearSolverSetups += other.linearSolverSetups;
+  linearIterations += other.linearIterations;
+  linearFailures += other.linearFailures;
+  jacobianVectorProducts += other.jacobianVectorProducts;
+  nonLinearIterations += other.nonLinearIterations;
+  nonLinearFailures += other.nonLinearFailures;
+  derivativeTime += other.derivativeTime;
+  solveTime += other.solveTime;
+  linearSolveTime += other.linearSolveTime;
+  stepControlTime += other.stepControlTime;
+  kernels = other.kernels;
+}
 
 ODESolver::ODESolver(int size, SolverType solverType)
   : m_size(size),
     m_maxSteps(50000),
     m_order(6),
+    m_currentIterations(0),
+    m_stepController(ELEMENTARY),
+    m_minStepRatio(0.1),
+    m_maxStepRatio(5.0),
+    m_controllerHistory(0),
     m_safety(0.9),
     m_pgrow(-0.2),
     m_pshrnk(-0.25),
@@ -62,21 +383,87 @@ ODESolver::ODESolver(int size, SolverType solverType)
     m_yerr(nullptr),
     m_ytemp(nullptr),
     m_ak(nullptr),
+    m_adamsState(nullptr),
+    m_adamsStep(0.0),
+    m_adamsOrder(1),
+    m_adamsCount(0),
+    m_adamsStepsAtOrder(0),
+    m_parallelExtrapolation(false),
+    m_gbsRows(0),
+    m_gbsParallel(false),
+    m_linearOperator(nullptr),
+    m_jacobianVectorProduct(nullptr),
+    m_maxKrylovDimension(30),
+    m_krylov(nullptr),
+    m_tileDerivatives(nullptr),
+    m_tileHalo(0),
+    m_tileSize(0),
     m_solverType(solverType),
-    #ifdef USE_CVODE
-    m_cvodeSolver(nullptr),
+    m_solver(nullptr),
+    m_initialized(false),
+    m_collectStatistics(false),
+    m_asyncSolve(nullptr),
+    m_jacobian(nullptr),
+    m_outputSink(nullptr),
+    m_outputStart(0.0),
+    m_outputInterval(0.0),
+    m_outputIndex(0),
     m_solverIterationMethod(ODESolver::IterationMethod::FUNCTIONAL),
-    m_linearSolverType(ODESolver::LinearSolverType::GMRES),
+    m_linearSolverType(ODESolver::LinearSolverType::GMRES)
+  #ifdef USE_CVODE
+    , m_cvodeSolver(nullptr),
     m_linearSolver(nullptr),
     m_nonLinearSolver(nullptr),
-    m_cvy (nullptr)
+    m_cvy (nullptr),
+    m_cvodeSteps(0),
+    m_cvodeNewtonIterations(0),
+    m_cvodeLinearIterations(0),
+    m_cvodeConvergenceFailures(0)
   #endif
 {
 }
 
 ODESolver::~ODESolver()
 {
+  if(m_lastAsyncSolve)
+    m_lastAsyncSolve->wait();
+
   clearMemory();
+  delete m_jacobian;
+}
+
+ODESolver *ODESolver::clone() const
+{
+  ODESolver *solver = new ODESolver(m_size, m_solverType);
+  solver->m_maxSteps = m_maxSteps;
+  solver->m_order = m_order;
+  solver->m_relTol = m_relTol;
+  solver->m_absTol = m_absTol;
+  solver->m_collectStatistics = m_collectStatistics;
+  solver->m_stepController = m_stepController;
+  solver->m_minStepRatio = m_minStepRatio;
+  solver->m_maxStepRatio = m_maxStepRatio;
+  solver->m_parallelExtrapolation = m_parallelExtrapolation;
+  solver->m_linearOperator = m_linearOperator;
+  solver->m_jacobianVectorProduct = m_jacobianVectorProduct;
+  solver->m_tileDerivatives = m_tileDerivatives;
+  solver->m_tileHalo = m_tileHalo;
+  solver->m_tileSize = m_tileSize;
+  solver->m_maxKrylovDimension = m_maxKrylovDimension;
+  solver->m_solverIterationMethod = m_solverIterationMethod;
+  solver->m_linearSolverType = m_linearSolverType;
+
+  if(m_jacobian)
+  {
+    solver->m_jacobian = new ODEJacobian(*m_jacobian);
+    solver->m_jacobian->setSparseDerivatives(nullptr);
+    solver->m_jacobian->invalidate();
+  }
+
+  if(m_initialized)
+    solver->initialize();
+
+  return solver;
 }
 
 void ODESolver::initialize()
@@ -93,10 +480,138 @@ void ODESolver::initialize()
     case RKQS:
       {
         m_solver = &ODESolver::rkqsDriver;
-        m_yscal = new double[m_size]();
-        m_yerr = new double[m_size]();
-        m_ytemp = new double[m_size]();
-        m_ak = new double[m_size * 5]();
+        m_yscal = ODEBatchState::allocate(m_size);
+        m_yerr = ODEBatchState::allocate(m_size);
+        m_ytemp = ODEBatchState::allocate(m_size);
+        m_ak = ODEBatchState::allocate(m_size * 5);
+
+        //First touch with the schedule of the rkck stage loops so pages are local to the threads using them
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+        for(int i = 0; i < m_size; i++)
+        {
+          m_yscal[i] = m_yerr[i] = m_ytemp[i] = 0.0;
+          m_ak[i] = m_ak[m_size + i] = m_ak[2 * m_size + i] = m_ak[3 * m_size + i] = m_ak[4 * m_size + i] = 0.0;
+        }
+      }
+      break;
+    case LSRK4:
+    case LSRK45:
+      {
+        m_solver = m_solverType == LSRK4 ? &ODESolver::lsrk4 : &ODESolver::lsrk45;
+
+        //Increment and stage derivative registers, plus the step start and error registers for LSRK45
+        m_ak = ODEBatchState::allocate(m_size * 2);
+
+        if(m_solverType == LSRK45)
+        {
+          m_ytemp = ODEBatchState::allocate(m_size);
+          m_yerr = ODEBatchState::allocate(m_size);
+        }
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+        for(int i = 0; i < m_size; i++)
+        {
+          m_ak[i] = m_ak[m_size + i] = 0.0;
+
+          if(m_ytemp)
+            m_ytemp[i] = m_yerr[i] = 0.0;
+        }
+      }
+      break;
+    case ADAMS:
+      {
+        m_solver = &ODESolver::adams;
+
+        int maxOrder = std::min(m_order, ADAMS_MAX_ORDER);
+
+        //History slots and the spare slot for the derivatives of the step being taken
+        m_ak = ODEBatchState::allocate(m_size * (maxOrder + 1));
+        m_ytemp = ODEBatchState::allocate(m_size);
+        m_adamsState = ODEBatchState::allocate(m_size);
+
+        m_adamsDerivatives.resize(maxOrder + 1);
+        m_adamsTimes.assign(maxOrder + 1, 0.0);
+
+        for(int j = 0; j <= maxOrder; j++)
+          m_adamsDerivatives[j] = m_ak + static_cast<size_t>(j) * m_size;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+        for(int i = 0; i < m_size; i++)
+        {
+          m_ytemp[i] = m_adamsState[i] = 0.0;
+
+          for(int j = 0; j <= maxOrder; j++)
+            m_ak[static_cast<size_t>(j) * m_size + i] = 0.0;
+        }
+      }
+      break;
+    case GBS:
+      {
+        m_solver = &ODESolver::gbs;
+
+        int rows = m_gbsRows = std::min(std::max(m_order, 4), GBS_MAX_ROWS);
+        m_gbsParallel = m_parallelExtrapolation;
+
+        //Extrapolation table and the derivatives at the start of the step, then the midpoint registers of one row or of every row
+        m_ak = ODEBatchState::allocate(m_size * (rows + 1));
+        m_yerr = ODEBatchState::allocate(m_size * 3 * (m_gbsParallel ? rows : 1));
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+        for(int i = 0; i < m_size; i++)
+        {
+          for(int j = 0; j <= rows; j++)
+            m_ak[static_cast<size_t>(j) * m_size + i] = 0.0;
+
+          for(int j = 0; j < 3 * (m_gbsParallel ? rows : 1); j++)
+            m_yerr[static_cast<size_t>(j) * m_size + i] = 0.0;
+        }
+      }
+      break;
+    case RKC:
+      {
+        m_solver = &ODESolver::rkc;
+
+        //Three rotating stage registers, the stage derivatives and the dominant direction, then the derivatives at the step start
+        m_ak = ODEBatchState::allocate(m_size * 5);
+        m_ytemp = ODEBatchState::allocate(m_size);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+        for(int i = 0; i < m_size; i++)
+        {
+          m_ak[i] = m_ak[m_size + i] = m_ak[2 * m_size + i] = m_ak[3 * m_size + i] = m_ak[4 * m_size + i] = 0.0;
+          m_ytemp[i] = 0.0;
+        }
+      }
+      break;
+    case EXPRK2:
+    case EXPRB32:
+      {
+        m_solver = &ODESolver::exponentialIntegrator;
+
+        //Exponential Euler state, defect, new state, stage derivatives and the difference point of the Jacobian products,
+        //then the derivatives at the step start
+        m_ak = ODEBatchState::allocate(m_size * 5);
+        m_ytemp = ODEBatchState::allocate(m_size);
+        m_krylov = new ODEKrylov(m_size, m_maxKrylovDimension);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+        for(int i = 0; i < m_size; i++)
+        {
+          m_ak[i] = m_ak[m_size + i] = m_ak[2 * m_size + i] = m_ak[3 * m_size + i] = m_ak[4 * m_size + i] = 0.0;
+          m_ytemp[i] = 0.0;
+        }
       }
       break;
 #ifdef  USE_CVODE
@@ -151,9 +666,13 @@ void ODESolver::initialize()
       break;
   }
 
+  m_initialized = true;
+
 
 }
 
+#ifdef USE_CVODE
+
 void ODESolver::initializeLinearSolver()
 {
   if(m_solverIterationMethod == ODESolver::IterationMethod::NEWTON)
@@ -164,38 +683,54 @@ void ODESolver::initializeLinearSolver()
         {
           m_linearSolver = SUNSPGMR(m_cvy, PREC_LEFT, 0);
           CVSpilsSetLinearSolver(m_cvodeSolver, m_linearSolver);
-          CVBandPrecInit(m_cvodeSolver, m_size, 2, 2);
         }
         break;
       case FGMRES:
         {
           m_linearSolver = SUNSPFGMR(m_cvy, PREC_LEFT, 0);
           CVSpilsSetLinearSolver(m_cvodeSolver, m_linearSolver);
-          CVBandPrecInit(m_cvodeSolver, m_size, 2, 2);
         }
         break;
       case Bi_CGStab:
         {
           m_linearSolver = SUNSPBCGS(m_cvy, PREC_LEFT, 0);
           CVSpilsSetLinearSolver(m_cvodeSolver, m_linearSolver);
-          CVBandPrecInit(m_cvodeSolver, m_size, 2, 2);
         }
         break;
       case TFQMR:
         {
           m_linearSolver = SUNSPTFQMR(m_cvy, PREC_LEFT, 0);
           CVSpilsSetLinearSolver(m_cvodeSolver, m_linearSolver);
-          CVBandPrecInit(m_cvodeSolver, m_size, 2, 2);
         }
         break;
       case PCG:
         {
           m_linearSolver = SUNPCG(m_cvy, PREC_LEFT, 0);
           CVSpilsSetLinearSolver(m_cvodeSolver, m_linearSolver);
-          CVBandPrecInit(m_cvodeSolver, m_size, 2, 2);
         }
         break;
     }
+
+    if(m_jacobianVectorProduct)
+    {
+      CVSpilsSetJacTimes(m_cvodeSolver, nullptr, &ODESolver::JacobianTimesVector_CVODE);
+    }
+
+    if(m_jacobian)
+    {
+      //Components below absTol / relTol are controlled absolutely, which sets the scale of their perturbation
+      m_jacobian->setPerturbationFloor(m_absTol / m_relTol);
+      m_jacobian->invalidate();
+
+      m_cvodeSteps = 0;
+      m_cvodeNewtonIterations = 0;
+      m_cvodeLinearIterations = 0;
+      CVSpilsSetPreconditioner(m_cvodeSolver, &ODESolver::PreconditionerSetup_CVODE, &ODESolver::PreconditionerSolve_CVODE);
+    }
+    else
+    {
+      CVBandPrecInit(m_cvodeSolver, m_size, 2, 2);
+    }
   }
 }
 
@@ -218,6 +753,8 @@ void ODESolver::initializeNonLinearSolver()
   CVodeSetNonlinearSolver(m_cvodeSolver, m_nonLinearSolver);
 }
 
+#endif
+
 int ODESolver::size() const
 {
   return m_size;
@@ -305,320 +842,2237 @@ void ODESolver::setAbsoluteTolerance(double tolerance)
   m_absTol = tolerance;
 }
 
-int ODESolver::solve(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
+ODESolver::StepController ODESolver::stepController() const
 {
-  return (this->*m_solver)(y, n, t, dt, yout, derivs, userData);
+  return m_stepController;
 }
 
-int ODESolver::euler(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
+void ODESolver::setStepController(StepController controller)
 {
-  double *dydt = new double[n]();
-  double tdt = t + dt;
-  derivs(tdt, y, dydt, userData);
-
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < n; i++)
-  {
-    yout[i] = y[i] + dt * dydt[i];
-  }
-
-  delete[] dydt;
+  m_stepController = controller;
+}
 
-  m_currentIterations = 1;
+double ODESolver::minStepRatio() const
+{
+  return m_minStepRatio;
+}
 
-  return 0;
+double ODESolver::maxStepRatio() const
+{
+  return m_maxStepRatio;
 }
 
-int ODESolver::rk4(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
+void ODESolver::setStepRatioLimits(double minRatio, double maxRatio)
 {
-  double tdt, dtt, dt6, *dym, *dyt, *yt, *dydt;
+  if(minRatio > 0.0 && minRatio < 1.0 && maxRatio > 1.0)
+  {
+    m_minStepRatio = minRatio;
+    m_maxStepRatio = maxRatio;
+  }
+}
 
-  dym = new double[n]();
-  dyt = new double[n]();
-  yt = new double[n]();
-  dydt = new double[n]();
+int ODESolver::solve(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
+{
+  if(m_outputSink)
+  {
+    double tOutput;
 
-  dtt = dt * 0.5;
-  dt6 = dt / 6.0;
+    while((tOutput = nextOutputTime()) < t)
+      m_outputIndex++;
 
-  tdt = t+dtt;
+    if(tOutput == t)
+    {
+      m_outputSink->write(t, y, n);
+      m_outputIndex++;
+    }
 
-  derivs(t, y, dydt, userData);
+    if(nextOutputTime() <= t + dt)
+    {
+      m_outputState.resize(n);
+      m_outputPrevious.assign(y, y + n);
+      m_outputPreviousDerivatives.resize(n);
+    }
+  }
 
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < n; i++)
+  if(!m_collectStatistics)
   {
-    yt[i] = y[i] + dtt * dydt[i]; //First step.
+    return (this->*m_solver)(y, n, t, dt, yout, derivs, userData);
   }
 
+  m_lastStatistics.reset();
+  m_lastStatistics.solveCalls = 1;
 
-  derivs(tdt, yt, dyt, userData); //Second step.
+  StatisticsRedirectionData redirectData;
+  redirectData.deriv = derivs;
+  redirectData.userData = userData;
+  redirectData.statistics = &m_lastStatistics;
 
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < n; i++)
-  {
-    yt[i] = y[i] + dtt * dyt[i];
-  }
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
+  int result = (this->*m_solver)(y, n, t, dt, yout, &ODESolver::ComputeDerivatives_Statistics, &redirectData);
 
-  derivs(tdt, yt, dym, userData); //Third step.
+  m_lastStatistics.solveTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  m_statistics.accumulate(m_lastStatistics);
 
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < n; i++)
-  {
-    yt[i] = y[i] + dt * dym[i];
-    dym[i] += dyt[i];
-  }
+  return result;
+}
 
-  derivs(t + dt, yt, dyt, userData); //Fourth step.
+std::shared_ptr<ODESolveHandle> ODESolver::solveAsync(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs,
+                                                     void *userData)
+{
+  std::shared_ptr<ODESolveHandle> handle(new ODESolveHandle(t, dt));
+  std::shared_ptr<ODESolveHandle> previous = m_lastAsyncSolve;
+  m_lastAsyncSolve = handle;
 
-#ifdef USE_OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < n; i++) //Accumulate increments with proper
+  std::function<void()> task = [this, handle, y, n, t, dt, yout, derivs, userData]()
   {
-    yout[i] = y[i] + dt6 * (dydt[i] + dyt[i] + 2.0 * dym[i]); //weights.
-  }
+    m_asyncSolve = handle.get();
+    int status = handle->cancelRequested() ? 4 : solve(y, n, t, dt, yout, derivs, userData);
+    m_asyncSolve = nullptr;
 
-  m_currentIterations = 1;
+    handle->finish(status);
+  };
+
+  //Solves on this solver run one after the other; a solve queued behind a running one is submitted when it finishes
+  if(!previous || !previous->setContinuation(task))
+    ODEThreadPool::instance().submit(task);
+
+  return handle;
+}
+
+bool ODESolver::parallelExtrapolation() const
+{
+  return m_parallelExtrapolation;
+}
+
+void ODESolver::setParallelExtrapolation(bool parallel)
+{
+  m_parallelExtrapolation = parallel;
+}
+
+ComputeLinearOperator ODESolver::linearOperator() const
+{
+  return m_linearOperator;
+}
+
+void ODESolver::setLinearOperator(ComputeLinearOperator linearOperator)
+{
+  m_linearOperator = linearOperator;
+}
+
+ComputeJacobianVectorProduct ODESolver::jacobianVectorProduct() const
+{
+  return m_jacobianVectorProduct;
+}
+
+void ODESolver::setJacobianVectorProduct(ComputeJacobianVectorProduct product)
+{
+  m_jacobianVectorProduct = product;
+}
+
+ComputeTileDerivatives ODESolver::tileDerivatives() const
+{
+  return m_tileDerivatives;
+}
+
+int ODESolver::tileHalo() const
+{
+  return m_tileHalo;
+}
+
+void ODESolver::setTileDerivatives(ComputeTileDerivatives derivs, int halo)
+{
+  m_tileDerivatives = derivs;
+  m_tileHalo = std::max(halo, 0);
+}
+
+int ODESolver::tileSize() const
+{
+  return m_tileSize;
+}
+
+void ODESolver::setTileSize(int size)
+{
+  m_tileSize = std::max(size, 0);
+}
+
+int ODESolver::maxKrylovDimension() const
+{
+  return m_maxKrylovDimension;
+}
+
+void ODESolver::setMaxKrylovDimension(int dimension)
+{
+  m_maxKrylovDimension = std::max(dimension, 1);
+}
+
+void ODESolver::resetHistory()
+{
+  m_adamsCount = 0;
+}
+
+bool ODESolver::collectStatistics() const
+{
+  return m_collectStatistics;
+}
+
+void ODESolver::setCollectStatistics(bool collect)
+{
+  m_collectStatistics = collect;
+}
+
+const ODESolverStatistics &ODESolver::statistics() const
+{
+  return m_statistics;
+}
+
+const ODESolverStatistics &ODESolver::lastStatistics() const
+{
+  return m_lastStatistics;
+}
+
+void ODESolver::resetStatistics()
+{
+  m_statistics.reset();
+  m_lastStatistics.reset();
+}
+
+size_t ODESolver::stateSize() const
+{
+  return ODESOLVER_STATE_FIXED_SIZE + scratchSize() * sizeof(double);
+}
+
+size_t ODESolver::saveState(char *buffer) const
+{
+  char *current = buffer;
+  unsigned int scratchSize = this->scratchSize();
+  int iterationMethod = m_solverIterationMethod;
+  int linearSolverType = m_linearSolverType;
+
+  writeStateValue(current, ODESOLVER_STATE_MAGIC);
+  writeStateValue(current, ODESOLVER_STATE_BYTE_ORDER);
+  writeStateValue(current, static_cast<unsigned int>(ODESOLVER_STATE_VERSION));
+  writeStateValue(current, scratchSize);
+
+  writeStateValue(current, m_size);
+  writeStateValue(current, static_cast<int>(m_solverType));
+  writeStateValue(current, iterationMethod);
+  writeStateValue(current, linearSolverType);
+  writeStateValue(current, m_maxSteps);
+  writeStateValue(current, m_order);
+  writeStateValue(current, m_currentIterations);
+  writeStateValue(current, static_cast<int>(m_collectStatistics));
+
+  writeStateValue(current, m_safety);
+  writeStateValue(current, m_pgrow);
+  writeStateValue(current, m_pshrnk);
+  writeStateValue(current, m_errcon);
+  writeStateValue(current, m_relTol);
+  writeStateValue(current, m_absTol);
+
+  writeStateValue(current, static_cast<int>(m_stepController));
+  writeStateValue(current, m_minStepRatio);
+  writeStateValue(current, m_maxStepRatio);
+
+  writeStateValue(current, m_adamsOrder);
+  writeStateValue(current, m_adamsCount);
+  writeStateValue(current, m_adamsStepsAtOrder);
+  writeStateValue(current, m_adamsStep);
+
+  writeStateStatistics(current, m_statistics);
+  writeStateStatistics(current, m_lastStatistics);
+
+  if(scratchSize && m_adamsState)
+  {
+    //History newest first without the spare slot, then the state at the newest time
+    int slots = static_cast<int>(m_adamsDerivatives.size()) - 1;
+
+    memcpy(current, m_adamsTimes.data(), slots * sizeof(double)); current += slots * sizeof(double);
+
+    for(int j = 0; j < slots; j++)
+    {
+      memcpy(current, m_adamsDerivatives[j], m_size * sizeof(double)); current += m_size * sizeof(double);
+    }
+
+    memcpy(current, m_adamsState, m_size * sizeof(double)); current += m_size * sizeof(double);
+  }
+  else if(scratchSize)
+  {
+    //Dominant direction that starts the next RKC spectral radius estimate
+    memcpy(current, m_ak + 4 * m_size, m_size * sizeof(double)); current += m_size * sizeof(double);
+  }
+
+  return current - buffer;
+}
+
+std::vector<char> ODESolver::saveState() const
+{
+  std::vector<char> state(stateSize());
+  saveState(state.data());
+  return state;
+}
+
+int ODESolver::restoreState(const char *buffer, size_t size)
+{
+  if(size < ODESOLVER_STATE_FIXED_SIZE)
+    return 1;
+
+  const char *current = buffer;
+  unsigned int magic, byteOrder, version, scratchSize;
+
+  readStateValue(current, magic);
+  readStateValue(current, byteOrder);
+  readStateValue(current, version);
+  readStateValue(current, scratchSize);
+
+  if(magic != ODESOLVER_STATE_MAGIC || byteOrder != ODESOLVER_STATE_BYTE_ORDER || version != ODESOLVER_STATE_VERSION)
+    return 2;
+
+  if(size < ODESOLVER_STATE_FIXED_SIZE + scratchSize * sizeof(double))
+    return 1;
+
+  int savedSize, solverType, iterationMethod, linearSolverType, collectStatistics;
+
+  readStateValue(current, savedSize);
+  readStateValue(current, solverType);
+  readStateValue(current, iterationMethod);
+  readStateValue(current, linearSolverType);
+
+#ifdef USE_CVODE
+  if(solverType < 0 || solverType > EXPRB32)
+    return 3;
+#else
+  if(solverType < 0 || (solverType > RKQS && solverType != LSRK4 && solverType != LSRK45 && solverType != ADAMS &&
+                        solverType != GBS && solverType != RKC && solverType != EXPRK2 && solverType != EXPRB32))
+    return 3;
+#endif
+
+  bool reinitialize = !m_initialized || savedSize != m_size || solverType != m_solverType;
+
+  m_size = savedSize;
+  m_solverType = static_cast<SolverType>(solverType);
+
+#ifdef USE_CVODE
+  reinitialize = reinitialize || iterationMethod != m_solverIterationMethod || linearSolverType != m_linearSolverType;
+#endif
+
+  m_solverIterationMethod = static_cast<IterationMethod>(iterationMethod);
+  m_linearSolverType = static_cast<LinearSolverType>(linearSolverType);
+
+  int maxSteps = m_maxSteps, order = m_order;
+  double relTol = m_relTol, absTol = m_absTol;
+
+  readStateValue(current, m_maxSteps);
+  readStateValue(current, m_order);
+  readStateValue(current, m_currentIterations);
+  readStateValue(current, collectStatistics);
+  m_collectStatistics = collectStatistics != 0;
+
+  readStateValue(current, m_safety);
+  readStateValue(current, m_pgrow);
+  readStateValue(current, m_pshrnk);
+  readStateValue(current, m_errcon);
+  readStateValue(current, m_relTol);
+  readStateValue(current, m_absTol);
+
+  int stepController;
+  readStateValue(current, stepController);
+  //Unknown controllers fall back to the elementary one rather than failing half way through the state
+  m_stepController = stepController >= ELEMENTARY && stepController <= H312PID ? static_cast<StepController>(stepController) : ELEMENTARY;
+  readStateValue(current, m_minStepRatio);
+  readStateValue(current, m_maxStepRatio);
+
+  //Applied after initialize, which clears the history
+  int adamsOrder, adamsCount, adamsStepsAtOrder;
+  double adamsStep;
+  readStateValue(current, adamsOrder);
+  readStateValue(current, adamsCount);
+  readStateValue(current, adamsStepsAtOrder);
+  readStateValue(current, adamsStep);
+
+  readStateStatistics(current, m_statistics);
+  readStateStatistics(current, m_lastStatistics);
+
+#ifdef USE_CVODE
+  //Tolerances, order and step limit are applied to CVODE when it is created
+  reinitialize = reinitialize || (m_cvodeSolver && (maxSteps != m_maxSteps || order != m_order ||
+                                                    relTol != m_relTol || absTol != m_absTol));
+#else
+  (void)maxSteps; (void)relTol; (void)absTol;
+#endif
+
+  //The order sets the number of ADAMS history slots and GBS rows
+  reinitialize = reinitialize || ((m_solverType == ADAMS || m_solverType == GBS) && order != m_order);
+
+  if(reinitialize)
+    initialize();
+
+  if(scratchSize && scratchSize == this->scratchSize())
+  {
+    if(m_adamsState)
+    {
+      int slots = static_cast<int>(m_adamsDerivatives.size()) - 1;
+
+      memcpy(m_adamsTimes.data(), current, slots * sizeof(double)); current += slots * sizeof(double);
+
+      for(int j = 0; j < slots; j++)
+      {
+        memcpy(m_adamsDerivatives[j], current, m_size * sizeof(double)); current += m_size * sizeof(double);
+      }
+
+      memcpy(m_adamsState, current, m_size * sizeof(double)); current += m_size * sizeof(double);
+
+      m_adamsOrder = adamsOrder;
+      m_adamsCount = std::min(adamsCount, slots);
+      m_adamsStepsAtOrder = adamsStepsAtOrder;
+      m_adamsStep = adamsStep;
+    }
+    else
+    {
+      memcpy(m_ak + 4 * m_size, current, m_size * sizeof(double)); current += m_size * sizeof(double);
+    }
+  }
+  else
+  {
+    resetHistory();
+  }
+
+  return 0;
+}
+
+void ODESolver::setOutputSink(ODEOutputSink *sink, const std::vector<double> &outputTimes)
+{
+  m_outputSink = sink;
+  m_outputTimes = outputTimes;
+  m_outputInterval = 0.0;
+  m_outputIndex = 0;
+}
+
+void ODESolver::setOutputSink(ODEOutputSink *sink, double start, double interval)
+{
+  m_outputSink = sink;
+  m_outputTimes.clear();
+  m_outputStart = start;
+  m_outputInterval = interval;
+  m_outputIndex = 0;
+}
+
+ODEOutputSink *ODESolver::outputSink() const
+{
+  return m_outputSink;
+}
+
+void ODESolver::setJacobianPattern(const ODESparsityPattern &pattern)
+{
+  delete m_jacobian;
+  m_jacobian = new ODEJacobian(pattern);
+}
+
+ODEJacobian *ODESolver::jacobian() const
+{
+  return m_jacobian;
+}
+
+double ODESolver::nextOutputTime() const
+{
+  if(!m_outputSink)
+    return HUGE_VAL;
+  else if(m_outputInterval > 0.0)
+    return m_outputStart + m_outputIndex * m_outputInterval;
+  else if(m_outputIndex < static_cast<long long>(m_outputTimes.size()))
+    return m_outputTimes[m_outputIndex];
+
+  return HUGE_VAL;
+}
+
+void ODESolver::writeOutput(double t0, const double y0[], const double dydt0[], double t1, const double y1[], const double dydt1[], int n)
+{
+  double h = t1 - t0;
+  double tOutput;
+
+  while((tOutput = nextOutputTime()) <= t1)
+  {
+    double s = (tOutput - t0) / h;
+
+    if(dydt0 && dydt1)
+    {
+      double h00 = (1.0 + 2.0 * s) * (1.0 - s) * (1.0 - s);
+      double h10 = s * (1.0 - s) * (1.0 - s) * h;
+      double h01 = s * s * (3.0 - 2.0 * s);
+      double h11 = s * s * (s - 1.0) * h;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < n; i++)
+      {
+        m_outputState[i] = h00 * y0[i] + h10 * dydt0[i] + h01 * y1[i] + h11 * dydt1[i];
+      }
+    }
+    else
+    {
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for(int i = 0; i < n; i++)
+      {
+        m_outputState[i] = (1.0 - s) * y0[i] + s * y1[i];
+      }
+    }
+
+    m_outputSink->write(tOutput, tOutput == t1 ? y1 : m_outputState.data(), n);
+    m_outputIndex++;
+  }
+}
+
+void ODESolver::ComputeDerivatives_Statistics(double t, double y[], double dydt[], void *userData)
+{
+  StatisticsRedirectionData *redirectData = static_cast<StatisticsRedirectionData*>(userData);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  redirectData->deriv(t, y, dydt, redirectData->userData);
+
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  //GBS evaluates the midpoint sequences of a step on several threads in its parallel mode
+#ifdef USE_OPENMP
+#pragma omp atomic
+#endif
+  redirectData->statistics->derivativeTime += elapsed;
+
+#ifdef USE_OPENMP
+#pragma omp atomic
+#endif
+  redirectData->statistics->derivativeEvaluations++;
+}
+
+void *ODESolver::callerData(ComputeDerivatives derivs, void *userData)
+{
+  return derivs == &ODESolver::ComputeDerivatives_Statistics ? static_cast<StatisticsRedirectionData*>(userData)->userData : userData;
+}
+
+unsigned int ODESolver::scratchSize() const
+{
+  //RKQS and the other solvers rewrite their scratch before reading it, so only state a later solve reads is kept
+  if(m_adamsState)
+    return static_cast<unsigned int>(m_adamsDerivatives.size() - 1) * (m_size + 1) + m_size;
+  else if(m_solverType == RKC && m_ak)
+    return m_size;
+
+  return 0;
+}
+
+void ODESolver::resetStepController()
+{
+  m_controllerHistory = 0;
+}
+
+double ODESolver::stepRatio(double errmax, double pgrow, bool rejected)
+{
+  PhaseTimer timer(m_collectStatistics ? &m_lastStatistics.stepControlTime : nullptr);
+
+  if(m_stepController == ELEMENTARY)
+  {
+    //Zero error gives an infinite ratio, capped like any other
+    return std::min(m_safety * pow(errmax, pgrow), m_maxStepRatio);
+  }
+
+  //Exponents beta1..beta3 on the last three errors and alpha2, alpha3 on the last two ratios, per unit 1/k
+  static const double filters[3][5] =
+  {
+    {3.0 / 5.0, -1.0 / 5.0, 0.0, 0.0, 0.0},
+    {1.0 / 6.0, 1.0 / 6.0, 0.0, 0.0, 0.0},
+    {1.0 / 18.0, 1.0 / 9.0, 1.0 / 18.0, 0.0, 0.0}
+  };
+
+  const double *filter = filters[m_stepController - PI42];
+  const double k = -1.0 / pgrow;
+
+  //The filters aim at an error of safety^k per unit tolerance, the equilibrium of the elementary controller
+  double target = pow(m_safety, k);
+  double error = std::max(errmax, 1e-10);
+
+  //Before enough steps are accepted the missing history repeats the current step
+  double error1 = m_controllerHistory > 0 ? m_controllerErrors[0] : error;
+  double error2 = m_controllerHistory > 1 ? m_controllerErrors[1] : error1;
+  double ratio1 = m_controllerHistory > 0 ? m_controllerRatios[0] : 1.0;
+  double ratio2 = m_controllerHistory > 1 ? m_controllerRatios[1] : ratio1;
+
+  double ratio = pow(target / error, filter[0] / k) * pow(target / error1, filter[1] / k) * pow(target / error2, filter[2] / k) *
+                 pow(ratio1, -filter[3]) * pow(ratio2, -filter[4]);
+
+  ratio = 1.0 + atan(ratio - 1.0);
+  ratio = std::min(std::max(ratio, m_minStepRatio), rejected ? 1.0 : m_maxStepRatio);
+
+  m_controllerErrors[1] = error1;
+  m_controllerErrors[0] = error;
+  m_controllerRatios[1] = ratio1;
+  m_controllerRatios[0] = ratio;
+  m_controllerHistory = std::min(m_controllerHistory + 1, 2);
+
+  return ratio;
+}
+
+bool ODESolver::interrupted(double t)
+{
+  if(!m_asyncSolve)
+    return false;
+
+  m_asyncSolve->setCurrentTime(t);
+
+  return m_asyncSolve->cancelRequested();
+}
+
+void ODESolver::recordStep(double dt, bool accepted)
+{
+  if(accepted)
+  {
+    dt = fabs(dt);
+    m_lastStatistics.minStep = m_lastStatistics.acceptedSteps ? std::min(m_lastStatistics.minStep, dt) : dt;
+    m_lastStatistics.maxStep = m_lastStatistics.acceptedSteps ? std::max(m_lastStatistics.maxStep, dt) : dt;
+    m_lastStatistics.acceptedSteps++;
+  }
+  else
+  {
+    m_lastStatistics.rejectedSteps++;
+  }
+}
+
+int ODESolver::euler(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
+{
+  double *dydt = new double[n]();
+  double tdt = t + dt;
+  derivs(tdt, y, dydt, userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < n; i++)
+  {
+    yout[i] = y[i] + dt * dydt[i];
+  }
 
-  delete[] yt;
-  delete[] dyt;
-  delete[] dym;
   delete[] dydt;
 
+  m_currentIterations = 1;
+
+  if(m_collectStatistics)
+    recordStep(dt, true);
+
+  if(nextOutputTime() <= tdt)
+    writeOutput(t, m_outputPrevious.data(), nullptr, tdt, yout, nullptr, n);
+
   return 0;
 }
 
-int ODESolver::rkqsDriver(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
-{
+int ODESolver::rk4(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
+{
+  if(m_tileDerivatives)
+    return rk4Tiled(y, n, t, dt, yout, derivs, userData);
+
+  double tdt, dtt, dt6, *dym, *dyt, *yt, *dydt;
+
+  dym = new double[n]();
+  dyt = new double[n]();
+  yt = new double[n]();
+  dydt = new double[n]();
+
+  dtt = dt * 0.5;
+  dt6 = dt / 6.0;
+
+  tdt = t+dtt;
+
+  const double one = 1.0, weights[3] = {1.0, 1.0, 2.0};
+
+  derivs(t, y, dydt, userData);
+
+  ODEKernels::combine(n, 1, y, &dtt, 1, &one, &dydt, yt, true); //First step.
+
+  derivs(tdt, yt, dyt, userData); //Second step.
+
+  ODEKernels::combine(n, 1, y, &dtt, 1, &one, &dyt, yt, true);
+
+  derivs(tdt, yt, dym, userData); //Third step.
+
+  ODEKernels::combine(n, 1, y, &dt, 1, &one, &dym, yt, true);
+  ODEKernels::combine(n, 1, dym, &one, 1, &one, &dyt, dym, true);
+
+  derivs(t + dt, yt, dyt, userData); //Fourth step.
+
+  //Accumulate increments with proper weights.
+  const double *increments[3] = {dydt, dyt, dym};
+  ODEKernels::combine(n, 1, y, &dt6, 3, weights, increments, yout, true);
+
+  m_currentIterations = 1;
+
+  if(m_collectStatistics)
+    recordStep(dt, true);
+
+  if(nextOutputTime() <= t + dt)
+  {
+    //y may share storage with yout so the start of the step comes from the copy made in solve
+    derivs(t + dt, yout, dyt, userData);
+    writeOutput(t, m_outputPrevious.data(), dydt, t + dt, yout, dyt, n);
+  }
+
+  delete[] yt;
+  delete[] dyt;
+  delete[] dym;
+  delete[] dydt;
+
+  return 0;
+}
+
+int ODESolver::rk4Tiled(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void *userData)
+{
+  const double dtt = dt * 0.5, dt6 = dt / 6.0, tdt = t + dtt;
+  const double one = 1.0, weights[3] = {1.0, 1.0, 2.0};
+  const int halo = m_tileHalo;
+
+  //The first stage is needed four halos out for the last stage of the tile
+  const int reach = 4 * halo;
+  const int tile = tileComponents(5);
+  const int numTiles = (n + tile - 1) / tile;
+  const int window = std::min(tile + 2 * reach, n);
+
+  ComputeTileDerivatives tileDerivs = m_tileDerivatives;
+  void *data = callerData(derivs, userData);
+
+  //y may share storage with yout while neighbouring tiles still read it
+  double *ynew = new double[n];
+
+#ifdef USE_OPENMP
+#pragma omp parallel
+#endif
+  {
+    std::vector<double> work(5 * static_cast<size_t>(window));
+    double *yt = work.data(), *dydt = yt + window, *dyt = dydt + window, *dym = dyt + window, *dy4 = dym + window;
+    double tileTime = 0.0, *time = m_collectStatistics ? &tileTime : nullptr;
+
+#ifdef USE_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for (int j = 0; j < numTiles; j++)
+    {
+      const int a = j * tile, b = std::min(a + tile, n);
+      const int lo = std::max(a - reach, 0);
+
+      //Stage j is computed j - 1 halos out from the tile
+      int kb = std::max(a - 3 * halo, 0), ke = std::min(b + 3 * halo, n);
+      {
+        PhaseTimer timer(time);
+        tileDerivs(t, y + lo, dydt, lo, kb, ke, data); //First step.
+      }
+
+      kb = std::max(a - 2 * halo, 0); ke = std::min(b + 2 * halo, n);
+      int yb = std::max(kb - halo, 0), ye = std::min(ke + halo, n);
+      const double *k = dydt + (yb - lo);
+      ODEKernels::combine(ye - yb, 1, y + yb, &dtt, 1, &one, &k, yt + (yb - lo), false);
+
+      {
+        PhaseTimer timer(time);
+        tileDerivs(tdt, yt, dyt, lo, kb, ke, data); //Second step.
+      }
+
+      kb = std::max(a - halo, 0); ke = std::min(b + halo, n);
+      yb = std::max(kb - halo, 0); ye = std::min(ke + halo, n);
+      k = dyt + (yb - lo);
+      ODEKernels::combine(ye - yb, 1, y + yb, &dtt, 1, &one, &k, yt + (yb - lo), false);
+
+      {
+        PhaseTimer timer(time);
+        tileDerivs(tdt, yt, dym, lo, kb, ke, data); //Third step.
+      }
+
+      yb = std::max(a - halo, 0); ye = std::min(b + halo, n);
+      k = dym + (yb - lo);
+      ODEKernels::combine(ye - yb, 1, y + yb, &dt, 1, &one, &k, yt + (yb - lo), false);
+      k = dyt + (a - lo);
+      ODEKernels::combine(b - a, 1, dym + (a - lo), &one, 1, &one, &k, dym + (a - lo), false);
+
+      {
+        PhaseTimer timer(time);
+        tileDerivs(t + dt, yt, dy4, lo, a, b, data); //Fourth step.
+      }
+
+      //The same kernels as rk4 over the subranges, so the result does not depend on the tiling
+      const double *increments[3] = {dydt + (a - lo), dy4 + (a - lo), dym + (a - lo)};
+      ODEKernels::combine(b - a, 1, y + a, &dt6, 3, weights, increments, ynew + a, false);
+    }
+
+#ifdef USE_OPENMP
+#pragma omp atomic
+#endif
+    m_lastStatistics.derivativeTime += tileTime;
+  }
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < n; i++)
+  {
+    yout[i] = ynew[i];
+  }
+
+  delete[] ynew;
+
+  m_currentIterations = 1;
+
+  if(m_collectStatistics)
+  {
+    //The tile sweeps count as whole evaluations; the halo overlap is not counted but its time is
+    m_lastStatistics.derivativeEvaluations += 4;
+    recordStep(dt, true);
+  }
+
+  if(nextOutputTime() <= t + dt)
+  {
+    std::vector<double> dydt0(n), dydt1(n);
+    derivs(t, m_outputPrevious.data(), dydt0.data(), userData);
+    derivs(t + dt, yout, dydt1.data(), userData);
+    writeOutput(t, m_outputPrevious.data(), dydt0.data(), t + dt, yout, dydt1.data(), n);
+  }
+
+  return 0;
+}
+
+int ODESolver::rkqsDriver(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
+{
+
+  double tDid, tNext;
+  double t_est = t;
+  double dt_est = dt;
+  double t_end = t+dt;
+
+  std::fill(m_yscal, m_yscal + n, 0.0);
+  std::fill(m_yerr, m_yerr + n, 0.0);
+  std::fill(m_ytemp, m_ytemp + n, 0.0);
+  std::fill(m_ak, m_ak + 5 * n, 0.0);
+  double *dydt = new double[n]();
+
+  resetStepController();
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int i= 0; i < n; i++)
+  {
+    yout[i] = y[i];
+  }
+
+  bool output = nextOutputTime() <= t_end;
+  bool derivsCurrent = false;
+
+  for (int nstp = 1; nstp <= m_maxSteps; nstp++)
+  {
+    m_currentIterations = nstp;
+
+    if(!derivsCurrent)
+      derivs(t_est, yout, dydt, userData);
+
+    derivsCurrent = false;
+
+    {
+      PhaseTimer timer(m_collectStatistics ? &m_lastStatistics.stepControlTime : nullptr);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for (int i= 0; i < n; i++)
+      {
+        m_yscal[i] = fabs(yout[i]) + fabs(dydt[i] * dt_est) + ODE_TINY;
+      }
+    }
+
+    if (((t_est + dt_est) - t_end) * (t_est + dt_est - t) > 0.0)
+    {
+      dt_est = t + dt - t_est;
+    }
+
+    if(output)
+    {
+      std::copy(yout, yout + n, m_outputPrevious.begin());
+      std::copy(dydt, dydt + n, m_outputPreviousDerivatives.begin());
+    }
+
+    double tStep = t_est;
+
+    if(rkqs(&t_est, dydt, yout, n, dt_est, &tDid, &tNext, derivs, userData))
+    {
+      break;
+    }
+
+    if(output && nextOutputTime() <= t_est)
+    {
+      derivs(t_est, yout, dydt, userData);
+      derivsCurrent = true;
+      writeOutput(tStep, m_outputPrevious.data(), m_outputPreviousDerivatives.data(), t_est, yout, dydt, n);
+      output = nextOutputTime() <= t_end;
+    }
+
+    if( (t_est - t_end) * (t_end - t) >= 0.0)
+    {
+      delete[] dydt;
+      return 0;
+    }
+
+    if(interrupted(t_est))
+    {
+      delete[] dydt;
+      return 4;
+    }
+
+    if (fabs(tNext) <= 0.0)
+    {
+      delete[] dydt;
+      return 2;
+    }
+
+    dt_est = tNext;
+  }
+
+  delete[] dydt;
+
+  return 3;
+}
+
+int ODESolver::rkqs(double *t, double dydt[], double yout[], int n, double dtTry, double *dtDid, double *dtNext, ComputeDerivatives derivs, void* userData)
+{
+  double errmax, dt, dtTemp, tnew, told = *t;
+  bool rejected = false;
+
+  // --- set initial stepsize
+  dt = dtTry;
+
+  for (;;)
+  {
+    // --- take a Runge-Kutta-Cash-Karp step
+    if(m_tileDerivatives)
+      rkckTiled(told, dydt, yout, n, dt, callerData(derivs, userData));
+    else
+      rkck(told, dydt, yout, n, dt, derivs, userData);
+
+    // --- compute scaled maximum error
+    {
+      PhaseTimer timer(m_collectStatistics ? &m_lastStatistics.stepControlTime : nullptr);
+
+      errmax = 0.0;
+      ODEKernels::maxScaledError(n, 1, m_yerr, m_yscal, &errmax, true);
+
+      errmax /= m_relTol;
+    }
+
+    // --- error too large; reduce stepsize & repeat
+    if (errmax > 1.0)
+    {
+      if(m_collectStatistics)
+        recordStep(dt, false);
+
+      rejected = true;
+      dtTemp = m_safety * dt * pow( errmax, m_pshrnk);
+
+      if (dt >= 0)
+      {
+        if (dtTemp > m_minStepRatio * dt)
+          dt = dtTemp;
+        else
+          dt = m_minStepRatio * dt;
+      }
+      else
+      {
+        if (dtTemp < m_minStepRatio * dt)
+          dt = dtTemp;
+        else
+          dt = m_minStepRatio * dt;
+      }
+
+      tnew = told + dt;
+
+      if (tnew == told)
+        return 2;
+
+      continue;
+    }
+
+    // --- step succeeded; compute size of next step
+    else
+    {
+      *dtNext = dt * stepRatio(errmax, m_pgrow, rejected);
+
+      *t += (*dtDid = dt);
+
+      if(m_collectStatistics)
+        recordStep(dt, true);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for (int i = 0; i< n; i++)
+      {
+        yout[i] = m_ytemp[i];
+      }
+
+      return 0;
+    }
+  }
+}
+
+void ODESolver::rkck(double t, double dydt[], double yout[], int n, double dt, ComputeDerivatives derivs, void* userData)
+{
+  double *k[6] = {dydt, &m_ak[0], &m_ak[n], &m_ak[2*n], &m_ak[3*n], &m_ak[4*n]};
+
+  for (int s = 1; s < 6; s++)
+  {
+    ODEKernels::combine(n, 1, yout, &dt, s, RKCK_B[s - 1], k, m_ytemp, true);
+    derivs(t + RKCK_A[s] * dt, m_ytemp, k[s], userData);
+  }
+
+  const double *solution[4] = {k[0], k[2], k[3], k[5]};
+  const double *error[5] = {k[0], k[2], k[3], k[4], k[5]};
+
+  ODEKernels::combine(n, 1, yout, &dt, 4, RKCK_C, solution, m_ytemp, true);
+  ODEKernels::combine(n, 1, nullptr, &dt, 5, RKCK_DC, error, m_yerr, true);
+}
+
+void ODESolver::rkckTiled(double t, double dydt[], double yout[], int n, double dt, void *userData)
+{
+  const int halo = m_tileHalo;
+
+  //The second stage is needed four halos out for the sixth, and its argument five
+  const int reach = 5 * halo;
+  const int tile = tileComponents(6);
+  const int numTiles = (n + tile - 1) / tile;
+  const int window = std::min(tile + 2 * reach, n);
+
+  ComputeTileDerivatives tileDerivs = m_tileDerivatives;
+
+#ifdef USE_OPENMP
+#pragma omp parallel
+#endif
+  {
+    std::vector<double> work(6 * static_cast<size_t>(window));
+    double *ytemp = work.data();
+    double *ak[5] = {ytemp + window, ytemp + 2 * window, ytemp + 3 * window, ytemp + 4 * window, ytemp + 5 * window};
+    double tileTime = 0.0, *time = m_collectStatistics ? &tileTime : nullptr;
+
+#ifdef USE_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for (int j = 0; j < numTiles; j++)
+    {
+      const int a = j * tile, b = std::min(a + tile, n);
+      const int lo = std::max(a - reach, 0);
+      const double *k[5];
+
+      //Stage s + 1 is computed 5 - s halos out from the tile and its argument one halo further, with the kernels of rkck
+      for (int s = 1; s < 6; s++)
+      {
+        int kb = std::max(a - (5 - s) * halo, 0), ke = std::min(b + (5 - s) * halo, n);
+        int yb = std::max(kb - halo, 0), ye = std::min(ke + halo, n);
+
+        k[0] = dydt + yb;
+
+        for (int m = 1; m < s; m++)
+          k[m] = ak[m - 1] + (yb - lo);
+
+        ODEKernels::combine(ye - yb, 1, yout + yb, &dt, s, RKCK_B[s - 1], k, ytemp + (yb - lo), false);
+
+        PhaseTimer timer(time);
+        tileDerivs(t + RKCK_A[s] * dt, ytemp, ak[s - 1], lo, kb, ke, userData);
+      }
+
+      const double *solution[4] = {dydt + a, ak[1] + (a - lo), ak[2] + (a - lo), ak[4] + (a - lo)};
+      const double *error[5] = {dydt + a, ak[1] + (a - lo), ak[2] + (a - lo), ak[3] + (a - lo), ak[4] + (a - lo)};
+
+      ODEKernels::combine(b - a, 1, yout + a, &dt, 4, RKCK_C, solution, m_ytemp + a, false);
+      ODEKernels::combine(b - a, 1, nullptr, &dt, 5, RKCK_DC, error, m_yerr + a, false);
+    }
+
+#ifdef USE_OPENMP
+#pragma omp atomic
+#endif
+    m_lastStatistics.derivativeTime += tileTime;
+  }
+
+  if(m_collectStatistics)
+    m_lastStatistics.derivativeEvaluations += 5;
+}
+
+int ODESolver::tileComponents(int arrays) const
+{
+  if(m_tileSize > 0)
+    return m_tileSize;
+
+  //Keep the stage arrays of a tile window within a typical L2 cache, and the redundant halo work below about a quarter
+  int size = static_cast<int>(ODESOLVER_TILE_CACHE_BYTES / (arrays * sizeof(double)));
+
+  return std::max(size, 16 * m_tileHalo * arrays);
+}
+
+int ODESolver::lsrk4(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
+{
+  double *dq = m_ak, *k = m_ak + n;
+
+  //The first stage reads y so yout holds the stage solution from then on
+  derivs(t, y, k, userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < n; i++)
+  {
+    dq[i] = dt * k[i];
+    yout[i] = y[i] + LSRK_B[0] * dq[i];
+  }
+
+  for (int s = 1; s < 5; s++)
+  {
+    derivs(t + LSRK_C[s] * dt, yout, k, userData);
+
+    const double a = LSRK_A[s], b = LSRK_B[s];
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; i++)
+    {
+      dq[i] = a * dq[i] + dt * k[i];
+      yout[i] += b * dq[i];
+    }
+  }
+
+  m_currentIterations = 1;
+
+  if(m_collectStatistics)
+    recordStep(dt, true);
+
+  if(nextOutputTime() <= t + dt)
+    writeOutput(t, m_outputPrevious.data(), nullptr, t + dt, yout, nullptr, n);
+
+  return 0;
+}
+
+int ODESolver::lsrk45(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
+{
+  //Error per unit tolerance goes as dt^4 for the third order estimate
+  const double pgrow = -0.25, pshrnk = -1.0 / 3.0;
+
+  double *ystart = m_ytemp, *err = m_yerr, *dq = m_ak, *k = m_ak + n;
+  double t_est = t;
+  double dt_est = dt;
+  double t_end = t + dt;
+
+  if(yout != y)
+  {
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; i++)
+    {
+      yout[i] = y[i];
+    }
+  }
+
+  resetStepController();
+
+  for (int nstp = 1; nstp <= m_maxSteps; nstp++)
+  {
+    m_currentIterations = nstp;
+
+    if (((t_est + dt_est) - t_end) * (t_est + dt_est - t) > 0.0)
+    {
+      dt_est = t_end - t_est;
+    }
+
+    double errmax;
+    bool rejected = false;
+
+    for (;;)
+    {
+      const double h = dt_est;
+
+      //A rejected step restores the same start so its first stage is evaluated again rather than kept in a sixth register
+      derivs(t_est, yout, k, userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for (int i = 0; i < n; i++)
+      {
+        ystart[i] = yout[i];
+        dq[i] = h * k[i];
+        err[i] = LSRK_E[0] * dq[i];
+        yout[i] += LSRK_B[0] * dq[i];
+      }
+
+      for (int s = 1; s < 4; s++)
+      {
+        derivs(t_est + LSRK_C[s] * h, yout, k, userData);
+
+        const double a = LSRK_A[s], b = LSRK_B[s], e = LSRK_E[s] * h;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+        for (int i = 0; i < n; i++)
+        {
+          dq[i] = a * dq[i] + h * k[i];
+          err[i] += e * k[i];
+          yout[i] += b * dq[i];
+        }
+      }
+
+      derivs(t_est + LSRK_C[4] * h, yout, k, userData);
+
+      const double a = LSRK_A[4], b = LSRK_B[4], e = LSRK_E[4] * h;
+      errmax = 0.0;
+
+      //Last stage fused with the error norm so the registers are read once
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(max:errmax)
+#endif
+      for (int i = 0; i < n; i++)
+      {
+        dq[i] = a * dq[i] + h * k[i];
+        yout[i] += b * dq[i];
+
+        double scale = m_absTol + m_relTol * std::max(fabs(ystart[i]), fabs(yout[i]));
+        double erri = fabs((err[i] + e * k[i]) / scale);
+        errmax = std::max(errmax, erri == erri ? erri : HUGE_VAL);
+      }
+
+      if (errmax <= 1.0)
+        break;
+
+      if(m_collectStatistics)
+        recordStep(h, false);
+
+      rejected = true;
+      dt_est = h * std::max(m_safety * pow(errmax, pshrnk), m_minStepRatio);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for (int i = 0; i < n; i++)
+      {
+        yout[i] = ystart[i];
+      }
+
+      if (t_est + dt_est == t_est)
+        return 2;
+    }
+
+    double tStep = t_est;
+    t_est += dt_est;
+
+    if(m_collectStatistics)
+      recordStep(dt_est, true);
+
+    if(nextOutputTime() <= t_est)
+      writeOutput(tStep, ystart, nullptr, t_est, yout, nullptr, n);
+
+    if ((t_est - t_end) * (t_end - t) >= 0.0)
+      return 0;
+
+    if(interrupted(t_est))
+      return 4;
+
+    dt_est *= stepRatio(errmax, pgrow, rejected);
+  }
+
+  return 3;
+}
+
+int ODESolver::adams(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
+{
+  const int maxOrder = static_cast<int>(m_adamsDerivatives.size()) - 1;
+  const double t_end = t + dt;
+  double **f = m_adamsDerivatives.data();
+  double *ynew = m_ytemp;
+
+  //The history carries over only when this call continues from where the last one ended, allowing for
+  //callers that compute t as t0 + i * dt rather than by accumulating dt
+  bool restart = !m_adamsCount || fabs(t - m_adamsTimes[0]) > 4.0 * DBL_EPSILON * std::max(fabs(t), fabs(dt)) ||
+                 (dt > 0.0) != (m_adamsStep > 0.0) || memcmp(y, m_adamsState, n * sizeof(double));
+
+  if(!restart)
+    m_adamsTimes[0] = t;
+
+  if(yout != y)
+  {
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; i++)
+    {
+      yout[i] = y[i];
+    }
+  }
+
+  if(restart)
+  {
+    derivs(t, yout, f[0], userData);
+
+    //Starting step from the ratio of the state to its rate of change, both per unit tolerance
+    double d0 = 0.0, d1 = 0.0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(max:d0, d1)
+#endif
+    for (int i = 0; i < n; i++)
+    {
+      double scale = m_absTol + m_relTol * fabs(yout[i]);
+      d0 = std::max(d0, fabs(yout[i]) / scale);
+      d1 = std::max(d1, fabs(f[0][i]) / scale);
+    }
+
+    double h = d0 < 1e-5 || d1 < 1e-5 ? 1e-6 : 0.01 * d0 / d1;
+
+    m_adamsStep = dt > 0.0 ? std::min(h, dt) : -std::min(h, -dt);
+    m_adamsTimes[0] = t;
+    m_adamsOrder = 1;
+    m_adamsCount = 1;
+    m_adamsStepsAtOrder = 0;
+    resetStepController();
+  }
+
+  //Weights of the predictor and of the correctors of orders k - 1 to k + 2 over the nodes 1, then the history newest first
+  double nodes[ADAMS_MAX_ORDER + 2], predictor[ADAMS_MAX_ORDER], corrector[4][ADAMS_MAX_ORDER + 2];
+  double low[ADAMS_MAX_ORDER + 2], mid[ADAMS_MAX_ORDER + 2], high[ADAMS_MAX_ORDER + 2];
+
+  for (int nstp = 1; nstp <= m_maxSteps; nstp++)
+  {
+    m_currentIterations = nstp;
+
+    const double tn = m_adamsTimes[0];
+    const double hPlanned = m_adamsStep;
+    double h = hPlanned;
+    bool clipped = false;
+
+    if (((tn + h) - t_end) * (tn + h - t) > 0.0)
+    {
+      h = t_end - tn;
+      clipped = true;
+    }
+
+    int k = m_adamsOrder;
+    int failures = 0;
+    bool rejected = false, higher;
+    double errLow, errMid, errHigh;
+
+    for (;;)
+    {
+      nodes[0] = 1.0;
+
+      for (int j = 0; j < m_adamsCount; j++)
+        nodes[j + 1] = (m_adamsTimes[j] - tn) / h;
+
+      //The order k + 1 estimate needs one node beyond those of the corrector
+      higher = k < maxOrder && m_adamsCount > k;
+
+      adamsWeights(nodes + 1, k, predictor);
+
+      for (int q = std::max(k - 1, 1); q <= k + (higher ? 2 : 1); q++)
+      {
+        double *weights = corrector[q - k + 1];
+        adamsWeights(nodes, q, weights);
+        std::fill(weights + q, weights + k + 2, 0.0);
+      }
+
+      //Differences of consecutive correctors estimate the errors of orders k - 1, k and k + 1
+      for (int j = 0; j <= k + 1; j++)
+      {
+        low[j] = k > 1 ? h * (corrector[1][j] - corrector[0][j]) : 0.0;
+        mid[j] = h * (corrector[2][j] - corrector[1][j]);
+        high[j] = higher ? h * (corrector[3][j] - corrector[2][j]) : 0.0;
+        corrector[2][j] *= h;
+      }
+
+      for (int j = 0; j < k; j++)
+        predictor[j] *= h;
+
+      //Predict
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for (int i = 0; i < n; i++)
+      {
+        double sum = 0.0;
+
+        for (int j = 0; j < k; j++)
+          sum += predictor[j] * f[j][i];
+
+        ynew[i] = yout[i] + sum;
+      }
+
+      //Evaluate into the spare slot
+      double *fnew = f[maxOrder];
+      derivs(tn + h, ynew, fnew, userData);
+
+      errLow = errMid = errHigh = 0.0;
+
+      //Correct with the order k + 1 formula, fused with the error norms
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(max:errLow, errMid, errHigh)
+#endif
+      for (int i = 0; i < n; i++)
+      {
+        double sum = corrector[2][0] * fnew[i];
+        double eLow = low[0] * fnew[i], eMid = mid[0] * fnew[i], eHigh = high[0] * fnew[i];
+
+        for (int j = 0; j < k; j++)
+        {
+          double fj = f[j][i];
+          sum += corrector[2][j + 1] * fj;
+          eLow += low[j + 1] * fj;
+          eMid += mid[j + 1] * fj;
+          eHigh += high[j + 1] * fj;
+        }
+
+        if (higher)
+          eHigh += high[k + 1] * f[k][i];
+
+        ynew[i] = yout[i] + sum;
+
+        double scale = m_absTol + m_relTol * std::max(fabs(yout[i]), fabs(ynew[i]));
+        double erri = fabs(eMid / scale);
+
+        errLow = std::max(errLow, fabs(eLow / scale));
+        errMid = std::max(errMid, erri == erri ? erri : HUGE_VAL);
+        errHigh = std::max(errHigh, fabs(eHigh / scale));
+      }
+
+      if (errMid <= 1.0)
+        break;
+
+      if(m_collectStatistics)
+        recordStep(h, false);
+
+      rejected = true;
+      clipped = false;
+
+      //Repeated failures suggest the history no longer describes the solution
+      if (++failures > 1 && k > 1)
+        k--;
+
+      h *= std::max(m_safety * pow(errMid, -1.0 / (k + 1)), m_minStepRatio);
+
+      if (tn + h == tn)
+        return 2;
+    }
+
+    double tnew = clipped ? t_end : tn + h;
+    double *fnew = f[maxOrder];
+
+    //Evaluate again at the corrected state
+    derivs(tnew, ynew, fnew, userData);
+
+    if(m_collectStatistics)
+      recordStep(h, true);
+
+    if(nextOutputTime() <= tnew)
+      writeOutput(tn, yout, f[0], tnew, ynew, fnew, n);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; i++)
+    {
+      yout[i] = ynew[i];
+    }
+
+    //The spare slot becomes the newest and the oldest the spare
+    std::rotate(m_adamsDerivatives.begin(), m_adamsDerivatives.end() - 1, m_adamsDerivatives.end());
+    std::rotate(m_adamsTimes.begin(), m_adamsTimes.end() - 1, m_adamsTimes.end());
+    m_adamsTimes[0] = tnew;
+    m_adamsCount = std::min(m_adamsCount + 1, maxOrder);
+    m_adamsStepsAtOrder++;
+
+    //Lower the order when the lower order formula is as accurate, raise it once the step has settled at this order
+    int order = k;
+    double err = errMid;
+
+    if (k > 1 && errLow <= errMid)
+    {
+      order = k - 1;
+      err = errLow;
+    }
+    else if (higher && errHigh < errMid && m_adamsStepsAtOrder > k)
+    {
+      order = k + 1;
+      err = errHigh;
+    }
+
+    if (order != m_adamsOrder)
+    {
+      m_adamsStepsAtOrder = 0;
+      resetStepController();
+    }
+
+    //Ratios above two destabilise the variable step formulas
+    double hNext = h * std::min(stepRatio(err, -1.0 / (order + 1), rejected), 2.0);
+
+    m_adamsOrder = order;
+    m_adamsStep = clipped && fabs(hPlanned) > fabs(hNext) ? hPlanned : hNext;
+
+    if ((tnew - t_end) * (t_end - t) >= 0.0)
+    {
+      memcpy(m_adamsState, yout, n * sizeof(double));
+      return 0;
+    }
+
+    //A cancelled solve keeps its history so a later call continues from where it stopped
+    if(interrupted(tnew))
+    {
+      memcpy(m_adamsState, yout, n * sizeof(double));
+      return 4;
+    }
+  }
+
+  return 3;
+}
+
+int ODESolver::gbs(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
+{
+  //Sizes of the buffers, which setOrder and setParallelExtrapolation only change at the next initialize
+  const int rows = m_gbsRows;
+  const bool parallel = m_gbsParallel;
+  const double t_end = t + dt;
+
+  double *table[GBS_MAX_ROWS];
+  double *dydt = m_ak + static_cast<size_t>(rows) * n;
+
+  //Substeps of each row and the cumulative derivative evaluations to reach it, counting the one at the start of the step
+  int steps[GBS_MAX_ROWS];
+  double work[GBS_MAX_ROWS];
+
+  for (int j = 0; j < rows; j++)
+  {
+    table[j] = m_ak + static_cast<size_t>(j) * n;
+    steps[j] = 2 * (j + 1);
+    work[j] = (j ? work[j - 1] : 1.0) + steps[j];
+  }
+
+  if(yout != y)
+  {
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; i++)
+    {
+      yout[i] = y[i];
+    }
+  }
+
+  //Target column from the tolerance, as in ODEX
+  int k = std::max(2, std::min(rows - 2, static_cast<int>(-log10(m_relTol + 1e-40) * 0.6 + 1.5)));
+  double t_est = t;
+  double dt_est = dt;
+  bool derivsCurrent = false, rejected = false;
+
+  double ratio[GBS_MAX_ROWS], cost[GBS_MAX_ROWS], factors[GBS_MAX_ROWS];
+
+  for (int nstp = 1; nstp <= m_maxSteps; nstp++)
+  {
+    m_currentIterations = nstp;
+
+    if(!derivsCurrent)
+      derivs(t_est, yout, dydt, userData);
+
+    derivsCurrent = false;
+
+    bool clipped = false;
+
+    if (((t_est + dt_est) - t_end) * (t_est + dt_est - t) > 0.0)
+    {
+      dt_est = t_end - t_est;
+      clipped = true;
+    }
+
+    const double H = dt_est;
+    const int top = std::min(k + 1, rows - 1);
+
+    if(parallel)
+    {
+      //Longest sequences first so the short ones fill in behind them
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (int r = 0; r <= top; r++)
+      {
+        int j = top - r;
+        gbsMidpoint(t_est, yout, dydt, n, H, steps[j], table[j], m_yerr + static_cast<size_t>(3 * j) * n, false, derivs, userData);
+      }
+    }
+
+    int accepted = -1, last = 0;
+
+    for (int j = 0; j <= top; j++)
+    {
+      if(!parallel)
+        gbsMidpoint(t_est, yout, dydt, n, H, steps[j], table[j], m_yerr, true, derivs, userData);
+
+      last = j;
+
+      if (j == 0)
+        continue;
+
+      for (int l = 1; l <= j; l++)
+      {
+        double r = static_cast<double>(steps[j]) / steps[l - 1];
+        factors[l] = 1.0 / (r * r - 1.0);
+      }
+
+      double errmax = 0.0;
+
+      //Aitken-Neville in place: table[l] holds column j - l of row j, so table[0] is the diagonal and table[1] the column before
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(max:errmax)
+#endif
+      for (int i = 0; i < n; i++)
+      {
+        for (int l = j; l > 0; l--)
+          table[l - 1][i] = table[l][i] + (table[l][i] - table[l - 1][i]) * factors[l];
+
+        double scale = m_absTol + m_relTol * std::max(fabs(yout[i]), fabs(table[0][i]));
+        double erri = fabs((table[0][i] - table[1][i]) / scale);
+        errmax = std::max(errmax, erri == erri ? erri : HUGE_VAL);
+      }
+
+      ratio[j] = std::min(std::max(m_safety * pow(errmax, -1.0 / (2 * j + 1)), m_minStepRatio), m_maxStepRatio);
+      cost[j] = work[j] / ratio[j];
+
+      if (j >= k - 1 && errmax <= 1.0)
+      {
+        accepted = j;
+        break;
+      }
+
+      //Give up early when the error is too large to fall below tolerance by column k + 1
+      double reach = j == k - 1 ? static_cast<double>(steps[k]) * steps[k + 1] / (steps[0] * steps[0]) :
+                                  static_cast<double>(steps[k + 1]) / steps[0];
+
+      if ((j == k - 1 || j == k) && errmax > reach * reach)
+        break;
+    }
+
+    if (accepted < 0)
+    {
+      if(m_collectStatistics)
+        recordStep(H, false);
+
+      int column = last;
+
+      if (column > 2 && cost[column - 1] < 0.8 * cost[column])
+        column--;
+
+      k = std::max(2, std::min(column, k));
+      dt_est = H * std::min(ratio[column], 1.0);
+      rejected = true;
+      derivsCurrent = true;
+
+      if (t_est + dt_est == t_est)
+        return 2;
+
+      continue;
+    }
+
+    double tStep = t_est;
+    t_est = clipped ? t_end : t_est + H;
+
+    if(m_collectStatistics)
+      recordStep(H, true);
+
+    if(nextOutputTime() <= t_est)
+    {
+      //The midpoint registers are free once the step is accepted
+      derivs(t_est, table[0], m_yerr, userData);
+      writeOutput(tStep, yout, dydt, t_est, table[0], m_yerr, n);
+      std::copy(m_yerr, m_yerr + n, dydt);
+      derivsCurrent = true;
+    }
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; i++)
+    {
+      yout[i] = table[0][i];
+    }
+
+    if ((t_est - t_end) * (t_end - t) >= 0.0)
+      return 0;
+
+    if(interrupted(t_est))
+      return 4;
+
+    //Order and step from the work per unit step of the neighbouring columns
+    int column = accepted;
+    double next;
+
+    if (column > 1 && cost[column - 1] < 0.8 * cost[column])
+    {
+      next = H * ratio[column - 1];
+      column--;
+    }
+    else if ((column == 1 || cost[column] < 0.9 * cost[column - 1]) && column + 1 <= rows - 2)
+    {
+      next = H * ratio[column] * work[column + 1] / work[column];
+      column++;
+    }
+    else
+    {
+      next = H * ratio[column];
+    }
+
+    if (rejected)
+    {
+      column = std::min(column, k);
+      next = fabs(next) < fabs(H) ? next : H;
+    }
+
+    k = std::max(2, std::min(column, rows - 2));
+    dt_est = next;
+    rejected = false;
+  }
+
+  return 3;
+}
+
+void ODESolver::gbsMidpoint(double t, const double y[], const double dydt[], int n, double H, int steps, double result[], double work[],
+                            bool parallel, ComputeDerivatives derivs, void *userData)
+{
+  const double h = H / steps;
+  double *zPrevious = work, *z = work + n, *f = work + 2 * n;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for if(parallel)
+#else
+  (void)parallel;
+#endif
+  for (int i = 0; i < n; i++)
+  {
+    zPrevious[i] = y[i];
+    z[i] = y[i] + h * dydt[i];
+  }
+
+  for (int m = 1; m < steps; m++)
+  {
+    derivs(t + m * h, z, f, userData);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for if(parallel)
+#endif
+    for (int i = 0; i < n; i++)
+    {
+      double zNext = zPrevious[i] + 2.0 * h * f[i];
+      zPrevious[i] = z[i];
+      z[i] = zNext;
+    }
+  }
+
+  derivs(t + H, z, f, userData);
+
+  //Gragg's smoothing
+#ifdef USE_OPENMP
+#pragma omp parallel for if(parallel)
+#endif
+  for (int i = 0; i < n; i++)
+  {
+    result[i] = 0.5 * (zPrevious[i] + z[i] + h * f[i]);
+  }
+}
+
+int ODESolver::rkc(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
+{
+  //Damping of the Chebyshev stability polynomial
+  const double damping = 2.0 / 13.0;
+  const double t_end = t + dt;
+
+  double *stages[3] = {m_ak, m_ak + n, m_ak + 2 * n};
+  double *f = m_ak + 3 * n, *fn = m_ytemp;
+
+  if(yout != y)
+  {
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; i++)
+    {
+      yout[i] = y[i];
+    }
+  }
+
+  resetStepController();
+  derivs(t, yout, fn, userData);
+
+  double radius = spectralRadius(t, yout, fn, n, derivs, userData);
+  double t_est = t;
+  double dt_est = dt;
+  int sinceEstimate = 0;
+
+  for (int nstp = 1; nstp <= m_maxSteps; nstp++)
+  {
+    m_currentIterations = nstp;
+
+    bool clipped = false, rejected = false;
+
+    if (((t_est + dt_est) - t_end) * (t_est + dt_est - t) > 0.0)
+    {
+      dt_est = t_end - t_est;
+      clipped = true;
+    }
+
+    double errmax;
+    double *ynew;
+    double h;
+
+    for (;;)
+    {
+      h = dt_est;
+
+      //Stages for the stability interval [-0.653 s^2, 0] to cover the spectrum
+      int s = 1 + static_cast<int>(sqrt(1.54 * fabs(h) * radius + 1.0));
+
+      if (s > RKC_MAX_STAGES)
+      {
+        s = RKC_MAX_STAGES;
+        h = (h > 0.0 ? 1.0 : -1.0) * (s * s - 1.0) / (1.54 * radius);
+        clipped = false;
+      }
+
+      s = std::max(s, 2);
+
+      double w0 = 1.0 + damping / (s * s);
+      double temp1 = w0 * w0 - 1.0;
+      double temp2 = sqrt(temp1);
+      double arg = s * log(w0 + temp2);
+      double w1 = sinh(arg) * temp1 / (cosh(arg) * s * temp2 - w0 * sinh(arg));
+
+      double bjm1 = 1.0 / (4.0 * w0 * w0), bjm2 = bjm1;
+      double zjm1 = w0, zjm2 = 1.0, dzjm1 = 1.0, dzjm2 = 0.0, d2zjm1 = 0.0, d2zjm2 = 0.0;
+
+      //First stage
+      double mus = w1 * bjm1;
+      double thjm1 = mus, thjm2 = 0.0;
+      double *y1 = stages[0];
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+      for (int i = 0; i < n; i++)
+      {
+        y1[i] = yout[i] + h * mus * fn[i];
+      }
+
+      //Three term recurrence of the shifted Chebyshev polynomials over stages 2 to s
+      for (int j = 2; j <= s; j++)
+      {
+        double zj = 2.0 * w0 * zjm1 - zjm2;
+        double dzj = 2.0 * w0 * dzjm1 - dzjm2 + 2.0 * zjm1;
+        double d2zj = 2.0 * w0 * d2zjm1 - d2zjm2 + 4.0 * dzjm1;
+        double bj = d2zj / (dzj * dzj);
+        double ajm1 = 1.0 - zjm1 * bjm1;
+        double mu = 2.0 * w0 * bj / bjm1;
+        double nu = -bj / bjm2;
+        mus = mu * w1 / w0;
+
+        const double *yjm1 = stages[(j - 2) % 3];
+        const double *yjm2 = j == 2 ? yout : stages[(j - 3) % 3];
+        double *yj = stages[(j - 1) % 3];
+
+        derivs(t_est + h * thjm1, const_cast<double*>(yjm1), f, userData);
+
+        const double c0 = 1.0 - mu - nu, hmus = h * mus, gamma = h * mus * ajm1;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+        for (int i = 0; i < n; i++)
+        {
+          yj[i] = mu * yjm1[i] + nu * yjm2[i] + c0 * yout[i] + hmus * f[i] - gamma * fn[i];
+        }
+
+        double thj = mu * thjm1 + nu * thjm2 + mus * (1.0 - ajm1);
+
+        thjm2 = thjm1; thjm1 = thj;
+        bjm2 = bjm1; bjm1 = bj;
+        zjm2 = zjm1; zjm1 = zj;
+        dzjm2 = dzjm1; dzjm1 = dzj;
+        d2zjm2 = d2zjm1; d2zjm1 = d2zj;
+      }
+
+      ynew = stages[(s - 1) % 3];
 
-  double tDid, tNext;
-  double t_est = t;
-  double dt_est = dt;
-  double t_end = t+dt;
+      //Derivatives at the end of the step, kept as those at the start of the next
+      derivs(t_est + h, ynew, f, userData);
 
-  std::fill(m_yscal, m_yscal + n, 0.0);
-  std::fill(m_yerr, m_yerr + n, 0.0);
-  std::fill(m_ytemp, m_ytemp + n, 0.0);
-  std::fill(m_ak, m_ak + 5 * n, 0.0);
-  double *dydt = new double[n]();
+      errmax = 0.0;
 
 #ifdef USE_OPENMP
-#pragma omp parallel for
+#pragma omp parallel for reduction(max:errmax)
 #endif
-  for (int i= 0; i < n; i++)
-  {
-    yout[i] = y[i];
-  }
+      for (int i = 0; i < n; i++)
+      {
+        double est = 0.8 * (yout[i] - ynew[i]) + 0.4 * h * (fn[i] + f[i]);
+        double scale = m_absTol + m_relTol * std::max(fabs(yout[i]), fabs(ynew[i]));
+        double erri = fabs(est / scale);
+        errmax = std::max(errmax, erri == erri ? erri : HUGE_VAL);
+      }
 
-  for (int nstp = 1; nstp <= m_maxSteps; nstp++)
-  {
-    m_currentIterations = nstp;
+      if (errmax <= 1.0)
+        break;
+
+      if(m_collectStatistics)
+        recordStep(h, false);
 
-    derivs(t_est, yout, dydt, userData);
+      rejected = true;
+      clipped = false;
+      dt_est = h * std::max(m_safety * pow(errmax, -1.0 / 3.0), m_minStepRatio);
+
+      if (t_est + dt_est == t_est)
+        return 2;
+
+      //A rejection may come from an underestimated spectral radius
+      radius = spectralRadius(t_est, yout, fn, n, derivs, userData);
+      sinceEstimate = 0;
+    }
+
+    double tStep = t_est;
+    t_est = clipped ? t_end : t_est + h;
+
+    if(m_collectStatistics)
+      recordStep(h, true);
+
+    if(nextOutputTime() <= t_est)
+      writeOutput(tStep, yout, fn, t_est, ynew, f, n);
 
 #ifdef USE_OPENMP
 #pragma omp parallel for
 #endif
-    for (int i= 0; i < n; i++)
-    {
-      m_yscal[i] = fabs(yout[i]) + fabs(dydt[i] * dt_est) + ODE_TINY;
-    }
-
-    if (((t_est + dt_est) - t_end) * (t_est + dt_est - t) > 0.0)
+    for (int i = 0; i < n; i++)
     {
-      dt_est = t + dt - t_est;
+      yout[i] = ynew[i];
     }
 
-    if(rkqs(&t_est, dydt, yout, n, dt_est, &tDid, &tNext, derivs, userData))
-    {
-      break;
-    }
+    std::swap(f, fn);
 
-    if( (t_est - t_end) * (t_end - t) >= 0.0)
-    {
-      delete[] dydt;
+    if ((t_est - t_end) * (t_end - t) >= 0.0)
       return 0;
-    }
 
-    if (fabs(tNext) <= 0.0)
+    if(interrupted(t_est))
+      return 4;
+
+    dt_est = h * stepRatio(errmax, -1.0 / 3.0, rejected);
+
+    if (++sinceEstimate >= 25)
     {
-      delete[] dydt;
-      return 2;
+      radius = spectralRadius(t_est, yout, fn, n, derivs, userData);
+      sinceEstimate = 0;
     }
-
-    t_est = tNext;
   }
 
-  delete[] dydt;
-
   return 3;
 }
 
-int ODESolver::rkqs(double *t, double dydt[], double yout[], int n, double dtTry, double *dtDid, double *dtNext, ComputeDerivatives derivs, void* userData)
+double ODESolver::spectralRadius(double t, const double y[], const double dydt[], int n, ComputeDerivatives derivs, void *userData)
 {
-  double err, errmax, dt, dtTemp, tnew, told = *t;
+  PhaseTimer timer(m_collectStatistics ? &m_lastStatistics.stepControlTime : nullptr);
 
-  // --- set initial stepsize
-  dt = dtTry;
+  //The stage registers are free between steps
+  double *v = m_ak, *fv = m_ak + n, *direction = m_ak + 4 * n;
+  double ynorm = 0.0, dnorm = 0.0, fnorm = 0.0;
 
-  for (;;)
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(+:ynorm, dnorm, fnorm)
+#endif
+  for (int i = 0; i < n; i++)
   {
-    // --- take a Runge-Kutta-Cash-Karp step
-    rkck(told, dydt, yout, n, dt, derivs, userData);
+    ynorm += y[i] * y[i];
+    dnorm += direction[i] * direction[i];
+    fnorm += dydt[i] * dydt[i];
+  }
 
-    // --- compute scaled maximum error
-    errmax = 0.0;
+  ynorm = sqrt(ynorm);
+
+  //Start from the last dominant direction, else from the derivatives, else from a uniform perturbation
+  const double *start = dnorm > 0.0 ? direction : fnorm > 0.0 ? dydt : nullptr;
+  double startNorm = dnorm > 0.0 ? sqrt(dnorm) : fnorm > 0.0 ? sqrt(fnorm) : sqrt(static_cast<double>(n));
+  double dy = ynorm > 0.0 ? ynorm * sqrt(DBL_EPSILON) : sqrt(DBL_EPSILON);
 
 #ifdef USE_OPENMP
 #pragma omp parallel for
 #endif
-    for (int i = 0; i < n; i++)
-    {
-      err = fabs(m_yerr[i] / m_yscal[i]);
+  for (int i = 0; i < n; i++)
+  {
+    v[i] = y[i] + dy * (start ? start[i] : 1.0) / startNorm;
+  }
 
-      if (err > errmax)
-        errmax = err;
-    }
+  double radius = 0.0;
 
-    errmax /= m_relTol;
+  for (int iteration = 0; iteration < 50; iteration++)
+  {
+    derivs(t, v, fv, userData);
 
-    // --- error too large; reduce stepsize & repeat
-    if (errmax > 1.0)
+    double dfnorm = 0.0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for reduction(+:dfnorm)
+#endif
+    for (int i = 0; i < n; i++)
     {
-      dtTemp = m_safety * dt * pow( errmax, m_pshrnk);
+      double d = fv[i] - dydt[i];
+      dfnorm += d * d;
+    }
 
-      if (dt >= 0)
-      {
-        if (dtTemp > 0.1 * dt)
-          dt = dtTemp;
-        else
-          dt = 0.1 * dt;
-      }
-      else
-      {
-        if (dtTemp < 0.1 * dt)
-          dt = dtTemp;
-        else
-          dt = 0.1 * dt;
-      }
+    dfnorm = sqrt(dfnorm);
 
-      tnew = told + dt;
+    double previous = radius;
+    radius = dfnorm / dy;
 
-      if (tnew == told)
-        return 2;
+    //A right-hand side that does not depend on y gives no difference to iterate on
+    if (dfnorm == 0.0 || (iteration && fabs(radius - previous) <= 0.01 * std::max(radius, previous)))
+      break;
 
-      continue;
-    }
+    double scale = dy / dfnorm;
 
-    // --- step succeeded; compute size of next step
-    else
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; i++)
     {
-      if (errmax > m_errcon)
-        *dtNext = m_safety * dt * pow(errmax,m_pgrow);
-      else
-        *dtNext = 5.0 * dt;
-
-      *t += (*dtDid = dt);
+      v[i] = y[i] + (fv[i] - dydt[i]) * scale;
+    }
+  }
 
 #ifdef USE_OPENMP
 #pragma omp parallel for
 #endif
-      for (int i = 0; i< n; i++)
-      {
-        yout[i] = m_ytemp[i];
-      }
-
-      return 0;
-    }
+  for (int i = 0; i < n; i++)
+  {
+    direction[i] = v[i] - y[i];
   }
+
+  return 1.2 * radius;
 }
 
-void ODESolver::rkck(double t, double dydt[], double yout[], int n, double dt, ComputeDerivatives derivs, void* userData)
+int ODESolver::exponentialIntegrator(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void* userData)
 {
-  double a2=0.2, a3=0.3, a4=0.6, a5=1.0, a6=0.875,
-      b21=0.2, b31=3.0/40.0, b32=9.0/40.0, b41=0.3, b42= -0.9, b43=1.2,
-      b51= -11.0/54.0, b52=2.5, b53= -70.0/27.0, b54=35.0/27.0,
-      b61=1631.0/55296.0, b62=175.0/512.0, b63=575.0/13824.0,
-      b64=44275.0/110592.0, b65=253.0/4096.0, c1=37.0/378.0,
-      c3=250.0/621.0, c4=125.0/594.0, c6=512.0/1771.0,
-      dc5= -277.0/14336.0;
-  double dc1=c1-2825.0/27648.0, dc3=c3-18575.0/48384.0,
-      dc4=c4-13525.0/55296.0, dc6=c6-0.25;
+  const bool rosenbrock = m_solverType == EXPRB32;
+
+  if(!rosenbrock && !m_linearOperator)
+    return 1;
+
+  const double t_end = t + dt;
+
+  double *u = m_ak, *defect = m_ak + n, *ynew = m_ak + 2 * n, *f = m_ak + 3 * n, *fn = m_ytemp;
 
-  double *ak2 = &m_ak[0];
-  double *ak3 = &m_ak[n];
-  double *ak4 = &m_ak[2*n];
-  double *ak5 = &m_ak[3*n];
-  double *ak6 = &m_ak[4*n];
+  //The user products take the caller's data, not the counting wrapper around it
+  ExponentialOperatorData operatorData;
+  operatorData.linearOperator = m_linearOperator;
+  operatorData.jacobianVectorProduct = m_jacobianVectorProduct;
+  operatorData.derivs = derivs;
+  operatorData.userData = userData;
+  operatorData.callerData = callerData(derivs, userData);
+  operatorData.products = m_collectStatistics ? &m_lastStatistics.jacobianVectorProducts : nullptr;
+  operatorData.dydt = fn;
+  operatorData.work = m_ak + 4 * n;
+  operatorData.n = n;
 
+  ODEKrylov::MatrixVectorProduct product = rosenbrock ? &jacobianProduct : &linearOperatorProduct;
+
+  //Order of the phi-function of the correction, its weight per unit step and the step exponent of the error estimate
+  const int correctionPhi = rosenbrock ? 3 : 2;
+  const double correctionWeight = rosenbrock ? 2.0 : 1.0;
+  const double pgrow = rosenbrock ? -1.0 / 3.0 : -1.0 / 2.0;
+
+  if(yout != y)
+  {
 #ifdef USE_OPENMP
 #pragma omp parallel for
 #endif
-  for (int i = 0; i < n; i++)
-    m_ytemp[i] = yout[i] + b21 * dt * dydt[i];
+    for (int i = 0; i < n; i++)
+    {
+      yout[i] = y[i];
+    }
+  }
 
-  derivs(t + a2 * dt, m_ytemp, ak2, userData);
+  resetStepController();
+  derivs(t, yout, fn, userData);
+
+  double t_est = t;
+  double dt_est = dt;
+
+  for (int nstp = 1; nstp <= m_maxSteps; nstp++)
+  {
+    m_currentIterations = nstp;
+
+    bool clipped = false, rejected = false;
+
+    if (((t_est + dt_est) - t_end) * (t_est + dt_est - t) > 0.0)
+    {
+      dt_est = t_end - t_est;
+      clipped = true;
+    }
+
+    double ynorm = 0.0;
 
 #ifdef USE_OPENMP
-#pragma omp parallel for
+#pragma omp parallel for reduction(+:ynorm)
 #endif
-  for (int i = 0; i < n; i++)
-    m_ytemp[i] = yout[i] + dt * (b31*dydt[i]+b32*ak2[i]);
+    for (int i = 0; i < n; i++)
+    {
+      ynorm += yout[i] * yout[i];
+    }
+
+    ynorm = sqrt(ynorm);
+
+    operatorData.t = t_est;
+    operatorData.y = yout;
+    operatorData.ynorm = ynorm;
+
+    //Krylov error allowed in the increments, a tenth of the step tolerance in the 2-norm
+    const double krylovTolerance = 0.1 * (m_absTol * sqrt(static_cast<double>(n)) + m_relTol * ynorm);
+
+    double errmax;
+    double h;
+
+    for (;;)
+    {
+      h = dt_est;
 
-  derivs(t + a3 * dt, m_ytemp, ak3, userData);
+      int status;
 
+      {
+        PhaseTimer timer(m_collectStatistics ? &m_lastStatistics.linearSolveTime : nullptr);
+        status = m_krylov->phi(1, h, fn, defect, krylovTolerance / fabs(h), product, &operatorData);
+      }
+
+      if(m_collectStatistics)
+        m_lastStatistics.linearIterations += m_krylov->lastDimension();
+
+      if (status == 0)
+      {
+        //Exponential Euler step
 #ifdef USE_OPENMP
 #pragma omp parallel for
 #endif
-  for (int i = 0; i<n; i++)
-    m_ytemp[i] = yout[i] + dt *(b41*dydt[i]+b42*ak2[i] + b43*ak3[i]);
+        for (int i = 0; i < n; i++)
+        {
+          u[i] = yout[i] + h * defect[i];
+        }
 
-  derivs(t + a4 * dt, m_ytemp, ak4, userData);
+        derivs(t_est + h, u, f, userData);
 
+        //Defect of the linearization, f(U) - f(y) - A (U - y)
 #ifdef USE_OPENMP
 #pragma omp parallel for
 #endif
-  for (int i = 0; i<n; i++)
-    m_ytemp[i] = yout[i] + dt *(b51*dydt[i]+b52*ak2[i] + b53*ak3[i] + b54*ak4[i]);
+        for (int i = 0; i < n; i++)
+        {
+          defect[i] = u[i] - yout[i];
+        }
 
-  derivs(t + a5 * dt, m_ytemp, ak5, userData);
+        product(defect, ynew, &operatorData);
 
 #ifdef USE_OPENMP
 #pragma omp parallel for
 #endif
-  for (int i = 0; i<n; i++)
-    m_ytemp[i] = yout[i] + dt * (b61 * dydt[i] + b62 * ak2[i] + b63 * ak3[i] + b64 * ak4[i]
-                                 + b65 * ak5[i]);
-  derivs(t + a6 * dt, m_ytemp, ak6, userData);
+        for (int i = 0; i < n; i++)
+        {
+          defect[i] = f[i] - fn[i] - ynew[i];
+        }
+
+        double weight = correctionWeight * h;
+
+        {
+          PhaseTimer timer(m_collectStatistics ? &m_lastStatistics.linearSolveTime : nullptr);
+          status = m_krylov->phi(correctionPhi, h, defect, ynew, krylovTolerance / fabs(weight), product, &operatorData);
+        }
+
+        if(m_collectStatistics)
+          m_lastStatistics.linearIterations += m_krylov->lastDimension();
+
+        if (status == 0)
+        {
+          errmax = 0.0;
 
 #ifdef USE_OPENMP
-#pragma omp parallel for
+#pragma omp parallel for reduction(max:errmax)
 #endif
-  for (int i = 0; i<n; i++)
-    m_ytemp[i] = yout[i] + dt *(c1 * dydt[i] + c3 * ak3[i] + c4 * ak4[i] + c6 * ak6[i]);
+          for (int i = 0; i < n; i++)
+          {
+            double correction = weight * ynew[i];
+            ynew[i] = u[i] + correction;
+
+            double scale = m_absTol + m_relTol * std::max(fabs(yout[i]), fabs(ynew[i]));
+            double erri = fabs(correction / scale);
+            errmax = std::max(errmax, erri == erri ? erri : HUGE_VAL);
+          }
+
+          if (errmax <= 1.0)
+            break;
+        }
+      }
+
+      if(m_collectStatistics)
+      {
+        recordStep(h, false);
+
+        if(status)
+          m_lastStatistics.linearFailures++;
+      }
+
+      //A phi-function that needs more than the largest Krylov subspace halves the step
+      rejected = true;
+      clipped = false;
+      dt_est = status ? 0.5 * h : h * std::max(m_safety * pow(errmax, pgrow), m_minStepRatio);
+
+      if (t_est + dt_est == t_est)
+        return 2;
+    }
+
+    double tStep = t_est;
+    t_est = clipped ? t_end : t_est + h;
+
+    //Derivatives at the end of the step, kept as those at the start of the next
+    derivs(t_est, ynew, f, userData);
+
+    if(m_collectStatistics)
+      recordStep(h, true);
+
+    if(nextOutputTime() <= t_est)
+      writeOutput(tStep, yout, fn, t_est, ynew, f, n);
 
 #ifdef USE_OPENMP
 #pragma omp parallel for
 #endif
-  for (int i = 0; i<n; i++)
-    m_yerr[i] = dt *(dc1 * dydt[i] + dc3 * ak3[i] + dc4 * ak4[i] + dc5 * ak5[i] + dc6 * ak6[i]);
+    for (int i = 0; i < n; i++)
+    {
+      yout[i] = ynew[i];
+    }
+
+    std::swap(f, fn);
+    operatorData.dydt = fn;
+
+    if ((t_est - t_end) * (t_end - t) >= 0.0)
+      return 0;
+
+    if(interrupted(t_est))
+      return 4;
+
+    dt_est = h * stepRatio(errmax, pgrow, rejected);
+  }
+
+  return 3;
 }
 
 #ifdef USE_CVODE
 
 int ODESolver::solveCVODE(double y[], int n, double t, double dt, double yout[], ComputeDerivatives derivs, void *userData)
 {
-  RedirectionData redirectData; redirectData.deriv = derivs; redirectData.userData = userData;
+  RedirectionData redirectData; redirectData.deriv = derivs; redirectData.userData = userData; redirectData.solver = this;
   CVodeSetUserData(m_cvodeSolver, &redirectData);
 
 #ifdef USE_CVODE_OPENMP
@@ -636,6 +3090,7 @@ int ODESolver::solveCVODE(double y[], int n, double t, double dt, double yout[],
   }
 
   CVodeReInit(m_cvodeSolver, t, m_cvy);
+  m_cvodeConvergenceFailures = 0;
 
 #ifdef USE_CVODE_OPENMP
   N_Vector ycvout = N_VMake_OpenMP(n,yout,omp_get_max_threads());
@@ -644,18 +3099,39 @@ int ODESolver::solveCVODE(double y[], int n, double t, double dt, double yout[],
 #endif
 
   double tNext = t+dt;
-  double tOut = 0.0;
+  double tOut = t;
 
 
   int result = 0;
+  double hInitial = 0.0, hLast = 0.0;
 
   while (tOut < tNext)
   {
-    result = CVode(m_cvodeSolver, tNext, ycvout, &tOut, CV_NORMAL);
+    //Output times inside the interval are returned from the CVODE interpolant without restarting the integration
+    double tTarget = std::min(nextOutputTime(), tNext);
+
+    result = CVode(m_cvodeSolver, tTarget, ycvout, &tOut, CV_NORMAL);
 
     if(result)
     {
-      return result;
+      //The derivatives fail once the solve is cancelled. CVODE returns the state of its last accepted step, or nothing
+      //if no step was taken, and the handle moves back from the stage the cancellation was seen in to that time
+      if(result < 0 && m_asyncSolve && m_asyncSolve->cancelRequested())
+      {
+        if(tOut == t && yout != y)
+          std::copy(y, y + n, yout);
+
+        m_asyncSolve->setCurrentTime(tOut);
+        result = 4;
+      }
+
+      break;
+    }
+
+    if(tTarget == nextOutputTime())
+    {
+      m_outputSink->write(tTarget, yout, n);
+      m_outputIndex++;
     }
   }
 
@@ -664,6 +3140,58 @@ int ODESolver::solveCVODE(double y[], int n, double t, double dt, double yout[],
 
   m_currentIterations = static_cast<int>(currentIterations);
 
+  if(m_jacobian && m_solverIterationMethod == ODESolver::IterationMethod::NEWTON)
+  {
+    long value = 0;
+    m_cvodeSteps += currentIterations;
+
+    CVodeGetNumNonlinSolvIters(m_cvodeSolver, &value);
+    m_cvodeNewtonIterations += value;
+
+    CVSpilsGetNumLinIters(m_cvodeSolver, &value);
+    m_cvodeLinearIterations += value;
+  }
+
+  //CVodeReInit resets the CVODE counters so they hold the work of this call only
+  if(m_collectStatistics)
+  {
+    long errorTestFailures = 0, convergenceFailures = 0, value = 0;
+
+    m_lastStatistics.acceptedSteps = currentIterations;
+
+    CVodeGetNumErrTestFails(m_cvodeSolver, &errorTestFailures);
+    CVodeGetNumNonlinSolvConvFails(m_cvodeSolver, &convergenceFailures);
+    m_lastStatistics.rejectedSteps = errorTestFailures + convergenceFailures;
+    m_lastStatistics.nonLinearFailures = convergenceFailures;
+
+    CVodeGetNumNonlinSolvIters(m_cvodeSolver, &value);
+    m_lastStatistics.nonLinearIterations = value;
+
+    if(m_solverIterationMethod == ODESolver::IterationMethod::NEWTON)
+    {
+      CVodeGetNumLinSolvSetups(m_cvodeSolver, &value);
+      m_lastStatistics.linearSolverSetups = value;
+
+      CVSpilsGetNumLinIters(m_cvodeSolver, &value);
+      m_lastStatistics.linearIterations = value;
+
+      CVSpilsGetNumConvFails(m_cvodeSolver, &value);
+      m_lastStatistics.linearFailures = value;
+
+      CVSpilsGetNumJtimesEvals(m_cvodeSolver, &value);
+      m_lastStatistics.jacobianVectorProducts = value;
+
+      CVSpilsGetNumPrecEvals(m_cvodeSolver, &value);
+      m_lastStatistics.jacobianEvaluations = value;
+    }
+
+    //Internal steps are not visible with CV_NORMAL so the range spans the initial and last steps
+    CVodeGetActualInitStep(m_cvodeSolver, &hInitial);
+    CVodeGetLastStep(m_cvodeSolver, &hLast);
+    m_lastStatistics.minStep = std::min(fabs(hInitial), fabs(hLast));
+    m_lastStatistics.maxStep = std::max(fabs(hInitial), fabs(hLast));
+  }
+
 #ifdef USE_CVODE_OPENMP
   N_VDestroy_OpenMP(ycvout);
 #else
@@ -685,11 +3213,78 @@ int ODESolver::ComputeDerivatives_CVODE(realtype t, N_Vector y, N_Vector dydt, v
   double *dydtData =  N_VGetArrayPointer(dydt);
 #endif
 
+  if(redirectDada->solver->interrupted(t))
+    return -1;
+
   redirectDada->deriv(t, yData, dydtData, redirectDada->userData);
 
   return 0;
 }
 
+int ODESolver::JacobianTimesVector_CVODE(N_Vector v, N_Vector Jv, realtype t, N_Vector y, N_Vector fy, void *user_data, N_Vector)
+{
+  RedirectionData *redirectData = static_cast<RedirectionData*>(user_data);
+  ODESolver *solver = redirectData->solver;
+  PhaseTimer timer(solver->m_collectStatistics ? &solver->m_lastStatistics.linearSolveTime : nullptr);
+
+#ifdef USE_CVODE_OPENMP
+  double *vData = N_VGetArrayPointer_OpenMP(v);
+  double *JvData = N_VGetArrayPointer_OpenMP(Jv);
+  double *yData = N_VGetArrayPointer_OpenMP(y);
+  double *fyData = N_VGetArrayPointer_OpenMP(fy);
+#else
+  double *vData = N_VGetArrayPointer(v);
+  double *JvData = N_VGetArrayPointer(Jv);
+  double *yData = N_VGetArrayPointer(y);
+  double *fyData = N_VGetArrayPointer(fy);
+#endif
+
+  solver->m_jacobianVectorProduct(t, yData, fyData, vData, JvData, callerData(redirectData->deriv, redirectData->userData));
+
+  return 0;
+}
+
+int ODESolver::PreconditionerSetup_CVODE(realtype t, N_Vector y, N_Vector fy, booleantype jok, booleantype *jcurPtr, realtype gamma, void *user_data)
+{
+  RedirectionData *redirectData = static_cast<RedirectionData*>(user_data);
+  ODESolver *solver = redirectData->solver;
+  PhaseTimer timer(solver->m_collectStatistics ? &solver->m_lastStatistics.linearSolveTime : nullptr);
+
+  long steps = 0, newtonIterations = 0, linearIterations = 0, convergenceFailures = 0;
+  CVodeGetNumSteps(solver->m_cvodeSolver, &steps);
+  CVodeGetNumNonlinSolvIters(solver->m_cvodeSolver, &newtonIterations);
+  CVSpilsGetNumLinIters(solver->m_cvodeSolver, &linearIterations);
+  CVodeGetNumNonlinSolvConvFails(solver->m_cvodeSolver, &convergenceFailures);
+
+  //CVODE also clears jok on its own age limit and after every restart, which the policy replaces
+  bool convergenceFailed = !jok && convergenceFailures > solver->m_cvodeConvergenceFailures;
+  solver->m_cvodeConvergenceFailures = convergenceFailures;
+
+  bool evaluated = false;
+
+  //A zero pivot is recoverable: CVODE retries with a fresh Jacobian or a smaller step
+  int result = solver->m_jacobian->setup(t, N_VGetArrayPointer(y), N_VGetArrayPointer(fy), gamma,
+                                         solver->m_cvodeSteps + steps,
+                                         solver->m_cvodeNewtonIterations + newtonIterations,
+                                         solver->m_cvodeLinearIterations + linearIterations,
+                                         convergenceFailed, redirectData->deriv, redirectData->userData, evaluated);
+
+  *jcurPtr = evaluated ? SUNTRUE : SUNFALSE;
+
+  return result;
+}
+
+int ODESolver::PreconditionerSolve_CVODE(realtype, N_Vector, N_Vector, N_Vector r, N_Vector z, realtype, realtype, int, void *user_data)
+{
+  RedirectionData *redirectData = static_cast<RedirectionData*>(user_data);
+  ODESolver *solver = redirectData->solver;
+  PhaseTimer timer(solver->m_collectStatistics ? &solver->m_lastStatistics.linearSolveTime : nullptr);
+
+  solver->m_jacobian->solve(N_VGetArrayPointer(r), N_VGetArrayPointer(z));
+
+  return 0;
+}
+
 #endif
 
 void ODESolver::clearMemory()
@@ -711,20 +3306,28 @@ void ODESolver::clearMemory()
     if(m_linearSolver)
     {
       SUNLinSolFree(m_linearSolver);
+      m_linearSolver = nullptr;
     }
 
     if(m_nonLinearSolver)
     {
       SUNNonlinSolFree(m_nonLinearSolver);
+      m_nonLinearSolver = nullptr;
     }
   }
 #endif
 
-  if(m_yscal)
-  {
-    delete[] m_yscal; m_yscal = nullptr;
-    delete[] m_yerr; m_yerr = nullptr;
-    delete[] m_ytemp; m_ytemp = nullptr;
-    delete[] m_ak; m_ak = nullptr;
-  }
+  //The low-storage schemes allocate only some of the scratch arrays
+  ODEBatchState::deallocate(m_yscal); m_yscal = nullptr;
+  ODEBatchState::deallocate(m_yerr); m_yerr = nullptr;
+  ODEBatchState::deallocate(m_ytemp); m_ytemp = nullptr;
+  ODEBatchState::deallocate(m_ak); m_ak = nullptr;
+  ODEBatchState::deallocate(m_adamsState); m_adamsState = nullptr;
+
+  delete m_krylov;
+  m_krylov = nullptr;
+
+  m_adamsDerivatives.clear();
+  m_adamsTimes.clear();
+  m_adamsCount = 0;
 }
@@ -0,0 +1,234 @@
+/*!
+ *  \file    odesolvercheckpoint.cpp
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#include "stdafx.h"
+#include "odesolvercheckpoint.h"
+#include "odesolver.h"
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#define ODESOLVER_CHECKPOINT_MAGIC 0x4B43444Fu
+#define ODESOLVER_CHECKPOINT_VERSION 1u
+
+//Magic, version, count and padding
+#define ODESOLVER_CHECKPOINT_HEADER_SIZE 16
+
+/*!
+ * \brief syncMapping Writes the mapped blobs and the file to disk before the file is renamed into place.
+ */
+static bool syncMapping(QFile &file, unsigned char *data, unsigned long long size)
+{
+#ifdef _WIN32
+  return FlushViewOfFile(data, static_cast<SIZE_T>(size)) && _commit(file.handle()) == 0;
+#else
+  return msync(data, static_cast<size_t>(size), MS_SYNC) == 0 && fsync(file.handle()) == 0;
+#endif
+}
+
+/*!
+ * \brief replaceFile Renames source over target in one step, so target is either the old or the new file.
+ */
+static bool replaceFile(const QString &source, const QString &target)
+{
+#ifdef _WIN32
+  return MoveFileExW(source.toStdWString().c_str(), target.toStdWString().c_str(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  return ::rename(source.toStdString().c_str(), target.toStdString().c_str()) == 0;
+#endif
+}
+
+ODESolverCheckpoint::ODESolverCheckpoint()
+  : m_data(nullptr),
+    m_size(0),
+    m_count(0)
+{
+}
+
+ODESolverCheckpoint::~ODESolverCheckpoint()
+{
+  close();
+}
+
+bool ODESolverCheckpoint::write(const QString &filePath, const std::vector<ODESolver*> &solvers)
+{
+  int count = static_cast<int>(solvers.size());
+  std::vector<unsigned long long> offsets(count + 1);
+
+  offsets[0] = ODESOLVER_CHECKPOINT_HEADER_SIZE + (count + 1) * sizeof(unsigned long long);
+
+  for(int i = 0; i < count; i++)
+  {
+    unsigned long long blobSize = solvers[i]->stateSize();
+    offsets[i + 1] = offsets[i] + ((blobSize + 7) & ~7ull);
+  }
+
+  QString tempFilePath = filePath + ".tmp";
+  QFile file(tempFilePath);
+
+  if(!file.open(QIODevice::ReadWrite | QIODevice::Truncate) || !file.resize(offsets[count]))
+  {
+    fprintf(stderr, "Could not create checkpoint %s\n", tempFilePath.toStdString().c_str());
+    return false;
+  }
+
+  unsigned char *data = file.map(0, offsets[count]);
+
+  if(!data)
+  {
+    fprintf(stderr, "Could not map checkpoint %s\n", tempFilePath.toStdString().c_str());
+    file.close();
+    QFile::remove(tempFilePath);
+    return false;
+  }
+
+  unsigned int header[4] = {ODESOLVER_CHECKPOINT_MAGIC, ODESOLVER_CHECKPOINT_VERSION, static_cast<unsigned int>(count), 0};
+  memcpy(data, header, ODESOLVER_CHECKPOINT_HEADER_SIZE);
+  memcpy(data + ODESOLVER_CHECKPOINT_HEADER_SIZE, offsets.data(), (count + 1) * sizeof(unsigned long long));
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+  for(int i = 0; i < count; i++)
+  {
+    solvers[i]->saveState(reinterpret_cast<char*>(data + offsets[i]));
+  }
+
+  bool synced = syncMapping(file, data, offsets[count]);
+
+  file.unmap(data);
+  file.close();
+
+  if(!synced)
+  {
+    fprintf(stderr, "Could not flush checkpoint %s\n", tempFilePath.toStdString().c_str());
+    QFile::remove(tempFilePath);
+    return false;
+  }
+
+  if(!replaceFile(tempFilePath, filePath))
+  {
+    fprintf(stderr, "Could not rename checkpoint %s\n", tempFilePath.toStdString().c_str());
+    return false;
+  }
+
+  return true;
+}
+
+bool ODESolverCheckpoint::open(const QString &filePath)
+{
+  close();
+
+  m_file.setFileName(filePath);
+
+  if(!m_file.open(QIODevice::ReadOnly))
+  {
+    fprintf(stderr, "Could not open checkpoint %s\n", filePath.toStdString().c_str());
+    return false;
+  }
+
+  m_size = m_file.size();
+  m_data = m_size >= ODESOLVER_CHECKPOINT_HEADER_SIZE ? m_file.map(0, m_size) : nullptr;
+
+  unsigned int header[4] = {0, 0, 0, 0};
+
+  if(m_data)
+    memcpy(header, m_data, ODESOLVER_CHECKPOINT_HEADER_SIZE);
+
+  if(header[0] != ODESOLVER_CHECKPOINT_MAGIC || header[1] != ODESOLVER_CHECKPOINT_VERSION ||
+     ODESOLVER_CHECKPOINT_HEADER_SIZE + (header[2] + 1ll) * static_cast<long long>(sizeof(unsigned long long)) > m_size)
+  {
+    fprintf(stderr, "Not a supported checkpoint %s\n", filePath.toStdString().c_str());
+    close();
+    return false;
+  }
+
+  m_count = static_cast<int>(header[2]);
+
+  return true;
+}
+
+void ODESolverCheckpoint::close()
+{
+  if(m_data)
+  {
+    m_file.unmap(const_cast<unsigned char*>(m_data));
+    m_data = nullptr;
+  }
+
+  if(m_file.isOpen())
+    m_file.close();
+
+  m_size = 0;
+  m_count = 0;
+}
+
+int ODESolverCheckpoint::count() const
+{
+  return m_count;
+}
+
+int ODESolverCheckpoint::restore(int index, ODESolver *solver) const
+{
+  if(index < 0 || index >= m_count)
+    return 1;
+
+  unsigned long long offsets[2];
+  memcpy(offsets, m_data + ODESOLVER_CHECKPOINT_HEADER_SIZE + index * sizeof(unsigned long long), sizeof(offsets));
+
+  if(offsets[0] > offsets[1] || offsets[1] > static_cast<unsigned long long>(m_size))
+    return 1;
+
+  return solver->restoreState(reinterpret_cast<const char*>(m_data + offsets[0]), offsets[1] - offsets[0]);
+}
+
+int ODESolverCheckpoint::restore(const std::vector<ODESolver*> &solvers) const
+{
+  int count = static_cast<int>(solvers.size());
+  std::vector<int> status(count, 0);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+  for(int i = 0; i < count; i++)
+  {
+    status[i] = restore(i, solvers[i]);
+  }
+
+  for(int i = 0; i < count; i++)
+  {
+    if(status[i])
+      return status[i];
+  }
+
+  return 0;
+}
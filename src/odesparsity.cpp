@@ -0,0 +1,282 @@
+/*!
+ *  \file    odesparsity.cpp
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#include "stdafx.h"
+#include "odesparsity.h"
+
+#include <math.h>
+#include <algorithm>
+#include <limits>
+
+ODESparsityPattern::ODESparsityPattern()
+  : m_size(0),
+    m_rowOffsets(1, 0)
+{
+}
+
+ODESparsityPattern::ODESparsityPattern(int size, const std::vector<int> &rowOffsets, const std::vector<int> &columns)
+  : m_size(size),
+    m_rowOffsets(rowOffsets),
+    m_columns(columns)
+{
+}
+
+ODESparsityPattern ODESparsityPattern::banded(int size, int lower, int upper)
+{
+  std::vector<int> rowOffsets(size + 1, 0), columns;
+  columns.reserve(static_cast<size_t>(size) * (lower + upper + 1));
+
+  for(int i = 0; i < size; i++)
+  {
+    for(int j = std::max(0, i - lower); j <= std::min(size - 1, i + upper); j++)
+      columns.push_back(j);
+
+    rowOffsets[i + 1] = static_cast<int>(columns.size());
+  }
+
+  return ODESparsityPattern(size, rowOffsets, columns);
+}
+
+int ODESparsityPattern::size() const
+{
+  return m_size;
+}
+
+int ODESparsityPattern::nonZeros() const
+{
+  return static_cast<int>(m_columns.size());
+}
+
+const std::vector<int> &ODESparsityPattern::rowOffsets() const
+{
+  return m_rowOffsets;
+}
+
+const std::vector<int> &ODESparsityPattern::columns() const
+{
+  return m_columns;
+}
+
+ODESparsityPattern ODESparsityPattern::transpose() const
+{
+  std::vector<int> rowOffsets(m_size + 1, 0), columns(m_columns.size());
+
+  for(int column : m_columns)
+    rowOffsets[column + 1]++;
+
+  for(int j = 0; j < m_size; j++)
+    rowOffsets[j + 1] += rowOffsets[j];
+
+  std::vector<int> next(rowOffsets.begin(), rowOffsets.end() - 1);
+
+  for(int i = 0; i < m_size; i++)
+  {
+    for(int k = m_rowOffsets[i]; k < m_rowOffsets[i + 1]; k++)
+      columns[next[m_columns[k]]++] = i;
+  }
+
+  return ODESparsityPattern(m_size, rowOffsets, columns);
+}
+
+ODESparseDerivatives::ODESparseDerivatives(const ODESparsityPattern &pattern, ComputeDerivatives derivs, ComputePartialDerivatives partialDerivs, void *userData)
+  : m_pattern(pattern),
+    m_transpose(pattern.transpose()),
+    m_derivs(derivs),
+    m_partialDerivs(partialDerivs),
+    m_userData(userData),
+    m_relativeThreshold(0.0),
+    m_absoluteThreshold(0.0),
+    m_maxFraction(0.5),
+    m_cached(false),
+    m_marks(pattern.size(), 0),
+    m_mark(0),
+    m_fullEvaluations(0),
+    m_partialEvaluations(0),
+    m_evaluatedComponents(0)
+{
+}
+
+const ODESparsityPattern &ODESparseDerivatives::pattern() const
+{
+  return m_pattern;
+}
+
+double ODESparseDerivatives::relativeThreshold() const
+{
+  return m_relativeThreshold;
+}
+
+void ODESparseDerivatives::setRelativeThreshold(double threshold)
+{
+  m_relativeThreshold = threshold;
+}
+
+double ODESparseDerivatives::absoluteThreshold() const
+{
+  return m_absoluteThreshold;
+}
+
+void ODESparseDerivatives::setAbsoluteThreshold(double threshold)
+{
+  m_absoluteThreshold = threshold;
+}
+
+double ODESparseDerivatives::maxFraction() const
+{
+  return m_maxFraction;
+}
+
+void ODESparseDerivatives::setMaxFraction(double fraction)
+{
+  m_maxFraction = fraction;
+}
+
+void ODESparseDerivatives::reset()
+{
+  m_cached = false;
+}
+
+void ODESparseDerivatives::evaluate(double t, double y[], double dydt[])
+{
+  const int n = m_pattern.size();
+
+  if(!m_cached)
+  {
+    evaluateFull(t, y, dydt);
+    return;
+  }
+
+  m_changed.clear();
+
+  for(int j = 0; j < n; j++)
+  {
+    if(fabs(y[j] - m_yReference[j]) > m_absoluteThreshold + m_relativeThreshold * fabs(m_yReference[j]))
+      m_changed.push_back(j);
+  }
+
+  affectedComponents(m_changed.data(), static_cast<int>(m_changed.size()), m_affected);
+
+  if(m_affected.size() > m_maxFraction * n)
+  {
+    evaluateFull(t, y, dydt);
+    return;
+  }
+
+  if(!m_affected.empty())
+  {
+    m_partialDerivs(t, y, m_dydtCache.data(), m_affected.data(), static_cast<int>(m_affected.size()), m_userData);
+
+    for(int j : m_changed)
+      m_yReference[j] = y[j];
+  }
+
+  double *cache = m_dydtCache.data();
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for(int i = 0; i < n; i++)
+  {
+    dydt[i] = cache[i];
+  }
+
+  m_partialEvaluations++;
+  m_evaluatedComponents += m_affected.size();
+}
+
+void ODESparseDerivatives::affectedComponents(const int changed[], int count, std::vector<int> &affected)
+{
+  const std::vector<int> &offsets = m_transpose.rowOffsets();
+  const std::vector<int> &rows = m_transpose.columns();
+
+  affected.clear();
+
+  //Marks from earlier calls are told apart by generation instead of clearing n entries each call
+  if(m_mark == std::numeric_limits<int>::max())
+  {
+    std::fill(m_marks.begin(), m_marks.end(), 0);
+    m_mark = 0;
+  }
+
+  m_mark++;
+
+  for(int c = 0; c < count; c++)
+  {
+    int j = changed[c];
+
+    for(int k = offsets[j]; k < offsets[j + 1]; k++)
+    {
+      int i = rows[k];
+
+      if(m_marks[i] != m_mark)
+      {
+        m_marks[i] = m_mark;
+        affected.push_back(i);
+      }
+    }
+  }
+}
+
+void ODESparseDerivatives::evaluateComponents(double t, double y[], double dydt[], const int components[], int count)
+{
+  m_partialDerivs(t, y, dydt, components, count, m_userData);
+  m_partialEvaluations++;
+  m_evaluatedComponents += count;
+}
+
+long long ODESparseDerivatives::fullEvaluations() const
+{
+  return m_fullEvaluations;
+}
+
+long long ODESparseDerivatives::partialEvaluations() const
+{
+  return m_partialEvaluations;
+}
+
+long long ODESparseDerivatives::evaluatedComponents() const
+{
+  return m_evaluatedComponents;
+}
+
+void ODESparseDerivatives::resetCounters()
+{
+  m_fullEvaluations = 0;
+  m_partialEvaluations = 0;
+  m_evaluatedComponents = 0;
+}
+
+void ODESparseDerivatives::computeDerivatives(double t, double y[], double dydt[], void *userData)
+{
+  static_cast<ODESparseDerivatives*>(userData)->evaluate(t, y, dydt);
+}
+
+void ODESparseDerivatives::evaluateFull(double t, double y[], double dydt[])
+{
+  const int n = m_pattern.size();
+
+  m_derivs(t, y, dydt, m_userData);
+
+  m_yReference.assign(y, y + n);
+  m_dydtCache.assign(dydt, dydt + n);
+  m_cached = true;
+
+  m_fullEvaluations++;
+  m_evaluatedComponents += n;
+}
@@ -0,0 +1,237 @@
+/*!
+*  \file    fixedodesolvertest.cpp
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#include "stdafx.h"
+#include "test/fixedodesolvertest.h"
+#include "fixedodesolver.h"
+
+#include <vector>
+
+static double problem1(double t)
+{
+  return -1.0 / sqrt(3.0 - 2.0 * sqrt(1+t*t));
+}
+
+static double problem2(double t)
+{
+  return 2.0 + sqrt(t*t*t + 2.0*t*t - 4.0*t + 2.0);
+}
+
+static void derivativeProb2(double t, double y[], double dydt[], void*)
+{
+  dydt[0] = (3 * t*t + 4 * t - 4)/(2 * y[0] - 4);
+}
+
+template<int N>
+struct FixedProb1
+{
+    void operator()(double t, const std::array<double, N> &y, std::array<double, N> &dydt) const
+    {
+      double s = t / sqrt(1 + t * t);
+
+      for(int i = 0; i < N; i++)
+        dydt[i] = s * pow(y[i], 3);
+    }
+};
+
+template<int N>
+static double solveFixedProb1(typename FixedODESolver<N>::SolverType solverType)
+{
+  FixedODESolver<N> solver(solverType);
+  solver.setRelativeTolerance(1e-5);
+
+  typename FixedODESolver<N>::State y;
+  y.fill(-1.0);
+
+  double t = 0.0;
+  double dt = 0.01;
+  double maxt = 1.1;
+  double error = 0.0;
+
+  while(t + dt < maxt)
+  {
+    solver.solve(y, t, dt, y, FixedProb1<N>());
+
+    double y_anal = problem1(t + dt);
+
+    for(int i = 0; i < N; i++)
+    {
+      double currError = (y[i] - y_anal);
+      error += currError * currError;
+    }
+
+    t += dt;
+  }
+
+  return sqrt(error / N);
+}
+
+static double solveDynamicProb1(int n, ODESolver::SolverType solverType)
+{
+  ODESolver solver(n, solverType);
+  solver.setRelativeTolerance(1e-5);
+  solver.initialize();
+
+  std::vector<double> y(n, -1.0);
+  std::vector<double> y_out(y);
+
+  double t = 0.0;
+  double dt = 0.01;
+  double maxt = 1.1;
+  double error = 0.0;
+
+  while(t + dt < maxt)
+  {
+    solver.solve(y.data(), n, t, dt, y_out.data(), &FixedODESolverTest::derivativeProb1, &n);
+
+    double y_anal = problem1(t + dt);
+
+    for(int i = 0; i < n; i++)
+    {
+      double currError = (y_out[i] - y_anal);
+      error += currError * currError;
+    }
+
+    t += dt;
+    y = y_out;
+  }
+
+  return sqrt(error / n);
+}
+
+template<int N>
+static double solveFixedProb1(int solverType)
+{
+  return solveFixedProb1<N>(solverType == ODESolver::RKQS ? FixedODESolver<N>::RKQS : FixedODESolver<N>::RK4);
+}
+
+void FixedODESolverTest::solveFixedRK4_Prob1()
+{
+  QBENCHMARK
+  {
+    double error = solveFixedProb1<1>(FixedODESolver<1>::RK4);
+    QVERIFY2( error < 1e-4 , QString("Fixed RK4 Problem 1 Error: %1").arg(error).toStdString().c_str());
+  }
+}
+
+void FixedODESolverTest::solveFixedRKQS_Prob1()
+{
+  QBENCHMARK
+  {
+    double error = solveFixedProb1<1>(FixedODESolver<1>::RKQS);
+    QVERIFY2( error < 1e-4 , QString("Fixed RKQS Problem 1 Error: %1").arg(error).toStdString().c_str());
+  }
+}
+
+void FixedODESolverTest::solveFixedRKQS_Prob2()
+{
+  QBENCHMARK
+  {
+    FixedODESolver<1> solver(FixedODESolver<1>::RKQS);
+    solver.setRelativeTolerance(1e-3);
+
+    double y = 3.0;
+    double y_out = y;
+    double t = 1.0;
+    double dt = 0.01;
+    double maxt = 5.0;
+
+    double error = 0.0;
+
+    while(t + dt < maxt)
+    {
+      solver.solve(&y, t, dt, &y_out, &derivativeProb2, nullptr);
+
+      double currError = (y_out - problem2(t + dt));
+      error += currError * currError;
+
+      t += dt;
+      y = y_out;
+    }
+
+    error = sqrt(error);
+
+    QVERIFY2( error < 1e-4 , QString("Fixed RKQS Problem 2 Error: %1").arg(error).toStdString().c_str());
+  }
+}
+
+void FixedODESolverTest::compareFixedDynamic()
+{
+  double fixedError = solveFixedProb1<8>(FixedODESolver<8>::RKQS);
+  double dynamicError = solveDynamicProb1(8, ODESolver::RKQS);
+
+  QVERIFY2( fabs(fixedError - dynamicError) < 1e-10 , QString("Fixed RKQS Error: %1 Dynamic RKQS Error: %2").arg(fixedError).arg(dynamicError).toStdString().c_str());
+}
+
+void FixedODESolverTest::benchmarkFixedDynamic_data()
+{
+  QTest::addColumn<int>("solverType");
+  QTest::addColumn<int>("size");
+  QTest::addColumn<bool>("fixed");
+
+  int sizes[] = {1, 4, 8, 16};
+
+  for(int solverType : {static_cast<int>(ODESolver::RK4), static_cast<int>(ODESolver::RKQS)})
+  {
+    for(int size : sizes)
+    {
+      QString name = QString("%1 N=%2").arg(solverType == ODESolver::RKQS ? "RKQS" : "RK4").arg(size);
+      QTest::newRow(QString("Fixed %1").arg(name).toLatin1().constData()) << solverType << size << true;
+      QTest::newRow(QString("Dynamic %1").arg(name).toLatin1().constData()) << solverType << size << false;
+    }
+  }
+}
+
+void FixedODESolverTest::benchmarkFixedDynamic()
+{
+  QFETCH(int, solverType);
+  QFETCH(int, size);
+  QFETCH(bool, fixed);
+
+  double error = 0.0;
+
+  QBENCHMARK
+  {
+    if(fixed)
+    {
+      switch (size)
+      {
+        case 1: error = solveFixedProb1<1>(solverType); break;
+        case 4: error = solveFixedProb1<4>(solverType); break;
+        case 8: error = solveFixedProb1<8>(solverType); break;
+        default: error = solveFixedProb1<16>(solverType); break;
+      }
+    }
+    else
+    {
+      error = solveDynamicProb1(size, static_cast<ODESolver::SolverType>(solverType));
+    }
+  }
+
+  QVERIFY2( error < 1e-4 , QString("Problem 1 Error: %1").arg(error).toStdString().c_str());
+}
+
+void FixedODESolverTest::derivativeProb1(double t, double y[], double dydt[], void *userData)
+{
+  int n = *static_cast<int*>(userData);
+  double s = t / sqrt(1 + t * t);
+
+  for(int i = 0; i < n; i++)
+    dydt[i] = s * pow(y[i], 3);
+}
@@ -0,0 +1,215 @@
+/*!
+*  \file    lockstepodesolvertest.cpp
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#include "stdafx.h"
+#include "test/lockstepodesolvertest.h"
+#include "lockstepodesolver.h"
+#include "odebatchstate.h"
+#include "odesolver.h"
+
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+
+static std::vector<double> decayRates(int numSystems)
+{
+  std::vector<double> rates(numSystems);
+
+  for(int s = 0; s < numSystems; s++)
+    rates[s] = 1.0 + 7.0 * (s % 13);
+
+  return rates;
+}
+
+static void solveScalar(ODESolver::SolverType solverType, std::vector<double> &rates, std::vector<double> &y, double maxt, double dt)
+{
+  ODESolver solver(1, solverType);
+  solver.setRelativeTolerance(1e-6);
+  solver.initialize();
+
+  for(size_t s = 0; s < rates.size(); s++)
+  {
+    double t = 0.0;
+
+    while(t + dt < maxt)
+    {
+      solver.solve(&y[s], 1, t, dt, &y[s], &LockstepODESolverTest::derivativeDecay, &rates[s]);
+      t += dt;
+    }
+  }
+}
+
+static int solveLockstepBatch(LockstepODESolver::SolverType solverType, int lanes, std::vector<double> &rates, ODEBatchState &y, double maxt, double dt)
+{
+  LockstepODESolver solver(1, lanes, solverType);
+  solver.setRelativeTolerance(1e-6);
+  solver.initialize();
+
+  double t = 0.0;
+  int result = 0;
+
+  while(t + dt < maxt)
+  {
+    result |= solver.solve(y, t, dt, y, &LockstepODESolverTest::derivativeDecayLockstep, &rates);
+    t += dt;
+  }
+
+  return result;
+}
+
+static int solveLockstep(LockstepODESolver::SolverType solverType, int lanes, std::vector<double> &rates, std::vector<double> &y, double maxt, double dt)
+{
+  LockstepODESolver solver(1, lanes, solverType);
+  solver.setRelativeTolerance(1e-6);
+  solver.initialize();
+
+  double t = 0.0;
+  int result = 0;
+
+  while(t + dt < maxt)
+  {
+    result |= solver.solve(y.data(), static_cast<int>(rates.size()), t, dt, y.data(), &LockstepODESolverTest::derivativeDecayLockstep, &rates);
+    t += dt;
+  }
+
+  return result;
+}
+
+void LockstepODESolverTest::solveLockstepRK4()
+{
+  std::vector<double> rates = decayRates(13);
+  std::vector<double> yScalar(13, 1.0), yLockstep(13, 1.0);
+
+  solveScalar(ODESolver::RK4, rates, yScalar, 1.0, 0.01);
+  int result = solveLockstep(LockstepODESolver::RK4, 4, rates, yLockstep, 1.0, 0.01);
+
+  QVERIFY2(result == 0, QString("Lockstep RK4 status: %1").arg(result).toStdString().c_str());
+
+  for(int s = 0; s < 13; s++)
+  {
+    QVERIFY2(fabs(yScalar[s] - yLockstep[s]) < 1e-12, QString("Lockstep RK4 system %1: %2 vs %3").arg(s).arg(yLockstep[s]).arg(yScalar[s]).toStdString().c_str());
+  }
+}
+
+void LockstepODESolverTest::solveLockstepRKQS()
+{
+  std::vector<double> rates = decayRates(13);
+  std::vector<double> yScalar(13, 1.0), yLockstep(13, 1.0);
+
+  solveScalar(ODESolver::RKQS, rates, yScalar, 2.0, 0.1);
+  int result = solveLockstep(LockstepODESolver::RKQS, 8, rates, yLockstep, 2.0, 0.1);
+
+  QVERIFY2(result == 0, QString("Lockstep RKQS status: %1").arg(result).toStdString().c_str());
+
+  for(int s = 0; s < 13; s++)
+  {
+    QVERIFY2(fabs(yScalar[s] - yLockstep[s]) < 1e-12, QString("Lockstep RKQS system %1: %2 vs %3").arg(s).arg(yLockstep[s]).arg(yScalar[s]).toStdString().c_str());
+  }
+}
+
+void LockstepODESolverTest::solveLockstepBatchState()
+{
+  std::vector<double> rates = decayRates(13);
+  std::vector<double> yArray(13, 1.0), yBatch(13, 0.0);
+
+  ODEBatchState batch(1, 13, 4);
+  batch.setSystems(yArray.data());
+
+  QVERIFY2(batch.numBlocks() == 4 && batch.blockStride() == 8, "Batch layout");
+
+  for(int b = 0; b < batch.numBlocks(); b++)
+  {
+    QVERIFY2(reinterpret_cast<uintptr_t>(batch.block(b)) % ODE_BATCH_ALIGNMENT == 0, "Batch block alignment");
+  }
+
+  int arrayResult = solveLockstep(LockstepODESolver::RKQS, 4, rates, yArray, 2.0, 0.1);
+  int batchResult = solveLockstepBatch(LockstepODESolver::RKQS, 4, rates, batch, 2.0, 0.1);
+
+  QVERIFY2(arrayResult == 0 && batchResult == 0, "Lockstep RKQS status");
+
+  batch.systems(yBatch.data());
+
+  for(int s = 0; s < 13; s++)
+  {
+    QVERIFY2(yBatch[s] == yArray[s], QString("Batch state system %1: %2 vs %3").arg(s).arg(yBatch[s]).arg(yArray[s]).toStdString().c_str());
+    QVERIFY2(batch.value(s, 0) == yArray[s], "Batch state value");
+  }
+
+  LockstepODESolver solver(2, 4, LockstepODESolver::RKQS);
+  solver.initialize();
+
+  QVERIFY2(solver.solve(batch, 0.0, 0.1, batch, &LockstepODESolverTest::derivativeDecayLockstep, &rates) == 1, "Batch layout mismatch");
+}
+
+void LockstepODESolverTest::benchmarkLockstepBatchStateRKQS()
+{
+  std::vector<double> rates = decayRates(4096);
+  std::vector<double> y(4096, 1.0);
+
+  ODEBatchState batch(1, 4096, 8);
+  batch.setSystems(y.data());
+
+  QBENCHMARK
+  {
+    solveLockstepBatch(LockstepODESolver::RKQS, 8, rates, batch, 2.0, 0.1);
+  }
+}
+
+void LockstepODESolverTest::benchmarkLockstepRKQS()
+{
+  std::vector<double> rates = decayRates(4096);
+  std::vector<double> y(4096, 1.0);
+
+  QBENCHMARK
+  {
+    solveLockstep(LockstepODESolver::RKQS, 8, rates, y, 2.0, 0.1);
+  }
+}
+
+void LockstepODESolverTest::benchmarkScalarRKQS()
+{
+  std::vector<double> rates = decayRates(4096);
+  std::vector<double> y(4096, 1.0);
+
+  QBENCHMARK
+  {
+    solveScalar(ODESolver::RKQS, rates, y, 2.0, 0.1);
+  }
+}
+
+void LockstepODESolverTest::derivativeDecay(double t, double y[], double dydt[], void *userData)
+{
+  double k = *static_cast<double*>(userData);
+  dydt[0] = -k * (y[0] - cos(t));
+}
+
+void LockstepODESolverTest::derivativeDecayLockstep(const double t[], double y[], double dydt[], int n, int firstSystem, int lanes, void *userData)
+{
+  const std::vector<double> &rates = *static_cast<std::vector<double>*>(userData);
+  int last = static_cast<int>(rates.size()) - 1;
+
+  for(int i = 0; i < n; i++)
+  {
+    for(int l = 0; l < lanes; l++)
+    {
+      double k = rates[std::min(firstSystem + l, last)];
+      dydt[i * lanes + l] = -k * (y[i * lanes + l] - cos(t[l]));
+    }
+  }
+}
@@ -0,0 +1,114 @@
+/*!
+*  \file    odeautotunertest.cpp
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#include "stdafx.h"
+#include "test/odeautotunertest.h"
+#include "odeautotuner.h"
+
+#include <QFile>
+
+#include <math.h>
+#include <memory>
+
+void ODEAutotunerTest::tuneExplicit()
+{
+  int n = 20;
+  std::vector<double> y(n, 1.0);
+
+  ODESolver configuration(n, ODESolver::RKQS);
+  configuration.setRelativeTolerance(1e-7);
+  configuration.setAbsoluteTolerance(1e-9);
+
+  ODEAutotuner tuner(configuration);
+  tuner.setTolerance(1e-5, 1e-7);
+  tuner.setSolveCalls(20);
+  tuner.addCandidate(ODESolver::RKQS);
+  tuner.addCandidate(ODESolver::GBS);
+  tuner.addCandidate(ODESolver::RK4);
+  tuner.addCandidate(ODESolver::EULER);
+
+  QVERIFY2(tuner.tune(y.data(), n, 0.0, 10.0, &ODEAutotunerTest::derivativeForcedOscillators, &n) == 0, "Tune status");
+  QVERIFY(!tuner.fromCache());
+  QCOMPARE((int)tuner.results().size(), 4);
+
+  const ODEAutotunerResult &best = tuner.best();
+  QVERIFY2(best.meetsTolerance() && best.derivativeEvaluations > 0, "Best candidate");
+
+  for(const ODEAutotunerResult &result : tuner.results())
+  {
+    if(result.meetsTolerance())
+      QVERIFY(best.time <= result.time);
+  }
+
+  //Twenty Euler steps of half a time unit are far outside the tolerance
+  QVERIFY2(!tuner.results()[3].meetsTolerance(), "Euler must not meet the tolerance");
+
+  std::unique_ptr<ODESolver> solver(tuner.createSolver());
+  QVERIFY(solver->solverType() == best.solverType);
+}
+
+void ODEAutotunerTest::tuneCache()
+{
+  int n = 20;
+  std::vector<double> y(n, 1.0);
+  QString cacheFile("odeautotunertest_cache.json");
+  QFile::remove(cacheFile);
+
+  ODESolver configuration(n, ODESolver::RKQS);
+  configuration.setRelativeTolerance(1e-7);
+  configuration.setAbsoluteTolerance(1e-9);
+
+  ODEAutotuner tuner(configuration);
+  tuner.setTolerance(1e-5, 1e-7);
+  tuner.setSolveCalls(20);
+  tuner.setRepeats(1);
+  tuner.setCacheFile(cacheFile);
+  tuner.addCandidate(ODESolver::RKQS);
+  tuner.addCandidate(ODESolver::GBS);
+
+  QVERIFY(tuner.tune(y.data(), n, 0.0, 10.0, &ODEAutotunerTest::derivativeForcedOscillators, &n, "oscillators") == 0);
+  QVERIFY(!tuner.fromCache());
+
+  ODEAutotuner cached(configuration);
+  cached.setTolerance(1e-5, 1e-7);
+  cached.setCacheFile(cacheFile);
+
+  QVERIFY(cached.tune(y.data(), n, 0.0, 10.0, &ODEAutotunerTest::derivativeForcedOscillators, &n, "oscillators") == 0);
+  QVERIFY2(cached.fromCache() && cached.results().size() == 1, "Cached choice");
+  QVERIFY(cached.best().solverType == tuner.best().solverType);
+
+  //Another problem name is another signature and, with no candidates, cannot be tuned
+  QVERIFY(cached.tune(y.data(), n, 0.0, 10.0, &ODEAutotunerTest::derivativeForcedOscillators, &n, "other") == 1);
+
+  QFile::remove(cacheFile);
+}
+
+void ODEAutotunerTest::derivativeForcedOscillators(double t, double y[], double dydt[], void *userData)
+{
+  int n = *(int*)userData;
+
+  for(int i = 0; i < n; i += 2)
+  {
+    double omega = 1.0 + 0.1 * i;
+    int next = (i + 2) % n;
+
+    dydt[i] = y[i + 1];
+    dydt[i + 1] = -omega * omega * y[i] - 0.1 * y[i + 1] + 0.05 * (y[next] - y[i]) + cos(t);
+  }
+}
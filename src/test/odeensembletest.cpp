@@ -0,0 +1,127 @@
+/*!
+*  \file    odeensembletest.cpp
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#include "stdafx.h"
+#include "test/odeensembletest.h"
+#include "odeensemble.h"
+
+#include <math.h>
+#include <algorithm>
+
+void ODEEnsembleTest::ensembleRKQS()
+{
+  int n = 2, members = 37, numOutputs = 4;
+  double t = 0.0, dt = 0.5;
+  std::vector<double> y0(members * n), parameters(members * 2), output(numOutputs * members * n);
+
+  for(int m = 0; m < members; m++)
+  {
+    y0[m * n] = 1.0;
+    y0[m * n + 1] = 0.1 * m;
+    parameters[m * 2] = 1.0 + m;
+    parameters[m * 2 + 1] = 0.05 * m;
+  }
+
+  ODESolver configuration(n, ODESolver::RKQS);
+  configuration.setRelativeTolerance(1e-8);
+  configuration.setCollectStatistics(true);
+
+  ODEEnsemble ensemble(configuration, 2);
+  ensemble.initialize();
+
+  int status = ensemble.solve(members, y0.data(), parameters.data(), t, dt, numOutputs, output.data(),
+                              &ODEEnsembleTest::derivativeOscillator, nullptr);
+
+  QVERIFY2(status == 0, "Ensemble status");
+  QVERIFY2(ensemble.statistics().solveCalls == members * numOutputs, "One solve call per member and output");
+
+  //Members must not depend on the thread or the other members they were integrated with
+  for(int m = 0; m < members; m += 9)
+  {
+    ODESolver solver(n, ODESolver::RKQS);
+    solver.setRelativeTolerance(1e-8);
+    solver.initialize();
+
+    std::vector<double> single(numOutputs * n);
+    ODEEnsemble one(solver, 2);
+    one.initialize();
+    one.solve(1, &y0[m * n], &parameters[m * 2], t, dt, numOutputs, single.data(), &ODEEnsembleTest::derivativeOscillator, nullptr);
+
+    for(int k = 0; k < numOutputs; k++)
+    {
+      for(int i = 0; i < n; i++)
+      {
+        QVERIFY2(output[(k * members + m) * n + i] == single[k * n + i], QString("Member %1 output %2").arg(m).arg(k).toStdString().c_str());
+      }
+    }
+  }
+}
+
+void ODEEnsembleTest::ensembleLockstepRK4()
+{
+  int n = 2, members = 13, numOutputs = 3;
+  double t = 0.0, dt = 0.01;
+  std::vector<double> y0(members * n), parameters(members * 2), output(numOutputs * members * n), lockstepOutput(output.size());
+
+  for(int m = 0; m < members; m++)
+  {
+    y0[m * n] = 1.0 - 0.05 * m;
+    y0[m * n + 1] = 0.0;
+    parameters[m * 2] = 4.0 + m;
+    parameters[m * 2 + 1] = 0.1;
+  }
+
+  ODEEnsemble ensemble(ODESolver(n, ODESolver::RK4), 2);
+  ensemble.setLanes(4);
+  ensemble.initialize();
+
+  int status = ensemble.solve(members, y0.data(), parameters.data(), t, dt, numOutputs, output.data(),
+                              &ODEEnsembleTest::derivativeOscillator, nullptr);
+  int lockstepStatus = ensemble.solve(members, y0.data(), parameters.data(), t, dt, numOutputs, lockstepOutput.data(),
+                                      &ODEEnsembleTest::derivativeOscillatorLockstep, nullptr);
+
+  double difference = 0.0;
+
+  for(size_t i = 0; i < output.size(); i++)
+    difference = std::max(difference, fabs(output[i] - lockstepOutput[i]));
+
+  QVERIFY2(status == 0 && lockstepStatus == 0, "Ensemble status");
+  QVERIFY2(difference < 1e-12, QString("Lockstep difference: %1").arg(difference).toStdString().c_str());
+
+  ODEEnsemble euler(ODESolver(n, ODESolver::EULER), 2);
+  euler.initialize();
+
+  QVERIFY2(euler.solve(members, y0.data(), parameters.data(), t, dt, numOutputs, lockstepOutput.data(),
+                           &ODEEnsembleTest::derivativeOscillatorLockstep, nullptr) == 1, "Lockstep needs RK4 or RKQS");
+}
+
+void ODEEnsembleTest::derivativeOscillator(double, double y[], double dydt[], const double parameters[], void *)
+{
+  dydt[0] = y[1];
+  dydt[1] = -parameters[0] * y[0] - parameters[1] * y[1];
+}
+
+void ODEEnsembleTest::derivativeOscillatorLockstep(const double[], double y[], double dydt[], int, const double parameters[], int lanes, void *)
+{
+  for(int l = 0; l < lanes; l++)
+  {
+    dydt[l] = y[lanes + l];
+    dydt[lanes + l] = -parameters[l] * y[l] - parameters[lanes + l] * y[lanes + l];
+  }
+}
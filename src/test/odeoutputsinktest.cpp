@@ -0,0 +1,177 @@
+/*!
+*  \file    odeoutputsinktest.cpp
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#include "stdafx.h"
+#include "test/odeoutputsinktest.h"
+#include "odesolver.h"
+#include "odeoutputsink.h"
+
+#include <math.h>
+
+class ODEMemorySink : public ODEOutputSink
+{
+  public:
+
+    void write(double t, const double y[], int n) override
+    {
+      times.push_back(t);
+      values.insert(values.end(), y, y + n);
+    }
+
+    std::vector<double> times,
+    values;
+};
+
+void ODEOutputSinkTest::trajectoryRKQS()
+{
+  int n = 3;
+  QString filePath = "odeoutputsinktest_rkqs.bin";
+
+  ODETrajectoryWriter writer(filePath);
+  writer.setChunkSize(16);
+  QVERIFY2(writer.open(n), "Open trajectory");
+
+  ODESolver solver(n, ODESolver::RKQS);
+  solver.setRelativeTolerance(1e-8);
+  solver.initialize();
+  solver.setOutputSink(&writer, 0.0, 0.01);
+
+  std::vector<double> y(n, 1.0), yout(n, 0.0);
+  double dt = 0.5;
+
+  for(double t = 0.0; t < 4.0 - 1e-12; t += dt)
+  {
+    QVERIFY2(solver.solve(y.data(), n, t, dt, yout.data(), &ODEOutputSinkTest::derivativeDecay, &n) == 0, "RKQS solve");
+    y = yout;
+  }
+
+  QVERIFY2(writer.close(), "Close trajectory");
+  QVERIFY2(writer.records() == 401, QString("Records written: %1").arg(writer.records()).toStdString().c_str());
+
+  ODETrajectoryReader reader;
+  QVERIFY2(reader.open(filePath), "Read trajectory");
+  QVERIFY2(reader.records() == 401 && reader.size() == n && reader.components().size() == 3, "Trajectory layout");
+
+  double error = 0.0;
+
+  for(long long r = 0; r < reader.records(); r++)
+  {
+    double t = reader.time(r);
+    const double *values = reader.values(r);
+
+    QVERIFY2(fabs(t - 0.01 * r) < 1e-12, "Output time");
+
+    for(int i = 0; i < n; i++)
+      error = std::max(error, fabs(values[i] - exp(-(i + 1.0) * t)));
+  }
+
+  //Cubic Hermite interpolation between steps of up to about 0.06
+  QVERIFY2(error < 1e-5, QString("RKQS dense output error: %1").arg(error).toStdString().c_str());
+
+  reader.close();
+  QFile::remove(filePath);
+}
+
+void ODEOutputSinkTest::trajectoryComponentsRK4()
+{
+  int n = 3;
+  QString filePath = "odeoutputsinktest_rk4.bin";
+
+  ODETrajectoryWriter writer(filePath);
+  writer.setComponents({2, 0});
+  writer.setDownsample(3);
+  writer.setChunkSize(5);
+  QVERIFY2(writer.open(n), "Open trajectory");
+
+  ODESolver solver(n, ODESolver::RK4);
+  solver.initialize();
+  solver.setOutputSink(&writer, 0.0, 0.005);
+
+  std::vector<double> y(n, 1.0);
+  double dt = 0.02;
+
+  //Output in place to check interpolation does not depend on y being preserved
+  for(int step = 0; step < 100; step++)
+  {
+    solver.solve(y.data(), n, step * dt, dt, y.data(), &ODEOutputSinkTest::derivativeDecay, &n);
+  }
+
+  QVERIFY2(writer.close(), "Close trajectory");
+
+  ODETrajectoryReader reader;
+  QVERIFY2(reader.open(filePath), "Read trajectory");
+
+  //401 output times, every third written
+  QVERIFY2(reader.records() == 134, QString("Records: %1").arg(reader.records()).toStdString().c_str());
+  QVERIFY2(reader.components().size() == 2 && reader.components()[0] == 2 && reader.components()[1] == 0, "Components");
+
+  double error = 0.0;
+
+  for(long long r = 0; r < reader.records(); r++)
+  {
+    double t = reader.time(r);
+    QVERIFY2(fabs(t - 0.015 * r) < 1e-12, "Downsampled output time");
+
+    error = std::max(error, fabs(reader.values(r)[0] - exp(-3.0 * t)));
+    error = std::max(error, fabs(reader.values(r)[1] - exp(-t)));
+  }
+
+  QVERIFY2(error < 1e-6, QString("RK4 dense output error: %1").arg(error).toStdString().c_str());
+
+  reader.close();
+  QFile::remove(filePath);
+}
+
+void ODEOutputSinkTest::outputTimesEuler()
+{
+  int n = 1;
+  ODEMemorySink sink;
+
+  ODESolver solver(n, ODESolver::EULER);
+  solver.initialize();
+  solver.setOutputSink(&sink, std::vector<double>({-1.0, 0.0, 0.25, 0.5, 0.55, 1.0}));
+
+  double y = 1.0, yout = 0.0;
+  double dt = 0.5;
+
+  for(double t = 0.0; t < 1.0; t += dt)
+  {
+    solver.solve(&y, n, t, dt, &yout, &ODEOutputSinkTest::derivativeDecay, &n);
+
+    //Linear output between the ends of the step
+    if(t == 0.0)
+    {
+      QVERIFY2(sink.times.size() == 3, "Outputs of the first step");
+      QVERIFY2(sink.values[0] == 1.0 && sink.values[2] == yout, "Outputs at the ends of the first step");
+      QVERIFY2(fabs(sink.values[1] - 0.5 * (y + yout)) < 1e-15, "Linear output");
+    }
+
+    y = yout;
+  }
+
+  QVERIFY2(sink.times.size() == 5 && sink.times.back() == 1.0 && sink.values.back() == yout, "Outputs of the second step");
+}
+
+void ODEOutputSinkTest::derivativeDecay(double, double y[], double dydt[], void *userData)
+{
+  int n = *static_cast<int*>(userData);
+
+  for(int i = 0; i < n; i++)
+    dydt[i] = -(i + 1.0) * y[i];
+}
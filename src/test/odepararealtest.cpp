@@ -0,0 +1,124 @@
+/*!
+*  \file    odepararealtest.cpp
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#include "stdafx.h"
+#include "test/odepararealtest.h"
+#include "odeparareal.h"
+
+#include <math.h>
+#include <memory>
+
+void ODEPararealTest::cloneSolver()
+{
+  int n = 6;
+  std::vector<double> y(n, 1.0), yClone(n, 1.0);
+
+  ODESolver solver(n, ODESolver::RKQS);
+  solver.setRelativeTolerance(1e-9);
+  solver.setAbsoluteTolerance(1e-12);
+  solver.initialize();
+
+  std::unique_ptr<ODESolver> clone(solver.clone());
+
+  QVERIFY2(clone->solverType() == ODESolver::RKQS && clone->relativeTolerance() == 1e-9, "Cloned configuration");
+
+  for(int s = 0; s < 10; s++)
+  {
+    solver.solve(y.data(), n, s * 0.5, 0.5, y.data(), &ODEPararealTest::derivativeForcedDecay, &n);
+    clone->solve(yClone.data(), n, s * 0.5, 0.5, yClone.data(), &ODEPararealTest::derivativeForcedDecay, &n);
+  }
+
+  QVERIFY2(y == yClone, "Clone result");
+}
+
+void ODEPararealTest::convergedPararealRK4()
+{
+  int n = 8, slices = 8, fineSteps = 100;
+  double t = 0.0, dt = 4.0;
+  std::vector<double> y0(n), ySerial(n), yParareal(n);
+
+  for(int i = 0; i < n; i++)
+    y0[i] = 1.0 + 0.1 * i;
+
+  ODESolver coarse(n, ODESolver::RK4), fine(n, ODESolver::RK4);
+  fine.initialize();
+
+  ySerial = y0;
+  double h = dt / (slices * fineSteps);
+
+  for(int s = 0; s < slices * fineSteps; s++)
+    fine.solve(ySerial.data(), n, t + s * h, h, ySerial.data(), &ODEPararealTest::derivativeForcedDecay, &n);
+
+  ODEParareal parareal(coarse, fine, slices);
+  parareal.setCoarseSteps(5);
+  parareal.setFineSteps(fineSteps);
+  parareal.initialize();
+
+  int status = parareal.solve(y0.data(), n, t, dt, yParareal.data(), &ODEPararealTest::derivativeForcedDecay, &n);
+
+  double difference = 0.0;
+
+  for(int i = 0; i < n; i++)
+    difference = std::max(difference, fabs(yParareal[i] - ySerial[i]));
+
+  QVERIFY2(status == 0, "Parareal status");
+  QVERIFY2(parareal.getIterations() <= 3, QString("Iterations: %1").arg(parareal.getIterations()).toStdString().c_str());
+  QVERIFY2(difference < 1e-9, QString("Parareal difference: %1").arg(difference).toStdString().c_str());
+}
+
+void ODEPararealTest::exactPararealRKQS()
+{
+  int n = 8, slices = 5;
+  double t = 0.0, dt = 5.0;
+  std::vector<double> y0(n), ySerial(n), yParareal(n);
+
+  for(int i = 0; i < n; i++)
+    y0[i] = cos(0.5 * i);
+
+  ODESolver coarse(n, ODESolver::EULER), fine(n, ODESolver::RKQS);
+  fine.setCollectStatistics(true);
+  fine.initialize();
+
+  ODEParareal parareal(coarse, fine, slices);
+  parareal.setCoarseSteps(10);
+  parareal.setTolerance(0.0);
+  parareal.initialize();
+
+  ySerial = y0;
+
+  for(int s = 0; s < slices; s++)
+    fine.solve(ySerial.data(), n, t + s * dt / slices, dt / slices, ySerial.data(), &ODEPararealTest::derivativeForcedDecay, &n);
+
+  int status = parareal.solve(y0.data(), n, t, dt, yParareal.data(), &ODEPararealTest::derivativeForcedDecay, &n);
+
+  QVERIFY2(status == 0, "Parareal status");
+  QVERIFY2(parareal.getIterations() == slices, QString("Iterations: %1").arg(parareal.getIterations()).toStdString().c_str());
+  QVERIFY2(yParareal == ySerial, "Serial solution reproduced");
+  QVERIFY2(parareal.statistics().solveCalls > 0, "Fine statistics");
+}
+
+void ODEPararealTest::derivativeForcedDecay(double t, double y[], double dydt[], void *userData)
+{
+  int n = *static_cast<int*>(userData);
+
+  for(int i = 0; i < n; i++)
+  {
+    dydt[i] = -(i + 1) * y[i] + sin(t) * y[(i + 1) % n];
+  }
+}
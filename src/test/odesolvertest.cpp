@@ -20,6 +20,11 @@
 #include "stdafx.h"
 #include "test/odesolvertest.h"
 #include "odesolver.h"
+#include "odesolvercheckpoint.h"
+#include "odekernels.h"
+#include "odeasync.h"
+
+#include <atomic>
 
 void ODESolverTest::solveODEEuler_Prob1()
 {
@@ -120,6 +125,40 @@ void ODESolverTest::solveODERKQS_Prob1()
   QVERIFY2( error < 1e-4 , QString("RKQS Problem 1 Error: %1").arg(error).toStdString().c_str());
 }
 
+void ODESolverTest::solveODELSRK4_Prob1()
+{
+  QBENCHMARK
+  {
+    ODESolver solver(1, ODESolver::LSRK4);
+    solver.initialize();
+
+    double y = -1.0;
+    double y_out = y;
+    double t = 0.0;
+    double dt = 0.01;
+    //Problem 1 has a pole at t = 1.118 where the error constant of the scheme, larger than that of RK4, dominates
+    double maxt = 1.0;
+
+    double error = 0.0;
+
+    while(t + dt < maxt)
+    {
+      solver.solve(&y, 1, t, dt, &y_out, &ODESolverTest::derivativeProb1, nullptr);
+
+      double y_anal = problem1(t + dt);
+      double currError = (y_out - y_anal);
+      error += currError * currError;
+
+      t += dt;
+      y = y_out;
+    }
+
+    error = sqrt(error);
+
+    QVERIFY2( error < 1e-4 , QString("LSRK4 Problem 1 Error: %1").arg(error).toStdString().c_str());
+  }
+}
+
 #ifdef USE_CVODE
 
 void ODESolverTest::solveODEAdams_Prob1()
@@ -307,6 +346,136 @@ void ODESolverTest::solveODERKQS_Prob2()
   }
 }
 
+void ODESolverTest::solveODELSRK45_Prob2()
+{
+  QBENCHMARK
+  {
+    ODESolver solver(1, ODESolver::LSRK45);
+    solver.setRelativeTolerance(1e-6);
+    solver.setAbsoluteTolerance(1e-8);
+    solver.setCollectStatistics(true);
+    solver.initialize();
+
+    double y = 3.0;
+    double t = 1.0;
+    double dt = 0.1;
+    double maxt = 5.0;
+
+    double error = 0.0;
+
+    //yout aliases y
+    while(t + dt < maxt)
+    {
+      QVERIFY2(solver.solve(&y, 1, t, dt, &y, &ODESolverTest::derivativeProb2, nullptr) == 0, "LSRK45 solve");
+
+      double currError = (y - problem2(t + dt));
+      error += currError * currError;
+
+      t += dt;
+    }
+
+    error = sqrt(error);
+
+    QVERIFY2( error < 1e-4 , QString("LSRK45 Problem 2 Error: %1").arg(error).toStdString().c_str());
+    QVERIFY2( solver.statistics().derivativeEvaluations == 5 * (solver.statistics().acceptedSteps + solver.statistics().rejectedSteps),
+              "Five derivative evaluations per step");
+  }
+}
+
+void ODESolverTest::solveODENativeAdams_Prob2()
+{
+  QBENCHMARK
+  {
+    ODESolver solver(1, ODESolver::ADAMS);
+    solver.setRelativeTolerance(1e-8);
+    solver.setAbsoluteTolerance(1e-10);
+    solver.setOrder(12);
+    solver.initialize();
+
+    double y = 3.0;
+    double t = 1.0;
+    double dt = 0.1;
+    double maxt = 5.0;
+
+    double error = 0.0;
+
+    //yout aliases y
+    while(t + dt < maxt)
+    {
+      QVERIFY2(solver.solve(&y, 1, t, dt, &y, &ODESolverTest::derivativeProb2, nullptr) == 0, "Adams solve");
+
+      double currError = (y - problem2(t + dt));
+      error += currError * currError;
+
+      t += dt;
+    }
+
+    error = sqrt(error);
+
+    QVERIFY2( error < 1e-5 , QString("Adams Problem 2 Error: %1").arg(error).toStdString().c_str());
+  }
+}
+
+void ODESolverTest::nativeAdamsHistory()
+{
+  ODESolver solver(1, ODESolver::ADAMS);
+  solver.setRelativeTolerance(1e-9);
+  solver.setCollectStatistics(true);
+  solver.initialize();
+
+  double t0 = 1.0;
+  double dt = 0.05;
+  int steps = 60;
+  int restartStep = 30;
+
+  double y = 3.0, y_out = y;
+  std::vector<char> state;
+  double yRestart = 0.0;
+
+  for(int i = 0; i < steps; i++)
+  {
+    if(i == restartStep)
+    {
+      state = solver.saveState();
+      yRestart = y;
+    }
+
+    QVERIFY2(solver.solve(&y, 1, t0 + i * dt, dt, &y_out, &ODESolverTest::derivativeProb2, nullptr) == 0, "Adams solve");
+    y = y_out;
+  }
+
+  const ODESolverStatistics &statistics = solver.statistics();
+
+  //Two evaluations per accepted step, one per rejected step and one to start the only history
+  QVERIFY2(statistics.derivativeEvaluations == 2 * statistics.acceptedSteps + statistics.rejectedSteps + 1,
+           QString("Adams derivative evaluations: %1").arg(statistics.derivativeEvaluations).toStdString().c_str());
+  QVERIFY2(fabs(y - problem2(t0 + steps * dt)) < 1e-6, "Adams error");
+
+  ODESolver restarted(1, ODESolver::ADAMS);
+  QVERIFY2(restarted.restoreState(state.data(), state.size()) == 0, "Restore Adams state");
+
+  double yr = yRestart;
+
+  for(int i = restartStep; i < steps; i++)
+  {
+    restarted.solve(&yr, 1, t0 + i * dt, dt, &y_out, &ODESolverTest::derivativeProb2, nullptr);
+    yr = y_out;
+  }
+
+  QVERIFY2(memcmp(&yr, &y, sizeof(double)) == 0, QString("Adams restart differs: %1 vs %2").arg(yr, 0, 'g', 17).arg(y, 0, 'g', 17).toStdString().c_str());
+
+  //A state other than where the last call ended starts a new history
+  long long evaluations = solver.statistics().derivativeEvaluations;
+  long long accepted = solver.statistics().acceptedSteps;
+  long long rejectedSteps = solver.statistics().rejectedSteps;
+  double yChanged = y * 1.001;
+
+  solver.solve(&yChanged, 1, t0 + steps * dt, dt, &y_out, &ODESolverTest::derivativeProb2, nullptr);
+
+  QVERIFY2(solver.statistics().derivativeEvaluations - evaluations == 2 * (solver.statistics().acceptedSteps - accepted) +
+           (solver.statistics().rejectedSteps - rejectedSteps) + 1, "Adams restart on a changed state");
+}
+
 #ifdef USE_CVODE
 
 void ODESolverTest::solveODEAdams_Prob2()
@@ -391,6 +560,840 @@ void ODESolverTest::solveODEBDF_Prob2()
 
 #endif
 
+void ODESolverTest::solveODERK4_Statistics()
+{
+  ODESolver solver(1, ODESolver::RK4);
+  solver.initialize();
+
+  double y = -1.0;
+  double y_out = y;
+  double t = 0.0;
+  double dt = 0.01;
+
+  solver.solve(&y, 1, t, dt, &y_out, &ODESolverTest::derivativeProb1, nullptr);
+
+  QVERIFY2(solver.statistics().solveCalls == 0, "Statistics collected while disabled");
+
+  solver.setCollectStatistics(true);
+
+  for(int i = 0; i < 10; i++)
+  {
+    solver.solve(&y, 1, t, dt, &y_out, &ODESolverTest::derivativeProb1, nullptr);
+    t += dt;
+    y = y_out;
+  }
+
+  const ODESolverStatistics &statistics = solver.statistics();
+
+  QVERIFY2(statistics.solveCalls == 10, QString("RK4 solve calls: %1").arg(statistics.solveCalls).toStdString().c_str());
+  QVERIFY2(statistics.derivativeEvaluations == 40, QString("RK4 derivative evaluations: %1").arg(statistics.derivativeEvaluations).toStdString().c_str());
+  QVERIFY2(statistics.acceptedSteps == 10 && statistics.rejectedSteps == 0, "RK4 step counts");
+  QVERIFY2(fabs(statistics.minStep - dt) < 1e-15 && fabs(statistics.maxStep - dt) < 1e-15, "RK4 step size range");
+  QVERIFY2(solver.lastStatistics().derivativeEvaluations == 4, "RK4 per call derivative evaluations");
+}
+
+void ODESolverTest::solveODERKQS_Statistics()
+{
+  ODESolver solver(1, ODESolver::RKQS);
+  solver.setRelativeTolerance(1e-8);
+  solver.setCollectStatistics(true);
+  solver.initialize();
+
+  double y = 3.0;
+  double y_out = y;
+  double t = 1.0;
+  double dt = 0.5;
+  double maxt = 5.0;
+
+  ODESolverStatistics sum;
+
+  while(t + dt <= maxt)
+  {
+    solver.solve(&y, 1, t, dt, &y_out, &ODESolverTest::derivativeProb2, nullptr);
+
+    const ODESolverStatistics &last = solver.lastStatistics();
+
+    //One derivative per step plus five per Cash-Karp attempt
+    QVERIFY2(last.derivativeEvaluations == last.acceptedSteps + 5 * (last.acceptedSteps + last.rejectedSteps),
+             QString("RKQS derivative evaluations: %1").arg(last.derivativeEvaluations).toStdString().c_str());
+    QVERIFY2(last.acceptedSteps == solver.getIterations(), "RKQS accepted steps");
+
+    sum.accumulate(last);
+    t += dt;
+    y = y_out;
+  }
+
+  const ODESolverStatistics &statistics = solver.statistics();
+
+  QVERIFY2(statistics.derivativeEvaluations == sum.derivativeEvaluations, "RKQS cumulative derivative evaluations");
+  QVERIFY2(statistics.acceptedSteps > statistics.solveCalls, "RKQS expected sub-stepping");
+  QVERIFY2(statistics.minStep > 0.0 && statistics.minStep <= statistics.maxStep && statistics.maxStep <= dt, "RKQS step size range");
+  QVERIFY2(statistics.solveTime >= statistics.derivativeTime, "RKQS solve time");
+  QVERIFY2(statistics.stepControlTime > 0.0 && statistics.solveTime >= statistics.stepControlTime, "RKQS step control time");
+  QVERIFY2(statistics.linearSolveTime == 0.0, "RKQS linear solve time");
+
+  solver.resetStatistics();
+
+  QVERIFY2(solver.statistics().solveCalls == 0, "RKQS reset statistics");
+}
+
+void ODESolverTest::solveODEGBS_Prob1()
+{
+  long long evaluations[2];
+  ODESolver::SolverType solverTypes[2] = {ODESolver::GBS, ODESolver::RKQS};
+
+  for(int s = 0; s < 2; s++)
+  {
+    ODESolver solver(1, solverTypes[s]);
+    solver.setRelativeTolerance(1e-12);
+    solver.setAbsoluteTolerance(1e-14);
+    solver.setOrder(8);
+    solver.setCollectStatistics(true);
+    solver.initialize();
+
+    double y = -1.0;
+    double y_out = y;
+    double t = 0.0;
+    double dt = 0.1;
+    double maxt = 1.1;
+
+    double error = 0.0;
+
+    while(t + dt < maxt)
+    {
+      QVERIFY2(solver.solve(&y, 1, t, dt, &y_out, &ODESolverTest::derivativeProb1, nullptr) == 0, "Solve");
+
+      double currError = (y_out - problem1(t + dt));
+      error = std::max(error, fabs(currError));
+
+      t += dt;
+      y = y_out;
+    }
+
+    if(solverTypes[s] == ODESolver::GBS)
+      QVERIFY2( error < 1e-9 , QString("GBS Problem 1 Error: %1").arg(error).toStdString().c_str());
+
+    evaluations[s] = solver.statistics().derivativeEvaluations;
+  }
+
+  QVERIFY2(evaluations[0] < evaluations[1], QString("GBS derivative evaluations %1, RKQS %2").arg(evaluations[0]).arg(evaluations[1]).toStdString().c_str());
+}
+
+//Problem 2 for every component, with a different initial condition per component
+static void derivativeProb2Components(double t, double y[], double dydt[], void* userData)
+{
+  int n = *static_cast<int*>(userData);
+
+  for(int i = 0; i < n; i++)
+    dydt[i] = (3 * t*t + 4 * t - 4)/(2 * y[i] - 4);
+}
+
+void ODESolverTest::gbsParallelExtrapolation()
+{
+  int n = 64;
+  std::vector<double> y[2];
+
+  for(int p = 0; p < 2; p++)
+  {
+    ODESolver solver(n, ODESolver::GBS);
+    solver.setRelativeTolerance(1e-10);
+    solver.setParallelExtrapolation(p == 1);
+    solver.setCollectStatistics(true);
+    solver.initialize();
+
+    y[p].assign(n, 3.0);
+    std::vector<double> yout(n);
+
+    for(int i = 0; i < n; i++)
+      y[p][i] += 0.01 * i;
+
+    double t = 1.0;
+    double dt = 0.5;
+
+    for(int step = 0; step < 8; step++)
+    {
+      QVERIFY2(solver.solve(y[p].data(), n, t, dt, yout.data(), &derivativeProb2Components, &n) == 0, "GBS solve");
+      y[p] = yout;
+      t += dt;
+    }
+
+    QVERIFY2(solver.statistics().acceptedSteps > 0, "GBS steps");
+  }
+
+  QVERIFY2(memcmp(y[0].data(), y[1].data(), n * sizeof(double)) == 0, "Parallel extrapolation differs from sequential");
+}
+
+void ODESolverTest::gbsSettingsAfterInitialize()
+{
+  int n = 64;
+  std::vector<double> y[2];
+
+  for(int p = 0; p < 2; p++)
+  {
+    ODESolver solver(n, ODESolver::GBS);
+    solver.setRelativeTolerance(1e-10);
+    solver.setOrder(4);
+    solver.initialize();
+
+    //Larger tables than were allocated, which must not be used until the next initialize
+    if(p == 1)
+    {
+      solver.setOrder(12);
+      solver.setParallelExtrapolation(true);
+    }
+
+    y[p].assign(n, 3.0);
+    std::vector<double> yout(n);
+
+    for(int i = 0; i < n; i++)
+      y[p][i] += 0.01 * i;
+
+    double t = 1.0;
+    double dt = 0.5;
+
+    for(int step = 0; step < 4; step++)
+    {
+      QVERIFY2(solver.solve(y[p].data(), n, t, dt, yout.data(), &derivativeProb2Components, &n) == 0, "GBS solve");
+      y[p] = yout;
+      t += dt;
+    }
+
+    //The new settings apply from here on
+    if(p == 1)
+    {
+      solver.initialize();
+      QVERIFY2(solver.solve(y[p].data(), n, t, dt, yout.data(), &derivativeProb2Components, &n) == 0, "GBS solve after initialize");
+    }
+  }
+
+  QVERIFY2(memcmp(y[0].data(), y[1].data(), n * sizeof(double)) == 0, "Settings changed after initialize were used");
+}
+
+//Central differences of u_t = u_xx on (0, 1) with u = 0 at both ends
+static void derivativeHeat(double, double y[], double dydt[], void* userData)
+{
+  int n = *static_cast<int*>(userData);
+  double dx = 1.0 / (n + 1);
+
+  for(int i = 0; i < n; i++)
+  {
+    double left = i ? y[i - 1] : 0.0;
+    double right = i < n - 1 ? y[i + 1] : 0.0;
+    dydt[i] = (left - 2.0 * y[i] + right) / (dx * dx);
+  }
+}
+
+void ODESolverTest::solveODERKC_Diffusion()
+{
+  int n = 200;
+  double dx = 1.0 / (n + 1);
+
+  //sin(pi x) is an eigenvector of the discrete Laplacian
+  double lambda = -4.0 / (dx * dx) * sin(M_PI * dx / 2.0) * sin(M_PI * dx / 2.0);
+
+  ODESolver::SolverType solverTypes[2] = {ODESolver::RKC, ODESolver::RKQS};
+  long long evaluations[2];
+
+  for(int s = 0; s < 2; s++)
+  {
+    ODESolver solver(n, solverTypes[s]);
+    solver.setRelativeTolerance(1e-6);
+    solver.setAbsoluteTolerance(1e-8);
+    solver.setCollectStatistics(true);
+    solver.initialize();
+
+    std::vector<double> y(n), yout(n);
+
+    for(int i = 0; i < n; i++)
+      y[i] = sin(M_PI * (i + 1) * dx);
+
+    double t = 0.0;
+    double dt = 0.01;
+
+    for(int step = 0; step < 10; step++)
+    {
+      QVERIFY2(solver.solve(y.data(), n, t, dt, yout.data(), &derivativeHeat, &n) == 0, "Heat solve");
+      y = yout;
+      t += dt;
+    }
+
+    double error = 0.0;
+
+    for(int i = 0; i < n; i++)
+      error = std::max(error, fabs(y[i] - sin(M_PI * (i + 1) * dx) * exp(lambda * t)));
+
+    QVERIFY2(error < 5e-5, QString("Heat error %1 with solver %2").arg(error).arg(solverTypes[s]).toStdString().c_str());
+
+    evaluations[s] = solver.statistics().derivativeEvaluations;
+  }
+
+  QVERIFY2(evaluations[0] * 10 < evaluations[1], QString("RKC derivative evaluations %1, RKQS %2").arg(evaluations[0])
+           .arg(evaluations[1]).toStdString().c_str());
+}
+
+static void derivativeFisher(double t, double y[], double dydt[], void* userData)
+{
+  derivativeHeat(t, y, dydt, userData);
+
+  int n = *static_cast<int*>(userData);
+
+  for(int i = 0; i < n; i++)
+    dydt[i] += y[i] * (1.0 - y[i]);
+}
+
+void ODESolverTest::solveODEExponential_ReactionDiffusion()
+{
+  int n = 100;
+  double dx = 1.0 / (n + 1);
+  double t_end = 0.5;
+
+  ODESolver::SolverType solverTypes[3] = {ODESolver::EXPRK2, ODESolver::EXPRB32, ODESolver::RKQS};
+  std::vector<double> solutions[3];
+  long long steps[3];
+
+  for(int s = 0; s < 3; s++)
+  {
+    ODESolver solver(n, solverTypes[s]);
+    solver.setRelativeTolerance(1e-6);
+    solver.setAbsoluteTolerance(1e-8);
+    solver.setLinearOperator(&derivativeHeat);
+    solver.setCollectStatistics(true);
+    solver.initialize();
+
+    std::vector<double> y(n), yout(n);
+
+    for(int i = 0; i < n; i++)
+      y[i] = 0.5 * sin(M_PI * (i + 1) * dx);
+
+    QVERIFY2(solver.solve(y.data(), n, 0.0, t_end, yout.data(), &derivativeFisher, &n) == 0, "Fisher-KPP solve");
+
+    solutions[s] = yout;
+    steps[s] = solver.statistics().acceptedSteps;
+
+    if(s < 2)
+    {
+      QVERIFY2(solver.statistics().linearIterations > 0, "Krylov iterations");
+      QVERIFY2(solver.statistics().linearSolveTime > 0.0, "Krylov phi-function time");
+    }
+  }
+
+  //Tight tolerance reference
+  ODESolver reference(n, ODESolver::RKQS);
+  reference.setRelativeTolerance(1e-11);
+  reference.setAbsoluteTolerance(1e-13);
+  reference.initialize();
+
+  std::vector<double> y(n), yout(n);
+
+  for(int i = 0; i < n; i++)
+    y[i] = 0.5 * sin(M_PI * (i + 1) * dx);
+
+  reference.solve(y.data(), n, 0.0, t_end, yout.data(), &derivativeFisher, &n);
+
+  for(int s = 0; s < 2; s++)
+  {
+    double error = 0.0;
+
+    for(int i = 0; i < n; i++)
+      error = std::max(error, fabs(solutions[s][i] - yout[i]));
+
+    QVERIFY2(error < 1e-5, QString("Fisher-KPP error %1 with solver %2").arg(error).arg(solverTypes[s]).toStdString().c_str());
+    QVERIFY2(steps[s] * 5 < steps[2], QString("Steps %1 with solver %2, RKQS %3").arg(steps[s]).arg(solverTypes[s])
+             .arg(steps[2]).toStdString().c_str());
+  }
+
+  //Without a linear operator EXPRK2 is not configured
+  ODESolver solver(n, ODESolver::EXPRK2);
+  solver.initialize();
+  QVERIFY2(solver.solve(y.data(), n, 0.0, t_end, yout.data(), &derivativeFisher, &n) == 1, "EXPRK2 without a linear operator");
+}
+
+static void jacobianVectorFisher(double t, double y[], double dydt[], double v[], double Jv[], void* userData)
+{
+  (void)dydt;
+  derivativeHeat(t, v, Jv, userData);
+
+  int n = *static_cast<int*>(userData);
+
+  for(int i = 0; i < n; i++)
+    Jv[i] += (1.0 - 2.0 * y[i]) * v[i];
+}
+
+void ODESolverTest::exponentialJacobianVectorProduct()
+{
+  int n = 100;
+  double dx = 1.0 / (n + 1);
+  std::vector<double> solutions[2];
+  ODESolverStatistics statistics[2];
+
+  for(int s = 0; s < 2; s++)
+  {
+    ODESolver solver(n, ODESolver::EXPRB32);
+    solver.setRelativeTolerance(1e-6);
+    solver.setAbsoluteTolerance(1e-8);
+    solver.setCollectStatistics(true);
+
+    if(s)
+      solver.setJacobianVectorProduct(&jacobianVectorFisher);
+
+    solver.initialize();
+
+    std::vector<double> y(n), yout(n);
+
+    for(int i = 0; i < n; i++)
+      y[i] = 0.5 * sin(M_PI * (i + 1) * dx);
+
+    QVERIFY2(solver.solve(y.data(), n, 0.0, 0.5, yout.data(), &derivativeFisher, &n) == 0, "Fisher-KPP solve");
+
+    solutions[s] = yout;
+    statistics[s] = solver.statistics();
+  }
+
+  double difference = 0.0;
+
+  for(int i = 0; i < n; i++)
+    difference = std::max(difference, fabs(solutions[0][i] - solutions[1][i]));
+
+  QVERIFY2(difference < 1e-6, QString("Difference quotient and analytic products differ by %1").arg(difference).toStdString().c_str());
+  QVERIFY2(statistics[1].jacobianVectorProducts >= statistics[1].linearIterations, "Jacobian-vector products");
+
+  //Every difference quotient costs a derivative evaluation
+  QVERIFY2(statistics[1].derivativeEvaluations * 4 < statistics[0].derivativeEvaluations,
+           QString("Derivative evaluations %1 with analytic products, %2 without").arg(statistics[1].derivativeEvaluations)
+           .arg(statistics[0].derivativeEvaluations).toStdString().c_str());
+}
+
+static void tileDerivativeFisher(double t, double y[], double dydt[], int offset, int begin, int end, void* userData)
+{
+  (void)t;
+  int n = *static_cast<int*>(userData);
+  double dx = 1.0 / (n + 1);
+
+  for(int i = begin; i < end; i++)
+  {
+    double left = i ? y[i - 1 - offset] : 0.0;
+    double right = i < n - 1 ? y[i + 1 - offset] : 0.0;
+    double yi = y[i - offset];
+    dydt[i - offset] = (left - 2.0 * yi + right) / (dx * dx) + yi * (1.0 - yi);
+  }
+}
+
+void ODESolverTest::tiledStages()
+{
+  int n = 1000;
+  double dx = 1.0 / (n + 1);
+
+  ODESolver::SolverType solverTypes[2] = {ODESolver::RK4, ODESolver::RKQS};
+
+  for(int s = 0; s < 2; s++)
+  {
+    std::vector<double> solutions[2];
+
+    for(int tiled = 0; tiled < 2; tiled++)
+    {
+      ODESolver solver(n, solverTypes[s]);
+      solver.setRelativeTolerance(1e-6);
+      solver.setAbsoluteTolerance(1e-8);
+      solver.setCollectStatistics(true);
+
+      //Tiles that do not divide the state, with windows clipped at both boundaries
+      if(tiled)
+      {
+        solver.setTileDerivatives(&tileDerivativeFisher, 1);
+        solver.setTileSize(96);
+      }
+
+      solver.initialize();
+
+      std::vector<double> y(n), yout(n);
+
+      for(int i = 0; i < n; i++)
+        y[i] = 0.5 * sin(M_PI * (i + 1) * dx);
+
+      double t = 0.0, dt = 2e-7;
+
+      for(int step = 0; step < 20; step++)
+      {
+        QVERIFY2(solver.solve(y.data(), n, t, dt, yout.data(), &derivativeFisher, &n) == 0, "Fisher-KPP solve");
+        y = yout;
+        t += dt;
+      }
+
+      QVERIFY(solver.statistics().derivativeTime > 0.0);
+
+      solutions[tiled] = y;
+    }
+
+    double difference = 0.0;
+
+    for(int i = 0; i < n; i++)
+      difference = std::max(difference, fabs(solutions[0][i] - solutions[1][i]));
+
+    QVERIFY2(difference < 1e-12, QString("Tiled stages differ by %1 with solver %2").arg(difference).arg(solverTypes[s])
+             .toStdString().c_str());
+  }
+}
+
+void ODESolverTest::kernelLevels()
+{
+  int n = 1000;
+  double dx = 1.0 / (n + 1);
+
+  ODEKernels::Isa initial = ODEKernels::isa();
+  ODEKernels::Isa supported = ODEKernels::supportedIsa();
+
+  if(supported < ODEKernels::AVX512)
+    QVERIFY(!ODEKernels::setIsa(static_cast<ODEKernels::Isa>(supported + 1)));
+
+  ODESolver::SolverType solverTypes[2] = {ODESolver::RK4, ODESolver::RKQS};
+
+  for(int s = 0; s < 2; s++)
+  {
+    std::vector<double> reference;
+
+    for(int level = ODEKernels::GENERIC; level <= supported; level++)
+    {
+      QVERIFY(ODEKernels::setIsa(static_cast<ODEKernels::Isa>(level)));
+
+      ODESolver solver(n, solverTypes[s]);
+      solver.setRelativeTolerance(1e-6);
+      solver.setAbsoluteTolerance(1e-8);
+      solver.setCollectStatistics(true);
+      solver.initialize();
+
+      std::vector<double> y(n), yout(n);
+
+      for(int i = 0; i < n; i++)
+        y[i] = 0.5 * sin(M_PI * (i + 1) * dx);
+
+      double t = 0.0, dt = 2e-7;
+
+      for(int step = 0; step < 20; step++)
+      {
+        QVERIFY2(solver.solve(y.data(), n, t, dt, yout.data(), &derivativeFisher, &n) == 0, "Fisher-KPP solve");
+        y = yout;
+        t += dt;
+      }
+
+      QCOMPARE(QString(solver.statistics().kernels), QString(ODEKernels::isaName(static_cast<ODEKernels::Isa>(level))));
+
+      if(reference.empty())
+      {
+        reference = y;
+        continue;
+      }
+
+      //Fused multiply-adds round differently from the generic kernels
+      double difference = 0.0;
+
+      for(int i = 0; i < n; i++)
+        difference = std::max(difference, fabs(reference[i] - y[i]));
+
+      QVERIFY2(difference < 1e-10, QString("Kernel level %1 differs by %2 with solver %3").arg(level).arg(difference)
+               .arg(solverTypes[s]).toStdString().c_str());
+    }
+  }
+
+  ODEKernels::setIsa(initial);
+}
+
+//Decay that holds the solving thread at evaluation gate until released
+struct GatedDecay
+{
+    int n, gate;
+    std::atomic<int> evaluations;
+    std::atomic<bool> released;
+};
+
+static void derivativeGatedDecay(double t, double y[], double dydt[], void* userData)
+{
+  GatedDecay *decay = (GatedDecay*)userData;
+
+  if(++decay->evaluations == decay->gate)
+  {
+    while(!decay->released)
+      std::this_thread::yield();
+  }
+
+  for(int i = 0; i < decay->n; i++)
+    dydt[i] = -0.1 * (i + 1) * y[i] + 0.01 * sin(t);
+}
+
+void ODESolverTest::solveAsync()
+{
+  int n = 10;
+  GatedDecay decay;
+  decay.n = n;
+  decay.gate = -1;
+  decay.evaluations = 0;
+  decay.released = true;
+
+  std::vector<double> y(n, 1.0), ySync(n), yMid(n), yEnd(n);
+
+  ODESolver synchronous(n, ODESolver::RKQS);
+  synchronous.setRelativeTolerance(1e-9);
+  synchronous.setAbsoluteTolerance(1e-12);
+  synchronous.initialize();
+
+  std::unique_ptr<ODESolver> asynchronous(synchronous.clone());
+
+  QVERIFY(synchronous.solve(y.data(), n, 0.0, 2.0, ySync.data(), &derivativeGatedDecay, &decay) == 0);
+  QVERIFY(synchronous.solve(ySync.data(), n, 2.0, 2.0, ySync.data(), &derivativeGatedDecay, &decay) == 0);
+
+  //The second call reads the output of the first, which it must wait for
+  std::shared_ptr<ODESolveHandle> first = asynchronous->solveAsync(y.data(), n, 0.0, 2.0, yMid.data(), &derivativeGatedDecay, &decay);
+  std::shared_ptr<ODESolveHandle> second = asynchronous->solveAsync(yMid.data(), n, 2.0, 2.0, yEnd.data(), &derivativeGatedDecay, &decay);
+
+  QCOMPARE(second->wait(), 0);
+  QVERIFY(first->isFinished() && first->status() == 0);
+  QCOMPARE(second->progress(), 1.0);
+  QVERIFY2(yEnd == ySync, "Asynchronous result");
+}
+
+void ODESolverTest::solveAsyncCancel()
+{
+  int n = 10;
+  GatedDecay decay;
+  decay.n = n;
+  decay.gate = 60;
+  decay.evaluations = 0;
+  decay.released = false;
+
+  std::vector<double> y(n, 1.0), yFull(n), yout(n);
+
+  ODESolver solver(n, ODESolver::RKQS);
+  solver.setRelativeTolerance(1e-10);
+  solver.setAbsoluteTolerance(1e-12);
+  solver.initialize();
+
+  std::shared_ptr<ODESolveHandle> handle = solver.solveAsync(y.data(), n, 0.0, 10.0, yout.data(), &derivativeGatedDecay, &decay);
+
+  //Cancel while the solve is held inside a step
+  while(decay.evaluations < decay.gate)
+    std::this_thread::yield();
+
+  QVERIFY(!handle->isFinished());
+  handle->cancel();
+  decay.released = true;
+
+  QCOMPARE(handle->wait(), 4);
+
+  double tStop = handle->currentTime();
+  QVERIFY2(tStop > 0.0 && tStop < 10.0 && handle->progress() < 1.0, "Stopped inside the interval");
+
+  //yout holds the state at tStop, from which the solve continues
+  QVERIFY(solver.solve(yout.data(), n, tStop, 10.0 - tStop, yout.data(), &derivativeGatedDecay, &decay) == 0);
+
+  ODESolver reference(n, ODESolver::RKQS);
+  reference.setRelativeTolerance(1e-10);
+  reference.setAbsoluteTolerance(1e-12);
+  reference.initialize();
+  QVERIFY(reference.solve(y.data(), n, 0.0, 10.0, yFull.data(), &derivativeGatedDecay, &decay) == 0);
+
+  double difference = 0.0;
+
+  for(int i = 0; i < n; i++)
+    difference = std::max(difference, fabs(yout[i] - yFull[i]));
+
+  QVERIFY2(difference < 1e-8, QString("Resumed solve differs by %1").arg(difference).toStdString().c_str());
+}
+
+void ODESolverTest::solveAsyncChain()
+{
+  int n = 10;
+  GatedDecay held, free;
+  held.n = free.n = n;
+  held.gate = 1;
+  free.gate = -1;
+  held.evaluations = free.evaluations = 0;
+  held.released = false;
+  free.released = true;
+
+  std::vector<double> y(n, 1.0), yFree(n);
+
+  ODESolver heldSolver(n, ODESolver::RKQS);
+  heldSolver.initialize();
+
+  ODESolver freeSolver(n, ODESolver::RKQS);
+  freeSolver.initialize();
+
+  //More solves queued on one solver than the pool has workers, the first held in its first derivative evaluation,
+  //with a worker left for the other solver
+  int threads = ODEThreadPool::instance().threads();
+  ODEThreadPool::instance().setThreads(std::max(threads, 2));
+
+  int chain = ODEThreadPool::instance().threads() + 1;
+  std::vector<std::vector<double>> states(chain + 1, y);
+  std::vector<std::shared_ptr<ODESolveHandle>> handles;
+
+  for(int i = 0; i < chain; i++)
+    handles.push_back(heldSolver.solveAsync(states[i].data(), n, i, 1.0, states[i + 1].data(), &derivativeGatedDecay, &held));
+
+  std::shared_ptr<ODESolveHandle> other = freeSolver.solveAsync(y.data(), n, 0.0, 1.0, yFree.data(), &derivativeGatedDecay, &free);
+
+  bool otherFinished = other->waitFor(10.0);
+  bool chainHeld = !handles.back()->isFinished();
+  held.released = true;
+
+  ODEThreadPool::instance().setThreads(threads);
+
+  QVERIFY2(otherFinished, "A solve on another solver waited for the queued chain");
+  QVERIFY2(chainHeld, "The chain ran past its held solve");
+
+  for(int i = 0; i < chain; i++)
+    QCOMPARE(handles[i]->wait(), 0);
+
+  QCOMPARE(other->status(), 0);
+}
+
+void ODESolverTest::solveODERKQS_Controllers()
+{
+  ODESolver::StepController controllers[] = {ODESolver::ELEMENTARY, ODESolver::PI42, ODESolver::H211PI, ODESolver::H312PID};
+  ODESolverStatistics statistics[4];
+
+  for(int c = 0; c < 4; c++)
+  {
+    ODESolver solver(1, ODESolver::RKQS);
+    solver.setRelativeTolerance(1e-8);
+    solver.setStepController(controllers[c]);
+    solver.setStepRatioLimits(0.2, 2.0);
+    solver.setCollectStatistics(true);
+    solver.initialize();
+
+    double y = 3.0;
+    double y_out = y;
+    double t = 1.0;
+    double dt = 2.0;
+    double maxt = 5.0;
+
+    while(t + dt <= maxt)
+    {
+      solver.solve(&y, 1, t, dt, &y_out, &ODESolverTest::derivativeProb2, nullptr);
+      t += dt;
+      y = y_out;
+    }
+
+    double error = fabs(y - problem2(maxt));
+
+    QVERIFY2(error < 1e-6, QString("RKQS controller %1 error: %2").arg(c).arg(error).toStdString().c_str());
+    QVERIFY2(solver.minStepRatio() == 0.2 && solver.maxStepRatio() == 2.0, "Step ratio limits");
+
+    statistics[c] = solver.statistics();
+  }
+
+  for(int c = 1; c < 4; c++)
+  {
+    QVERIFY2(statistics[c].rejectedSteps <= statistics[0].rejectedSteps,
+             QString("RKQS controller %1 rejected %2 steps, elementary %3").arg(c).arg(statistics[c].rejectedSteps)
+             .arg(statistics[0].rejectedSteps).toStdString().c_str());
+  }
+}
+
+void ODESolverTest::saveRestoreState_RKQS()
+{
+  double t0 = 1.0;
+  double dt = 0.25;
+  int steps = 16;
+  int restartStep = 7;
+
+  ODESolver solver(1, ODESolver::RKQS);
+  solver.setRelativeTolerance(1e-9);
+  solver.setStepController(ODESolver::H211PI);
+  solver.setSolverIterationMethod(ODESolver::NEWTON);
+  solver.setLinearSolverType(ODESolver::TFQMR);
+  solver.setCollectStatistics(true);
+  solver.initialize();
+
+  std::unique_ptr<ODESolver> clone(solver.clone());
+  QVERIFY2(clone->solverIterationMethod() == ODESolver::NEWTON && clone->linearSolverType() == ODESolver::TFQMR,
+           "Cloned CVODE settings");
+
+  double y = 3.0, y_out = y;
+  std::vector<char> state;
+  double yRestart = 0.0;
+
+  for(int i = 0; i < steps; i++)
+  {
+    if(i == restartStep)
+    {
+      state = solver.saveState();
+      yRestart = y;
+    }
+
+    solver.solve(&y, 1, t0 + i * dt, dt, &y_out, &ODESolverTest::derivativeProb2, nullptr);
+    y = y_out;
+  }
+
+  QVERIFY2(state.size() == solver.stateSize(), "State size");
+
+  ODESolver restarted(4, ODESolver::EULER);
+
+  //The Cash-Karp scratch is rewritten by every step and is not saved
+  QVERIFY2(state.size() == restarted.stateSize(), "RKQS state without scratch");
+
+  QVERIFY2(restarted.restoreState(state.data(), state.size() - 1) == 1, "Truncated state");
+  QVERIFY2(restarted.restoreState(state.data(), state.size()) == 0, "Restore state");
+  QVERIFY2(restarted.size() == 1 && restarted.solverType() == ODESolver::RKQS, "Restored configuration");
+  QVERIFY2(restarted.relativeTolerance() == 1e-9 && restarted.collectStatistics(), "Restored options");
+  QVERIFY2(restarted.stepController() == ODESolver::H211PI, "Restored step controller");
+  QVERIFY2(restarted.solverIterationMethod() == ODESolver::NEWTON && restarted.linearSolverType() == ODESolver::TFQMR,
+           "Restored CVODE settings");
+
+  double yr = yRestart, yr_out = yr;
+
+  for(int i = restartStep; i < steps; i++)
+  {
+    restarted.solve(&yr, 1, t0 + i * dt, dt, &yr_out, &ODESolverTest::derivativeProb2, nullptr);
+    yr = yr_out;
+  }
+
+  QVERIFY2(memcmp(&yr, &y, sizeof(double)) == 0, QString("Restart differs: %1 vs %2").arg(yr, 0, 'g', 17).arg(y, 0, 'g', 17).toStdString().c_str());
+  QVERIFY2(restarted.statistics().acceptedSteps == solver.statistics().acceptedSteps, "Restored statistics continue");
+
+  state[0] ^= 0x1;
+  QVERIFY2(restarted.restoreState(state.data(), state.size()) == 2, "Corrupt state");
+}
+
+void ODESolverTest::checkpointBatch()
+{
+  int numSolvers = 2000;
+  QString filePath = "odesolvertest_checkpoint.bin";
+
+  std::vector<ODESolver*> solvers(numSolvers), restored(numSolvers);
+
+  for(int i = 0; i < numSolvers; i++)
+  {
+    solvers[i] = new ODESolver(1 + i % 7, i % 2 ? ODESolver::RKQS : ODESolver::RK4);
+    solvers[i]->setRelativeTolerance(1e-6 / (1 + i % 5));
+    solvers[i]->setMaxIterations(1000 + i);
+    solvers[i]->initialize();
+    restored[i] = new ODESolver(1, ODESolver::EULER);
+  }
+
+  QVERIFY2(ODESolverCheckpoint::write(filePath, solvers), "Write checkpoint");
+
+  ODESolverCheckpoint checkpoint;
+
+  QVERIFY2(checkpoint.open(filePath), "Open checkpoint");
+  QVERIFY2(checkpoint.count() == numSolvers, "Checkpoint count");
+  QVERIFY2(checkpoint.restore(restored) == 0, "Restore checkpoint");
+  QVERIFY2(checkpoint.restore(numSolvers, restored[0]) == 1, "Index out of range");
+
+  for(int i = 0; i < numSolvers; i++)
+  {
+    QVERIFY2(solvers[i]->saveState() == restored[i]->saveState(), QString("Checkpoint state %1").arg(i).toStdString().c_str());
+  }
+
+  checkpoint.close();
+  QFile::remove(filePath);
+
+  for(int i = 0; i < numSolvers; i++)
+  {
+    delete solvers[i];
+    delete restored[i];
+  }
+}
+
 void ODESolverTest::derivativeProb1(double t, double y[], double dydt[], void *userData)
 {
   dydt[0] = t * pow(y[0],3) / sqrt(1 + t * t);
@@ -0,0 +1,231 @@
+/*!
+*  \file    odesparsitytest.cpp
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#include "stdafx.h"
+#include "test/odesparsitytest.h"
+#include "odesparsity.h"
+#include "odejacobian.h"
+
+#include <math.h>
+#include <algorithm>
+
+void ODESparsityTest::transposePattern()
+{
+  //Row 0 depends on 0 and 2, row 1 on 0, row 2 on 1 and 2
+  ODESparsityPattern pattern(3, {0, 2, 3, 5}, {0, 2, 0, 1, 2});
+  ODESparsityPattern transpose = pattern.transpose();
+
+  QVERIFY2(transpose.nonZeros() == 5, "Transpose entries");
+  QVERIFY2(transpose.rowOffsets() == std::vector<int>({0, 2, 3, 5}), "Transpose offsets");
+  QVERIFY2(transpose.columns() == std::vector<int>({0, 1, 2, 0, 2}), "Transpose columns");
+}
+
+void ODESparsityTest::affectedComponents()
+{
+  int n = 10;
+  ODESparseDerivatives sparse(ODESparsityPattern::banded(n, 1, 1), &ODESparsityTest::derivativePulse,
+                              &ODESparsityTest::partialDerivativePulse, &n);
+
+  std::vector<int> changed = {0, 5, 6}, affected;
+  sparse.affectedComponents(changed.data(), static_cast<int>(changed.size()), affected);
+  std::sort(affected.begin(), affected.end());
+
+  QVERIFY2(affected == std::vector<int>({0, 1, 4, 5, 6, 7}), "Affected components");
+}
+
+void ODESparsityTest::sparseDerivativesRK4()
+{
+  int n = 400;
+  std::vector<double> y(n, 0.0), ySparse;
+
+  for(int i = 0; i < n; i++)
+    y[i] = exp(-0.5 * (i - n / 2) * (i - n / 2));
+
+  ySparse = y;
+
+  ODESparseDerivatives sparse(ODESparsityPattern::banded(n, 1, 1), &ODESparsityTest::derivativePulse,
+                              &ODESparsityTest::partialDerivativePulse, &n);
+  sparse.setAbsoluteThreshold(1e-14);
+
+  ODESolver solver(n, ODESolver::RK4), sparseSolver(n, ODESolver::RK4);
+  solver.initialize();
+  sparseSolver.initialize();
+
+  int steps = 50;
+  double dt = 0.1;
+
+  for(int s = 0; s < steps; s++)
+  {
+    solver.solve(y.data(), n, s * dt, dt, y.data(), &ODESparsityTest::derivativePulse, &n);
+    sparseSolver.solve(ySparse.data(), n, s * dt, dt, ySparse.data(), &ODESparseDerivatives::computeDerivatives, &sparse);
+  }
+
+  double difference = 0.0;
+
+  for(int i = 0; i < n; i++)
+    difference = std::max(difference, fabs(y[i] - ySparse[i]));
+
+  long long evaluations = sparse.fullEvaluations() + sparse.partialEvaluations();
+  double fraction = sparse.evaluatedComponents() / (1.0 * n * evaluations);
+
+  QVERIFY2(evaluations == 4 * steps, "One evaluation per stage");
+  QVERIFY2(sparse.fullEvaluations() == 1, QString("Full evaluations: %1").arg(sparse.fullEvaluations()).toStdString().c_str());
+  QVERIFY2(fraction < 0.2, QString("Fraction of components evaluated: %1").arg(fraction).toStdString().c_str());
+  QVERIFY2(difference < 1e-10, QString("Sparse RK4 difference: %1").arg(difference).toStdString().c_str());
+}
+
+void ODESparsityTest::colourTridiagonal()
+{
+  ODEJacobian jacobian(ODESparsityPattern::banded(100, 1, 1));
+  const std::vector<int> &colours = jacobian.colours();
+
+  QVERIFY2(jacobian.numColours() == 3, QString("Colours: %1").arg(jacobian.numColours()).toStdString().c_str());
+
+  for(int j = 0; j + 2 < jacobian.size(); j++)
+  {
+    QVERIFY2(colours[j] != colours[j + 1] && colours[j] != colours[j + 2], "Columns sharing a row share a colour");
+  }
+}
+
+void ODESparsityTest::finiteDifferenceJacobian()
+{
+  int n = 50;
+  std::vector<double> y(n), dydt(n);
+
+  for(int i = 0; i < n; i++)
+    y[i] = sin(0.3 * i);
+
+  derivativePulse(0.0, y.data(), dydt.data(), &n);
+
+  ODESparsityPattern pattern = ODESparsityPattern::banded(n, 1, 1);
+  ODEJacobian jacobian(pattern), sparseJacobian(pattern);
+
+  ODESparseDerivatives sparse(pattern, &ODESparsityTest::derivativePulse, &ODESparsityTest::partialDerivativePulse, &n);
+  sparseJacobian.setSparseDerivatives(&sparse);
+
+  jacobian.evaluate(0.0, y.data(), dydt.data(), &ODESparsityTest::derivativePulse, &n);
+  sparseJacobian.evaluate(0.0, y.data(), dydt.data(), &ODESparsityTest::derivativePulse, &n);
+
+  const std::vector<int> &offsets = jacobian.pattern().rowOffsets();
+  const std::vector<int> &columns = jacobian.pattern().columns();
+  double error = 0.0, sparseError = 0.0;
+
+  for(int i = 0; i < n; i++)
+  {
+    for(int k = offsets[i]; k < offsets[i + 1]; k++)
+    {
+      double exact = columns[k] == i ? -2.1 : 1.0;
+      error = std::max(error, fabs(jacobian.values()[k] - exact));
+      sparseError = std::max(sparseError, fabs(sparseJacobian.values()[k] - exact));
+    }
+  }
+
+  QVERIFY2(jacobian.derivativeEvaluations() == jacobian.numColours(), "One evaluation per colour");
+  QVERIFY2(sparse.partialEvaluations() == jacobian.numColours() && sparse.fullEvaluations() == 0, "Partial evaluation per colour");
+  QVERIFY2(sparse.evaluatedComponents() == pattern.nonZeros(), QString("Components evaluated: %1").arg(sparse.evaluatedComponents()).toStdString().c_str());
+  QVERIFY2(error < 1e-6, QString("Jacobian error: %1").arg(error).toStdString().c_str());
+  QVERIFY2(sparseError < 1e-6, QString("Sparse Jacobian error: %1").arg(sparseError).toStdString().c_str());
+}
+
+void ODESparsityTest::incompleteFactorization()
+{
+  int n = 200;
+  double gamma = 0.7;
+  std::vector<double> y(n, 0.5), r(n), z(n), product(n);
+
+  ODEJacobian jacobian(ODESparsityPattern::banded(n, 1, 1));
+  jacobian.evaluate(0.0, y.data(), nullptr, &ODESparsityTest::derivativePulse, &n);
+
+  QVERIFY2(jacobian.factor(gamma) == 0, "Zero pivot");
+
+  for(int i = 0; i < n; i++)
+    r[i] = cos(0.1 * i);
+
+  jacobian.solve(r.data(), z.data());
+  jacobian.multiply(z.data(), product.data());
+
+  double residual = 0.0;
+
+  for(int i = 0; i < n; i++)
+    residual = std::max(residual, fabs(z[i] - gamma * product[i] - r[i]));
+
+  QVERIFY2(jacobian.factorizations() == 1, "Factorizations");
+  QVERIFY2(residual < 1e-10, QString("Residual: %1").arg(residual).toStdString().c_str());
+}
+
+void ODESparsityTest::jacobianReuse()
+{
+  int n = 20;
+  bool evaluated = false;
+  std::vector<double> y(n, 1.0);
+
+  ODEJacobian jacobian(ODESparsityPattern::banded(n, 1, 1));
+  jacobian.setMaxAge(10);
+  jacobian.setMaxGammaChange(0.3);
+  jacobian.setMaxLinearIterationRate(3.0);
+
+  jacobian.setup(0.0, y.data(), nullptr, 0.1, 0, 0, 0, false, &ODESparsityTest::derivativePulse, &n, evaluated);
+  QVERIFY2(evaluated && jacobian.factorizations() == 1, "First setup evaluates");
+
+  //Small change of gamma keeps both
+  jacobian.setup(0.0, y.data(), nullptr, 0.11, 3, 6, 6, false, &ODESparsityTest::derivativePulse, &n, evaluated);
+  QVERIFY2(!evaluated && jacobian.factorizations() == 1 && jacobian.factorizationReuses() == 1, "Factors reused");
+
+  //Large change of gamma refactors the same Jacobian
+  jacobian.setup(0.0, y.data(), nullptr, 0.2, 5, 10, 10, false, &ODESparsityTest::derivativePulse, &n, evaluated);
+  QVERIFY2(!evaluated && jacobian.factorizations() == 2 && jacobian.jacobianReuses() == 2, "Refactored on gamma");
+
+  jacobian.setup(0.0, y.data(), nullptr, 0.2, 10, 20, 20, false, &ODESparsityTest::derivativePulse, &n, evaluated);
+  QVERIFY2(evaluated && jacobian.evaluations() == 2, "Age limit");
+
+  jacobian.setup(0.0, y.data(), nullptr, 0.2, 11, 22, 22, true, &ODESparsityTest::derivativePulse, &n, evaluated);
+  QVERIFY2(evaluated && jacobian.evaluations() == 3, "Convergence failure");
+
+  jacobian.setup(0.0, y.data(), nullptr, 0.2, 12, 24, 32, false, &ODESparsityTest::derivativePulse, &n, evaluated);
+  QVERIFY2(evaluated && jacobian.evaluations() == 4, "Linear iteration rate");
+
+  jacobian.invalidate();
+  jacobian.setup(0.0, y.data(), nullptr, 0.2, 12, 24, 32, false, &ODESparsityTest::derivativePulse, &n, evaluated);
+  QVERIFY2(evaluated && jacobian.evaluations() == 5 && jacobian.jacobianReuses() == 2, "Invalidated");
+}
+
+void ODESparsityTest::derivativePulse(double t, double y[], double dydt[], void *userData)
+{
+  int n = *static_cast<int*>(userData);
+
+  for(int i = 0; i < n; i++)
+  {
+    int components[1] = {i};
+    partialDerivativePulse(t, y, dydt, components, 1, userData);
+  }
+}
+
+void ODESparsityTest::partialDerivativePulse(double, double y[], double dydt[], const int components[], int count, void *userData)
+{
+  int n = *static_cast<int*>(userData);
+
+  for(int k = 0; k < count; k++)
+  {
+    int i = components[k];
+    double west = i > 0 ? y[i - 1] : 0.0;
+    double east = i < n - 1 ? y[i + 1] : 0.0;
+
+    dydt[i] = west - 2.0 * y[i] + east - 0.1 * y[i];
+  }
+}
@@ -0,0 +1,143 @@
+/*!
+*  \file    typedodesolvertest.cpp
+*  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+*  \version 1.0.0
+*  \section Description
+*  This file and its associated files and libraries are free software;
+*  you can redistribute it and/or modify it under the terms of the
+*  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+*  either version 3 of the License, or (at your option) any later version.
+*  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+*  \date 2018
+*  \pre
+*  \bug
+*  \todo
+*  \warning
+*/
+
+#include "stdafx.h"
+#include "test/typedodesolvertest.h"
+#include "typedodesolver.h"
+
+#include <math.h>
+
+template<typename Real, typename Accumulator>
+static void solveTyped(typename TypedODESolver<Real, Accumulator>::SolverType solverType, int n, double tEnd, double dt, std::vector<double> &y)
+{
+  TypedODESolver<Real, Accumulator> solver(n, solverType);
+  solver.setRelativeTolerance(1e-6);
+  solver.initialize();
+
+  std::vector<Real> yt(y.begin(), y.end());
+
+  for(double t = 0.0; t < tEnd - 1e-12; t += dt)
+  {
+    QVERIFY2(solver.solve(yt.data(), n, t, dt, yt.data(), &TypedODESolverTest::derivativeDecay<Real>, &n) == 0, "Typed solve");
+  }
+
+  y.assign(yt.begin(), yt.end());
+}
+
+static double maxDifference(const std::vector<double> &a, const std::vector<double> &b)
+{
+  double difference = 0.0;
+
+  for(size_t i = 0; i < a.size(); i++)
+    difference = std::max(difference, fabs(a[i] - b[i]));
+
+  return difference;
+}
+
+void TypedODESolverTest::solveDoubleRKQS()
+{
+  int n = 64;
+  std::vector<double> y(n, 1.0), yout(n, 0.0), yTyped(n, 1.0);
+
+  ODESolver solver(n, ODESolver::RKQS);
+  solver.setRelativeTolerance(1e-6);
+  solver.initialize();
+
+  for(double t = 0.0; t < 2.0 - 1e-12; t += 0.1)
+  {
+    QVERIFY2(solver.solve(y.data(), n, t, 0.1, yout.data(), &TypedODESolverTest::derivativeDecay<double>, &n) == 0, "ODESolver solve");
+    y = yout;
+  }
+
+  solveTyped<double, double>(TypedODESolver<double>::RKQS, n, 2.0, 0.1, yTyped);
+
+  double difference = maxDifference(y, yTyped);
+  QVERIFY2(difference < 1e-12, QString("Double RKQS difference: %1").arg(difference).toStdString().c_str());
+}
+
+void TypedODESolverTest::solveMixedRK4()
+{
+  int n = 1024;
+  std::vector<double> reference(n, 1.0), mixed(n, 1.0);
+
+  solveTyped<double, double>(TypedODESolver<double>::RK4, n, 2.0, 0.01, reference);
+  solveTyped<float, double>(MixedODESolver::RK4, n, 2.0, 0.01, mixed);
+
+  //Only rounding of the stored state to float should remain
+  double difference = maxDifference(reference, mixed);
+  QVERIFY2(difference < 1e-5, QString("Mixed RK4 difference: %1").arg(difference).toStdString().c_str());
+}
+
+void TypedODESolverTest::solveFloatRKQS()
+{
+  int n = 1024;
+  std::vector<double> reference(n, 1.0), single(n, 1.0);
+
+  solveTyped<double, double>(TypedODESolver<double>::RKQS, n, 2.0, 0.1, reference);
+  solveTyped<float, float>(FloatODESolver::RKQS, n, 2.0, 0.1, single);
+
+  double difference = maxDifference(reference, single);
+  QVERIFY2(difference < 1e-4, QString("Float RKQS difference: %1").arg(difference).toStdString().c_str());
+}
+
+void TypedODESolverTest::benchmarkDoubleRK4()
+{
+  std::vector<double> y(1 << 20, 1.0);
+
+  QBENCHMARK
+  {
+    solveTyped<double, double>(TypedODESolver<double>::RK4, static_cast<int>(y.size()), 0.1, 0.01, y);
+  }
+}
+
+void TypedODESolverTest::benchmarkMixedRK4()
+{
+  std::vector<double> y(1 << 20, 1.0);
+
+  QBENCHMARK
+  {
+    solveTyped<float, double>(MixedODESolver::RK4, static_cast<int>(y.size()), 0.1, 0.01, y);
+  }
+}
+
+void TypedODESolverTest::benchmarkFloatRK4()
+{
+  std::vector<double> y(1 << 20, 1.0);
+
+  QBENCHMARK
+  {
+    solveTyped<float, float>(FloatODESolver::RK4, static_cast<int>(y.size()), 0.1, 0.01, y);
+  }
+}
+
+template<typename Real>
+void TypedODESolverTest::derivativeDecay(double t, Real y[], Real dydt[], void *userData)
+{
+  int n = *static_cast<int*>(userData);
+  Real c = static_cast<Real>(cos(t));
+
+#ifdef USE_OPENMP
+#pragma omp parallel for
+#endif
+  for(int i = 0; i < n; i++)
+    dydt[i] = -Real(1 + i % 7) * (y[i] - c);
+}
+
+template void TypedODESolverTest::derivativeDecay<double>(double t, double y[], double dydt[], void* userData);
+template void TypedODESolverTest::derivativeDecay<float>(double t, float y[], float dydt[], void* userData);